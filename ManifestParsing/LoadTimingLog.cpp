@@ -0,0 +1,33 @@
+// %BANNER_BEGIN%
+// ---------------------------------------------------------------------
+// %COPYRIGHT_BEGIN%
+//
+// %COPYRIGHT_END%
+// --------------------------------------------------------------------
+// %BANNER_END%
+
+#include <ml_logging.h>
+
+#include "LoadTimingLog.h"
+#include "tinyxmlreader.h"
+
+void LoadTimingLog::OnPhase(const TiXmlDocument &document, const TiXmlParsePhase &phase) {
+    const double ms = (phase.end - phase.start) / 1e6;
+    if (phase.phase == TiXmlParsePhase::PHASE_ERROR) {
+        ML_LOG_TAG(Error, tag, "%s: %s %.3f ms (%s, row %d, col %d)",
+            document.Value(), phase.Name(), ms, document.ErrorDesc(), document.ErrorRow(), document.ErrorCol());
+        return;
+    }
+    ML_LOG_TAG(Info, tag, "%s: %s %.3f ms, %zu bytes, %zu nodes",
+        document.Value(), phase.Name(), ms, phase.bytes, phase.nodes);
+}
+
+void LoadTimingLog::OnReaderPhase(const TiXmlReader &reader, const TiXmlParsePhase &phase) {
+    const double ms = (phase.end - phase.start) / 1e6;
+    if (phase.phase == TiXmlParsePhase::PHASE_ERROR) {
+        ML_LOG_TAG(Error, tag, "reader: %s %.3f ms (%s, row %d, col %d)",
+            phase.Name(), ms, reader.ErrorDesc(), reader.ErrorRow(), reader.ErrorCol());
+        return;
+    }
+    ML_LOG_TAG(Info, tag, "reader: %s %.3f ms, %zu bytes", phase.Name(), ms, phase.bytes);
+}
@@ -0,0 +1,30 @@
+// %BANNER_BEGIN%
+// ---------------------------------------------------------------------
+// %COPYRIGHT_BEGIN%
+//
+// %COPYRIGHT_END%
+// --------------------------------------------------------------------
+// %BANNER_END%
+
+#pragma once
+
+#include "tinyxml.h"
+
+// Logs how long each phase of a TiXmlDocument or TiXmlReader load takes, one
+// line per phase:
+//
+//     LoadTimingLog timing("ManifestParsing");
+//     doc.SetParseObserver(&timing);
+//     doc.LoadFile("manifest.xml");
+//
+// or, for a bound struct, TiXmlBindLoadFile(..., &timing).
+class LoadTimingLog : public TiXmlParseObserver {
+public:
+    explicit LoadTimingLog(const char *tag) : tag(tag) {}
+
+    void OnPhase(const TiXmlDocument &document, const TiXmlParsePhase &phase) override;
+    void OnReaderPhase(const TiXmlReader &reader, const TiXmlParsePhase &phase) override;
+
+private:
+    const char *tag;
+};
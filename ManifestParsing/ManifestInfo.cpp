@@ -0,0 +1,14 @@
+// %BANNER_BEGIN%
+// ---------------------------------------------------------------------
+// %COPYRIGHT_BEGIN%
+//
+// %COPYRIGHT_END%
+// --------------------------------------------------------------------
+// %BANNER_END%
+
+#include "ManifestInfo.h"
+
+constexpr TiXmlBindField ManifestInfo::bindFields[];
+constexpr const char *ManifestInfo::componentTypeValues[];
+constexpr const char *ManifestInfo::privilegeValues[];
+constexpr TiXmlValidateRule ManifestInfo::validateRules[];
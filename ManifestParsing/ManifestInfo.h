@@ -0,0 +1,58 @@
+// %BANNER_BEGIN%
+// ---------------------------------------------------------------------
+// %COPYRIGHT_BEGIN%
+//
+// %COPYRIGHT_END%
+// --------------------------------------------------------------------
+// %BANNER_END%
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "tinyxmlbind.h"
+#include "tinyxmlvalidate.h"
+
+// The parts of manifest.xml the app needs, bound straight from the file.
+struct ManifestInfo {
+    std::string package;
+    int versionCode = 0;
+    std::string versionName;
+    std::string sdkVersion;
+    int minApiLevel = 0;
+    std::vector<std::string> componentNames;   // every <component> has both, so these line up
+    std::vector<std::string> componentTypes;
+    std::vector<std::string> privileges;
+
+    static constexpr TiXmlBindField bindFields[] = {
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, package,        "manifest",                             "ml:package",       true),
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, versionCode,    "manifest",                             "ml:version_code",  true),
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, versionName,    "manifest",                             "ml:version_name",  false),
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, sdkVersion,     "manifest/application",                 "ml:sdk_version",   true),
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, minApiLevel,    "manifest/application",                 "ml:min_api_level", false),
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, componentNames, "manifest/application/component",       "ml:name",          true),
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, componentTypes, "manifest/application/component",       "ml:type",          true),
+        TIXML_BIND_ATTRIBUTE(ManifestInfo, privileges,     "manifest/application/uses-privilege",  "ml:name",          false),
+    };
+
+    // What a manifest must look like before it is installed, checked in one
+    // pass with TiXmlValidator.
+    static constexpr const char *componentTypeValues[] = { "Fullscreen", "Console", nullptr };
+    static constexpr const char *privilegeValues[] = {
+        "AudioCaptureMic", "CameraCapture", "ControllerPose", "LowLatencyLightwear", "WorldReconstruction", nullptr
+    };
+    static constexpr TiXmlValidateRule validateRules[] = {
+        TIXML_VALIDATE_OCCURS(  "manifest",                             1, 1),
+        TIXML_VALIDATE_OCCURS(  "manifest/application",                 1, 1),
+        TIXML_VALIDATE_REQUIRED("manifest",                             "ml:package"),
+        TIXML_VALIDATE_REQUIRED("manifest",                             "ml:version_code"),
+        TIXML_VALIDATE_FORMAT(  "manifest",                             "ml:version_code",  "#"),
+        TIXML_VALIDATE_REQUIRED("manifest/application",                 "ml:sdk_version"),
+        TIXML_VALIDATE_FORMAT(  "manifest/application",                 "ml:sdk_version",   "#.#.#"),
+        TIXML_VALIDATE_REQUIRED("manifest/application/component",       "ml:name"),
+        TIXML_VALIDATE_REQUIRED("manifest/application/component",       "ml:type"),
+        TIXML_VALIDATE_ONE_OF(  "manifest/application/component",       "ml:type",          componentTypeValues),
+        TIXML_VALIDATE_ONE_OF(  "manifest/application/uses-privilege",  "ml:name",          privilegeValues),
+    };
+};
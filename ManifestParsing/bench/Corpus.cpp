@@ -0,0 +1,282 @@
+// %BANNER_BEGIN%
+// ---------------------------------------------------------------------
+// %COPYRIGHT_BEGIN%
+//
+// %COPYRIGHT_END%
+// --------------------------------------------------------------------
+// %BANNER_END%
+
+#include "Corpus.h"
+
+#include <cstdio>
+
+namespace {
+
+/** xorshift64, so corpora don't depend on the C library's rand(). */
+class Random {
+public:
+    explicit Random(unsigned long long seed) : state(seed) { }
+    unsigned next(unsigned bound) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (unsigned)(state % bound);
+    }
+private:
+    unsigned long long state;
+};
+
+const char *const WORDS[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+    "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore", "magna"
+};
+const unsigned WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+void appendWords(std::string &out, Random &random, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (i)
+            out += ' ';
+        out += WORDS[random.next(WORD_COUNT)];
+    }
+}
+
+void appendInt(std::string &out, unsigned v) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u", v);
+    out += buf;
+}
+
+/** Nesting 256 levels deep, repeated until the target size. */
+void deep(std::string &out, size_t target, Random &random) {
+    const int depth = 256;
+    out += "<deep>\n";
+    while (out.size() < target) {
+        for (int i = 0; i < depth; ++i) {
+            out += "<level n=\"";
+            appendInt(out, i);
+            out += "\">";
+        }
+        appendWords(out, random, 2);
+        for (int i = 0; i < depth; ++i)
+            out += "</level>";
+        out += '\n';
+    }
+    out += "</deep>\n";
+}
+
+/** One root with a very large number of small children. */
+void wide(std::string &out, size_t target, Random &random) {
+    out += "<wide>\n";
+    for (unsigned i = 0; out.size() < target; ++i) {
+        out += "\t<item id=\"";
+        appendInt(out, i);
+        out += "\">";
+        out += WORDS[random.next(WORD_COUNT)];
+        out += "</item>\n";
+    }
+    out += "</wide>\n";
+}
+
+/** Empty elements carrying many attributes each. */
+void attributes(std::string &out, size_t target, Random &random) {
+    out += "<records>\n";
+    while (out.size() < target) {
+        out += "\t<record";
+        for (int i = 0; i < 16; ++i) {
+            out += " a";
+            appendInt(out, i);
+            out += "=\"";
+            if (i & 1)
+                appendInt(out, random.next(1000000));
+            else
+                out += WORDS[random.next(WORD_COUNT)];
+            out += '"';
+        }
+        out += "/>\n";
+    }
+    out += "</records>\n";
+}
+
+/** Few elements, each holding a long run of text. */
+void text(std::string &out, size_t target, Random &random) {
+    out += "<book>\n";
+    while (out.size() < target) {
+        out += "\t<paragraph>";
+        appendWords(out, random, 2000);
+        out += "</paragraph>\n";
+    }
+    out += "</book>\n";
+}
+
+/** Localized strings, mostly in multi-byte UTF-8: Greek, Cyrillic, Japanese
+ *  and emoji, one script per string. */
+void utf8(std::string &out, size_t target, Random &random) {
+    static const char *const languages[] = { "el", "ru", "ja", "emoji" };
+    static const char *const words[4][4] = {
+        { "\xce\xb1\xce\xbb\xcf\x86\xce\xb1", "\xce\xb2\xce\xae\xcf\x84\xce\xb1",
+          "\xce\xb3\xce\xac\xce\xbc\xce\xbc\xce\xb1", "\xce\xbb\xcf\x8c\xce\xb3\xce\xbf\xcf\x82" },
+        { "\xd0\xbc\xd0\xb8\xd1\x80", "\xd0\xb4\xd0\xbe\xd0\xbc",
+          "\xd1\x82\xd0\xb5\xd0\xba\xd1\x81\xd1\x82", "\xd1\x84\xd0\xb0\xd0\xb9\xd0\xbb" },
+        { "\xe6\x96\x87\xe6\x9b\xb8", "\xe3\x83\x86\xe3\x82\xad\xe3\x82\xb9\xe3\x83\x88",
+          "\xe8\xa8\xad\xe5\xae\x9a", "\xe7\x94\xbb\xe9\x9d\xa2" },
+        { "\xf0\x9f\x93\x84", "\xf0\x9f\x93\x81", "\xf0\x9f\x94\x8d", "\xf0\x9f\x9a\x80" },
+    };
+    out += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<strings>\n";
+    while (out.size() < target) {
+        const unsigned language = random.next(4);
+        out += "\t<string lang=\"";
+        out += languages[language];
+        out += "\">";
+        for (int i = 0; i < 64; ++i) {
+            if (i)
+                out += ' ';
+            out += words[language][random.next(4)];
+        }
+        out += "</string>\n";
+    }
+    out += "</strings>\n";
+}
+
+/** Text dense with entities, character references and CDATA sections. */
+void entities(std::string &out, size_t target, Random &random) {
+    static const char *const pieces[] = {
+        "&amp;", "&lt;", "&gt;", "&quot;", "&apos;", "&#65;", "&#x263A;", "&#xA9;"
+    };
+    out += "<escaped>\n";
+    while (out.size() < target) {
+        out += "\t<e note=\"a &amp; b &lt; c\">";
+        for (int i = 0; i < 16; ++i) {
+            out += WORDS[random.next(WORD_COUNT)];
+            out += pieces[random.next(8)];
+        }
+        out += "<![CDATA[if (a < b && c > d) { return \"<raw>\"; }]]>";
+        out += "</e>\n";
+    }
+    out += "</escaped>\n";
+}
+
+/** A mixed document with Windows line endings, to exercise EOL normalization. */
+void crlf(std::string &out, size_t target, Random &random) {
+    out += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n<lines>\r\n";
+    while (out.size() < target) {
+        out += "\t<!-- ";
+        appendWords(out, random, 3);
+        out += " -->\r\n\t<line kind=\"";
+        out += WORDS[random.next(WORD_COUNT)];
+        out += "\">\r\n\t\t";
+        appendWords(out, random, 8);
+        out += "\r\n\t</line>\r\n";
+    }
+    out += "</lines>\r\n";
+}
+
+/** Manifests in the schema of ManifestParsing/manifest.xml, with many
+ *  components and privileges each, under a common root. */
+void manifest(std::string &out, size_t target, Random &random) {
+    out += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<manifests>\n";
+    for (unsigned m = 0; out.size() < target; ++m) {
+        out += "<manifest\n\txmlns:ml=\"magicleap\"\n\tml:package=\"com.mlexamples.app";
+        appendInt(out, m);
+        out += "\"\n\tml:version_code=\"";
+        appendInt(out, random.next(100) + 1);
+        out += "\"\n\tml:version_name=\"Version 1.";
+        appendInt(out, random.next(100));
+        out += "\">\n\t<application\n\t\tml:visible_name=\"App";
+        appendInt(out, m);
+        out += "\"\n\t\tml:sdk_version=\"0.20.0\"\n\t\tml:min_api_level=\"3\">\n";
+        for (int c = 0; c < 4; ++c) {
+            out += "\t\t<component\n\t\t\tml:name=\".";
+            out += WORDS[random.next(WORD_COUNT)];
+            out += "\"\n\t\t\tml:visible_name=\"App";
+            appendInt(out, m);
+            out += "\"\n\t\t\tml:binary_name=\"bin/App";
+            appendInt(out, m);
+            out += "\"\n\t\t\tml:type=\"";
+            out += random.next(2) ? "Fullscreen" : "Console";
+            out += "\">\n\t\t\t<icon ml:model_folder=\"\"\n\t\t\t\tml:portal_folder=\"\"/>\n\t\t</component>\n";
+        }
+        static const char *const privileges[] = {
+            "WorldReconstruction", "LowLatencyLightwear", "ControllerPose", "CameraCapture", "AudioCaptureMic"
+        };
+        for (int p = 0; p < 5; ++p) {
+            out += "\t\t<uses-privilege ml:name=\"";
+            out += privileges[p];
+            out += "\"/>\n";
+        }
+        out += "\t</application>\n</manifest>\n";
+    }
+    out += "</manifests>\n";
+}
+
+/** Pretty printed tool output: a DOCTYPE, processing instructions and
+ *  comments around every record, none of which readers of the data use. */
+void annotated(std::string &out, size_t target, Random &random) {
+    out += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<!DOCTYPE catalog SYSTEM \"catalog.dtd\">\n"
+           "<!-- Generated file, do not edit. -->\n<catalog>\n";
+    for (unsigned i = 0; out.size() < target; ++i) {
+        out += "\t<!-- record ";
+        appendInt(out, i);
+        out += ": ";
+        appendWords(out, random, 6);
+        out += " -->\n\t<?render hint=\"";
+        out += WORDS[random.next(WORD_COUNT)];
+        out += "\"?>\n\t<record id=\"";
+        appendInt(out, i);
+        out += "\">\n\t\t<name>";
+        out += WORDS[random.next(WORD_COUNT)];
+        out += "</name>\n\t\t<!-- ";
+        appendWords(out, random, 4);
+        out += " -->\n\t\t<value>";
+        appendInt(out, random.next(100000));
+        out += "</value>\n\t</record>\n";
+    }
+    out += "</catalog>\n";
+}
+
+struct Generator {
+    const char *name;
+    const char *description;
+    void (*generate)(std::string &out, size_t target, Random &random);
+};
+
+const Generator GENERATORS[] = {
+    { "deep",       "256 level nesting",                    deep },
+    { "wide",       "one root, many small children",        wide },
+    { "attributes", "16 attributes per element",            attributes },
+    { "text",       "long text runs",                       text },
+    { "entities",   "entity, char ref and CDATA heavy",     entities },
+    { "crlf",       "CRLF line endings and comments",       crlf },
+    { "utf8",       "localized strings in multi-byte UTF-8", utf8 },
+    { "manifest",   "application manifests",                manifest },
+    { "annotated",  "comments, PIs and DOCTYPE",            annotated },
+};
+const size_t GENERATOR_COUNT = sizeof(GENERATORS) / sizeof(GENERATORS[0]);
+
+}
+
+
+const std::vector<std::string> &corpusNames() {
+    static std::vector<std::string> names;
+    if (names.empty()) {
+        for (size_t i = 0; i < GENERATOR_COUNT; ++i)
+            names.push_back(GENERATORS[i].name);
+    }
+    return names;
+}
+
+
+bool generateCorpus(const std::string &name, size_t targetBytes, Corpus *out) {
+    for (size_t i = 0; i < GENERATOR_COUNT; ++i) {
+        if (name == GENERATORS[i].name) {
+            Random random(0x9e3779b97f4a7c15ULL + i);
+            out->name = name;
+            out->description = GENERATORS[i].description;
+            out->xml.clear();
+            out->xml.reserve(targetBytes + 4096);
+            GENERATORS[i].generate(out->xml, targetBytes, random);
+            return true;
+        }
+    }
+    return false;
+}
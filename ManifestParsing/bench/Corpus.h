@@ -0,0 +1,28 @@
+// %BANNER_BEGIN%
+// ---------------------------------------------------------------------
+// %COPYRIGHT_BEGIN%
+//
+// %COPYRIGHT_END%
+// --------------------------------------------------------------------
+// %BANNER_END%
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/** One synthetic benchmark input. The generators are deterministic: the same
+ *  name and size always produce the same bytes, so numbers from different
+ *  builds are measured on identical documents. */
+struct Corpus {
+    std::string name;
+    std::string description;
+    std::string xml;
+};
+
+/** Names of the built in corpora, in report order. */
+const std::vector<std::string> &corpusNames();
+
+/** Generates the named corpus at roughly targetBytes. Returns false if the
+ *  name is unknown. */
+bool generateCorpus(const std::string &name, size_t targetBytes, Corpus *out);
@@ -0,0 +1,1482 @@
+// %BANNER_BEGIN%
+// ---------------------------------------------------------------------
+// %COPYRIGHT_BEGIN%
+//
+// %COPYRIGHT_END%
+// --------------------------------------------------------------------
+// %BANNER_END%
+
+// Throughput benchmarks for the tinyxml component. Generates each corpus (see
+// Corpus.cpp), times the DOM operations on it, and prints one JSON document
+// so results from different builds can be compared by a script:
+//
+//   TinyXmlBench [--size 4M] [--repeat 9] [--dir .] [--corpus NAME]...
+//                [--file PATH]... [--scaling-max 1000000] [--out FILE]
+//
+// For each corpus it also parses with every optional node kind left out
+// (TiXmlParseOptions::KEEP_NONE) and reports the nodes, heap bytes and time
+// that saves. Only "annotated" (comments, processing instructions, a DOCTYPE)
+// and "crlf" (comments) have much to leave out; the rest have at most the
+// declaration, and no time saved is reported for under 1% of the nodes. After the corpora it measures how teardown scales: the time to
+// delete wide and deep documents of 1000 nodes up to --scaling-max (0 skips
+// this).
+//
+// "parse_reuse" times Clear() and Parse() on one document that keeps its
+// storage (TiXmlDocument::SetReuseStorage()), once it has been warmed up.
+//
+// "parse_namespaces" parses with TiXmlParseOptions::namespaces, resolving
+// every element and attribute name.
+//
+// "hash" times working out every node's TiXmlNode::Hash() on a fresh parse,
+// and "diff" times TiXmlDiff between the DOM and a copy with one attribute
+// added to the middle element, both already hashed.
+//
+// "compact" times TiXmlDocument::Compact() on the corpus after an edit to
+// every element and text node, and "accept_edited" and "accept_compact" time
+// a visit of that document without and with it; "compaction" reports the
+// memory it saves.
+//
+// "json" transcodes the corpus text to JSON with TiXmlJsonTranscoder, with an
+// array rule for each element that repeats, and "json_dom" writes the same
+// JSON by parsing a DOM and visiting it; the two outputs are checked to match.
+//
+// After the corpora, "columns" splits the manifest corpus into one document
+// per <manifest> and times pulling five values out of every one: with a DOM
+// per document, and with TiXmlColumnExtractor on one thread and on all of
+// them. "validate" checks the manifest rules on every one of those documents:
+// walking a DOM per document, and with TiXmlValidator. "publish" has reader
+// threads look an attribute up in the current one of those documents while
+// a writer replaces it every millisecond: through a mutex and a shared_ptr,
+// and through TiXmlPublishedDocument.
+//
+// "index" writes the annotated corpus to --dir, builds a TiXmlOffsetIndex of
+// its records by id, and times looking records up: scanning the file with a
+// TiXmlReader until the record, and through the index.
+//
+// Built with TIXML_USE_ZLIB it also writes each corpus gzipped and times
+// loading that against loading the plain file, and saving each way.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tinyxml.h"
+#ifdef TIXML_USE_STL
+#include "tinyxmlcolumns.h"
+#endif
+#include "tinyxmldiff.h"
+#include "tinyxmliterator.h"
+#include "tinyxmljson.h"
+#include "tinyxmlprepass.h"
+#include "tinyxmlreader.h"
+#ifdef TIXML_USE_STL
+#include "tinyxmlindex.h"
+#include "tinyxmlpublish.h"
+#include "tinyxmlvalidate.h"
+#endif
+#include "Corpus.h"
+
+#ifdef TIXML_USE_ZLIB
+#include <zlib.h>
+#endif
+
+
+namespace {
+
+/** Heap use, counted by the operator new below while countHeap is set. */
+struct HeapUse {
+    size_t bytes = 0;
+    size_t allocations = 0;
+};
+
+// Atomic, as the threaded sections allocate from several threads at once.
+std::atomic<bool> countHeap(false);
+std::atomic<size_t> heapBytes(0);
+std::atomic<size_t> heapAllocations(0);
+
+}
+
+
+void *operator new(size_t size) {
+    if (countHeap.load(std::memory_order_relaxed)) {
+        heapBytes.fetch_add(size, std::memory_order_relaxed);
+        heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+// Not inlined, so the compiler doesn't pair free() with a new expression.
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+
+namespace {
+
+struct Options {
+    size_t size = 4 << 20;
+    int repeat = 9;
+    std::string dir = ".";
+    std::vector<std::string> corpora;
+    std::vector<std::string> files;
+    size_t scalingMax = 1000000;
+    std::string out;
+};
+
+/** A corpus ready to measure: its text, a copy on disk and a parsed DOM. */
+struct Fixture {
+    Corpus corpus;
+    std::string path;
+    std::string gzipPath;
+    size_t gzipBytes = 0;
+    std::string savePath;
+    TiXmlDocument doc;
+    TiXmlDocument reused;
+    TiXmlDocument edited;       // doc after editBurst()
+    TiXmlDocument compacted;    // edited, then compacted
+    unsigned long nodes = 0;
+};
+
+/** Counts every node, which is also the work of a full traversal. */
+class CountingVisitor : public TiXmlVisitor {
+public:
+    unsigned long nodes = 0;
+    bool VisitEnter(const TiXmlDocument &) override { ++nodes; return true; }
+    bool VisitEnter(const TiXmlElement &, const TiXmlAttribute *) override { ++nodes; return true; }
+    bool Visit(const TiXmlDeclaration &) override { ++nodes; return true; }
+    bool Visit(const TiXmlText &) override { ++nodes; return true; }
+    bool Visit(const TiXmlComment &) override { ++nodes; return true; }
+    bool Visit(const TiXmlUnknown &) override { ++nodes; return true; }
+};
+
+/** The elements that repeat in the corpora, each written as an array. */
+const TiXmlJsonRule JSON_RULES[] = {
+    { "level", TIXML_JSON_ARRAY },   { "item", TIXML_JSON_ARRAY },
+    { "record", TIXML_JSON_ARRAY },  { "paragraph", TIXML_JSON_ARRAY },
+    { "string", TIXML_JSON_ARRAY },  { "e", TIXML_JSON_ARRAY },
+    { "line", TIXML_JSON_ARRAY },    { "manifest", TIXML_JSON_ARRAY },
+    { "component", TIXML_JSON_ARRAY }, { "uses-privilege", TIXML_JSON_ARRAY },
+};
+
+TiXmlJsonOptions jsonOptions() {
+    TiXmlJsonOptions options;
+    options.rules = JSON_RULES;
+    options.ruleCount = sizeof(JSON_RULES) / sizeof(JSON_RULES[0]);
+    return options;
+}
+
+/** Writes the JSON TiXmlJsonTranscoder writes with jsonOptions(), from a
+ *  DOM. */
+class JsonVisitor : public TiXmlVisitor {
+public:
+    std::string out;
+
+    bool VisitEnter(const TiXmlDocument &) override {
+        out.clear();
+        levels.assign(1, Level());
+        return true;
+    }
+    bool VisitExit(const TiXmlDocument &) override {
+        if (levels[0].open) {
+            arrays(levels[0]);
+            out += '}';
+        } else {
+            out += "{}";
+        }
+        return true;
+    }
+    bool VisitEnter(const TiXmlElement &element, const TiXmlAttribute *attribute) override {
+        Level &parent = levels.back();
+        const bool held = isArray(element.Value());
+        if (held) {
+            open(parent);
+            parent.arrays.emplace_back(element.Value(), std::string());
+        } else {
+            member(parent, element.Value());
+        }
+        levels.push_back(Level());
+        levels.back().held = held;
+        levels.back().start = out.size();
+        for (; attribute; attribute = attribute->Next()) {
+            member(levels.back(), std::string("@") + attribute->Name());
+            string(attribute->Value());
+        }
+        return true;
+    }
+    bool VisitExit(const TiXmlElement &) override {
+        Level &level = levels.back();
+        if (level.open) {
+            arrays(level);
+            if (!level.text.empty()) {
+                member(level, "#text");
+                string(level.text);
+            }
+            out += '}';
+        } else if (!level.text.empty()) {
+            string(level.text);
+        } else {
+            out += "null";
+        }
+        if (level.held) {
+            levels[levels.size() - 2].arrays.back().second = out.substr(level.start);
+            out.resize(level.start);
+        }
+        levels.pop_back();
+        return true;
+    }
+    bool Visit(const TiXmlText &text) override {
+        if (levels.size() > 1)
+            levels.back().text += text.Value();
+        return true;
+    }
+
+private:
+    struct Level {
+        std::string text;
+        std::vector<std::pair<std::string, std::string>> arrays; // key and value, in order
+        size_t start = 0;
+        int members = 0;
+        bool open = false;
+        bool held = false;
+    };
+
+    static bool isArray(const char *name) {
+        for (const TiXmlJsonRule &rule : JSON_RULES)
+            if (strcmp(rule.path, name) == 0)
+                return true;
+        return false;
+    }
+
+    void open(Level &level) {
+        if (!level.open) {
+            out += '{';
+            level.open = true;
+        }
+    }
+
+    void member(Level &level, const std::string &key) {
+        open(level);
+        if (level.members++)
+            out += ',';
+        string(key);
+        out += ':';
+    }
+
+    /** The held members, one array per key in the order the keys came. */
+    void arrays(Level &level) {
+        std::vector<std::string> keys;
+        for (const auto &held : level.arrays)
+            if (std::find(keys.begin(), keys.end(), held.first) == keys.end())
+                keys.push_back(held.first);
+        for (const std::string &key : keys) {
+            member(level, key);
+            out += '[';
+            bool first = true;
+            for (const auto &held : level.arrays) {
+                if (held.first != key)
+                    continue;
+                if (!first)
+                    out += ',';
+                first = false;
+                out += held.second;
+            }
+            out += ']';
+        }
+    }
+
+    void string(const std::string &s) {
+        out += '"';
+        for (char c : s) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    std::vector<Level> levels;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/** One timed operation. run() returns the seconds taken by the part being
+ *  measured, so set up and clean up can stay outside the timing. */
+struct Measurement {
+    const char *name;
+    double (*run)(Fixture &fixture);
+};
+
+double loadFile(Fixture &f) {
+    TiXmlDocument doc;
+    Clock::time_point start = Clock::now();
+    doc.LoadFile(f.path.c_str());
+    double t = secondsSince(start);
+    if (doc.Error()) {
+        fprintf(stderr, "%s: %s\n", f.path.c_str(), doc.ErrorDesc());
+        exit(1);
+    }
+    return t;
+}
+
+double streamIn(Fixture &f) {
+    std::ifstream in(f.path.c_str(), std::ios::binary);
+    TiXmlDocument doc;
+    Clock::time_point start = Clock::now();
+    in >> doc;
+    double t = secondsSince(start);
+    if (doc.Error()) {
+        fprintf(stderr, "%s: %s\n", f.path.c_str(), doc.ErrorDesc());
+        exit(1);
+    }
+    return t;
+}
+
+#ifdef TIXML_USE_ZLIB
+double loadGzip(Fixture &f) {
+    TiXmlDocument doc;
+    Clock::time_point start = Clock::now();
+    doc.LoadFile(f.gzipPath.c_str());
+    double t = secondsSince(start);
+    if (doc.Error()) {
+        fprintf(stderr, "%s: %s\n", f.gzipPath.c_str(), doc.ErrorDesc());
+        exit(1);
+    }
+    return t;
+}
+#endif
+
+double parse(Fixture &f) {
+    TiXmlDocument doc;
+    Clock::time_point start = Clock::now();
+    doc.Parse(f.corpus.xml.c_str());
+    return secondsSince(start);
+}
+
+double parseReuse(Fixture &f) {
+    // The whole cycle of a document that reuses its storage, so compare it
+    // with parse and teardown together.
+    Clock::time_point start = Clock::now();
+    f.reused.Clear();
+    f.reused.Parse(f.corpus.xml.c_str());
+    return secondsSince(start);
+}
+
+double parseFiltered(Fixture &f) {
+    TiXmlParseOptions options;
+    options.keep = TiXmlParseOptions::KEEP_NONE;
+    TiXmlDocument doc;
+    Clock::time_point start = Clock::now();
+    doc.Parse(f.corpus.xml.c_str(), options);
+    return secondsSince(start);
+}
+
+double parseNamespaces(Fixture &f) {
+    TiXmlParseOptions options;
+    options.namespaces = true;
+    TiXmlDocument doc;
+    Clock::time_point start = Clock::now();
+    doc.Parse(f.corpus.xml.c_str(), options);
+    double t = secondsSince(start);
+    if (doc.Error()) {
+        fprintf(stderr, "%s: %s\n", f.corpus.name.c_str(), doc.ErrorDesc());
+        exit(1);
+    }
+    return t;
+}
+
+double prepass(Fixture &f) {
+    // The pass LoadFile() makes over the buffer it read, on a fresh copy.
+    std::vector<char> buffer(f.corpus.xml.begin(), f.corpus.xml.end());
+    buffer.push_back(0);
+    TiXmlPrepass pass(true);
+    Clock::time_point start = Clock::now();
+    pass.Run(&buffer[0], f.corpus.xml.size());
+    return secondsSince(start);
+}
+
+double accept(Fixture &f) {
+    CountingVisitor visitor;
+    Clock::time_point start = Clock::now();
+    f.doc.Accept(&visitor);
+    return secondsSince(start);
+}
+
+double iterate(Fixture &f) {
+    const TiXmlDocument &doc = f.doc;
+    unsigned long nodes = 1;
+    Clock::time_point start = Clock::now();
+    for (const TiXmlNode *node : TiXmlDescendants(&doc)) {
+        (void)node;
+        ++nodes;
+    }
+    double t = secondsSince(start);
+    if (nodes != f.nodes) {
+        fprintf(stderr, "%s: iterated %lu nodes, expected %lu\n", f.corpus.name.c_str(), nodes, f.nodes);
+        exit(1);
+    }
+    return t;
+}
+
+double print(Fixture &f) {
+    TiXmlPrinter printer;
+    Clock::time_point start = Clock::now();
+    f.doc.Accept(&printer);
+    return secondsSince(start);
+}
+
+/** Saves the DOM to a scratch file, compressed at 'level'. */
+double save(Fixture &f, int level, const char *suffix) {
+    const std::string path = f.savePath + suffix;
+    f.doc.SetCompression(level);
+    Clock::time_point start = Clock::now();
+    bool saved = f.doc.SaveFile(path.c_str());
+    double t = secondsSince(start);
+    remove(path.c_str());
+    if (!saved) {
+        fprintf(stderr, "can't save %s\n", path.c_str());
+        exit(1);
+    }
+    return t;
+}
+
+double saveFile(Fixture &f) {
+    return save(f, TiXmlDocument::COMPRESS_NONE, "");
+}
+
+#ifdef TIXML_USE_ZLIB
+double saveGzip(Fixture &f) {
+    return save(f, TiXmlDocument::COMPRESS_DEFAULT, ".gz");
+}
+#endif
+
+double hash(Fixture &f) {
+    TiXmlDocument doc;
+    doc.Parse(f.corpus.xml.c_str());
+    Clock::time_point start = Clock::now();
+    doc.Hash();
+    return secondsSince(start);
+}
+
+double diff(Fixture &f) {
+    TiXmlDocument changed(f.doc);
+    unsigned long elements = 0;
+    for (TiXmlNode *node : TiXmlDescendants(&changed))
+        elements += node->ToElement() != nullptr;
+    TiXmlElement *middle = nullptr;
+    unsigned long skip = elements / 2;
+    for (TiXmlNode *node : TiXmlDescendants(&changed)) {
+        if (node->ToElement() && skip-- == 0) {
+            middle = node->ToElement();
+            break;
+        }
+    }
+    middle->SetAttribute("tinyxmlbench", "changed");
+    f.doc.Hash();
+    changed.Hash();
+
+    TiXmlDiff differ;
+    Clock::time_point start = Clock::now();
+    size_t changes = differ.Compare(f.doc, changed, nullptr);
+    double t = secondsSince(start);
+    if (changes != 1) {
+        fprintf(stderr, "%s: diff found %zu changes, expected 1\n", f.corpus.name.c_str(), changes);
+        exit(1);
+    }
+    return t;
+}
+
+double json(Fixture &f) {
+    TiXmlJsonTranscoder transcoder(jsonOptions());
+    Clock::time_point start = Clock::now();
+    bool ok = transcoder.Transcode(f.corpus.xml.c_str());
+    double t = secondsSince(start);
+    if (!ok) {
+        fprintf(stderr, "%s: %s\n", f.corpus.name.c_str(), transcoder.ErrorDesc());
+        exit(1);
+    }
+    return t;
+}
+
+double jsonDom(Fixture &f) {
+    JsonVisitor visitor;
+    Clock::time_point start = Clock::now();
+    {
+        TiXmlDocument doc;
+        doc.Parse(f.corpus.xml.c_str());
+        doc.Accept(&visitor);
+    }
+    double t = secondsSince(start);
+
+    TiXmlJsonTranscoder transcoder(jsonOptions());
+    transcoder.Transcode(f.corpus.xml.c_str());
+    if (visitor.out != transcoder.CStr()) {
+        fprintf(stderr, "%s: transcoded JSON (%zu bytes) differs from the DOM's (%zu bytes)\n",
+                f.corpus.name.c_str(), transcoder.Size(), visitor.out.size());
+        exit(1);
+    }
+    return t;
+}
+
+/** Changes every element and text node, as a long-lived document gets
+ *  changed, so the nodes and their new strings are spread over the heap. */
+void editBurst(TiXmlDocument &doc) {
+    for (TiXmlNode *node : TiXmlDescendants(&doc)) {
+        if (TiXmlElement *element = node->ToElement())
+            element->SetAttribute("tinyxmlbench", "edited");
+        else if (TiXmlText *text = node->ToText())
+            text->SetValue(std::string(text->ValueStr()) + " (edited)");
+    }
+}
+
+double compact(Fixture &f) {
+    TiXmlDocument doc;
+    doc.Parse(f.corpus.xml.c_str());
+    editBurst(doc);
+    Clock::time_point start = Clock::now();
+    doc.Compact();
+    return secondsSince(start);
+}
+
+double acceptEdited(Fixture &f) {
+    CountingVisitor visitor;
+    Clock::time_point start = Clock::now();
+    f.edited.Accept(&visitor);
+    return secondsSince(start);
+}
+
+double acceptCompacted(Fixture &f) {
+    CountingVisitor visitor;
+    Clock::time_point start = Clock::now();
+    f.compacted.Accept(&visitor);
+    return secondsSince(start);
+}
+
+double teardown(Fixture &f) {
+    TiXmlDocument *doc = new TiXmlDocument;
+    doc->Parse(f.corpus.xml.c_str());
+    Clock::time_point start = Clock::now();
+    delete doc;
+    return secondsSince(start);
+}
+
+const Measurement MEASUREMENTS[] = {
+    { "load_file", loadFile },
+#ifdef TIXML_USE_ZLIB
+    { "load_gzip", loadGzip },
+#endif
+    { "stream_in", streamIn },
+    { "parse",     parse },
+    { "parse_reuse", parseReuse },
+    { "parse_filtered", parseFiltered },
+    { "parse_namespaces", parseNamespaces },
+    { "prepass",   prepass },
+    { "accept",    accept },
+    { "iterate",   iterate },
+    { "print",     print },
+    { "save_file", saveFile },
+#ifdef TIXML_USE_ZLIB
+    { "save_gzip", saveGzip },
+#endif
+    { "hash",      hash },
+    { "diff",      diff },
+    { "json",      json },
+    { "json_dom",  jsonDom },
+    { "compact",   compact },
+    { "accept_edited", acceptEdited },
+    { "accept_compact", acceptCompacted },
+    { "teardown",  teardown },
+};
+
+size_t parseSize(const char *s) {
+    char *end = nullptr;
+    double v = strtod(s, &end);
+    if (*end == 'k' || *end == 'K')
+        v *= 1 << 10;
+    else if (*end == 'm' || *end == 'M')
+        v *= 1 << 20;
+    return (size_t)v;
+}
+
+bool parseOptions(int argc, char **argv, Options *options) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "missing value for %s\n", arg);
+            return false;
+        }
+        if (!strcmp(arg, "--size"))
+            options->size = parseSize(value);
+        else if (!strcmp(arg, "--repeat"))
+            options->repeat = std::max(1, atoi(value));
+        else if (!strcmp(arg, "--dir"))
+            options->dir = value;
+        else if (!strcmp(arg, "--corpus"))
+            options->corpora.push_back(value);
+        else if (!strcmp(arg, "--file"))
+            options->files.push_back(value);
+        else if (!strcmp(arg, "--scaling-max"))
+            options->scalingMax = parseSize(value);
+        else if (!strcmp(arg, "--out"))
+            options->out = value;
+        else {
+            fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+bool writeFile(const std::string &path, const std::string &data) {
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp)
+        return false;
+    bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    return fclose(fp) == 0 && ok;
+}
+
+bool readFile(const std::string &path, std::string *data) {
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (!fp)
+        return false;
+    char buf[65536];
+    size_t n;
+    data->clear();
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        data->append(buf, n);
+    fclose(fp);
+    return true;
+}
+
+void jsonString(std::string &out, const std::string &s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void jsonNumber(std::string &out, double v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6g", v);
+    out += buf;
+}
+
+/** Parses the fixture keeping the given node kinds; returns the heap it
+ *  took and the number of nodes in the result. */
+HeapUse parseHeapUse(const Fixture &f, int keep, unsigned long *nodes) {
+    TiXmlParseOptions options;
+    options.keep = keep;
+    TiXmlDocument doc;
+    heapBytes.store(0, std::memory_order_relaxed);
+    heapAllocations.store(0, std::memory_order_relaxed);
+    countHeap.store(true, std::memory_order_relaxed);
+    doc.Parse(f.corpus.xml.c_str(), options);
+    countHeap.store(false, std::memory_order_relaxed);
+    HeapUse use;
+    use.bytes = heapBytes.load(std::memory_order_relaxed);
+    use.allocations = heapAllocations.load(std::memory_order_relaxed);
+    CountingVisitor visitor;
+    doc.Accept(&visitor);
+    *nodes = visitor.nodes;
+    return use;
+}
+
+double percentLess(double before, double after) {
+    return before > 0 ? 100 * (before - after) / before : 0;
+}
+
+/** Appends the "filtering" object: what leaving out comments, unknowns and
+ *  declarations saves on this fixture. */
+void reportFiltering(const Fixture &f, double parseMedian, double filteredMedian, std::string &json) {
+    unsigned long keptNodes = 0, filteredNodes = 0;
+    const HeapUse kept = parseHeapUse(f, TiXmlParseOptions::KEEP_ALL, &keptNodes);
+    const HeapUse filtered = parseHeapUse(f, TiXmlParseOptions::KEEP_NONE, &filteredNodes);
+
+    json += ",\n     \"filtering\": {\"nodes\": ";
+    jsonNumber(json, (double)keptNodes);
+    json += ", \"heap_bytes\": ";
+    jsonNumber(json, (double)kept.bytes);
+    json += ", \"allocations\": ";
+    jsonNumber(json, (double)kept.allocations);
+    json += ", \"filtered_nodes\": ";
+    jsonNumber(json, (double)filteredNodes);
+    json += ", \"filtered_heap_bytes\": ";
+    jsonNumber(json, (double)filtered.bytes);
+    json += ", \"filtered_allocations\": ";
+    jsonNumber(json, (double)filtered.allocations);
+    // Leaving out under 1% of the nodes (the declaration, say) saves less
+    // than the times vary from run to run, so no time saved is claimed.
+    const bool leftOut = keptNodes - filteredNodes >= (keptNodes + 99) / 100;
+    json += ", \"time_saved_pct\": ";
+    if (leftOut)
+        jsonNumber(json, percentLess(parseMedian, filteredMedian));
+    else
+        json += "null";
+    json += ", \"heap_saved_pct\": ";
+    jsonNumber(json, percentLess((double)kept.bytes, (double)filtered.bytes));
+    json += "}";
+
+    if (leftOut)
+        fprintf(stderr, "%-12s %-10s %9.1f%% nodes %6.1f%% heap %6.1f%% time saved\n", f.corpus.name.c_str(), "filtering",
+            percentLess((double)keptNodes, (double)filteredNodes), percentLess((double)kept.bytes, (double)filtered.bytes),
+            percentLess(parseMedian, filteredMedian));
+    else
+        fprintf(stderr, "%-12s %-10s %9.1f%% nodes %6.1f%% heap, too few to time\n", f.corpus.name.c_str(), "filtering",
+            percentLess((double)keptNodes, (double)filteredNodes), percentLess((double)kept.bytes, (double)filtered.bytes));
+}
+
+/** Appends the "compaction" object: the memory of the edited document before
+ *  and after Compact(), as TiXmlDocument::MemoryStats() counts it. */
+void reportCompaction(const Fixture &f, std::string &json) {
+    const TiXmlMemoryStats edited = f.edited.MemoryStats();
+    const TiXmlMemoryStats compacted = f.compacted.MemoryStats();
+
+    json += ",\n     \"compaction\": {\"bytes\": ";
+    jsonNumber(json, (double)edited.totalBytes);
+    json += ", \"compacted_bytes\": ";
+    jsonNumber(json, (double)compacted.totalBytes);
+    json += ", \"block_bytes\": ";
+    jsonNumber(json, (double)f.compacted.CompactBytes());
+    json += ", \"saved_pct\": ";
+    jsonNumber(json, percentLess((double)edited.totalBytes, (double)compacted.totalBytes));
+    json += "}";
+
+    fprintf(stderr, "%-12s %-10s %9.1f%% memory saved\n", f.corpus.name.c_str(), "compaction",
+        percentLess((double)edited.totalBytes, (double)compacted.totalBytes));
+}
+
+/** Times every measurement on one fixture and appends its JSON object. */
+void runFixture(Fixture &f, const Options &options, std::string &json) {
+    json += "    {\"corpus\": ";
+    jsonString(json, f.corpus.name);
+    json += ", \"description\": ";
+    jsonString(json, f.corpus.description);
+    json += ", \"bytes\": ";
+    jsonNumber(json, (double)f.corpus.xml.size());
+    json += ", \"nodes\": ";
+    jsonNumber(json, (double)f.nodes);
+#ifdef TIXML_USE_ZLIB
+    json += ", \"gzip_bytes\": ";
+    jsonNumber(json, (double)f.gzipBytes);
+#endif
+    json += ",\n     \"measurements\": {";
+
+    const double mb = f.corpus.xml.size() / 1e6;
+    double parseMedian = 0, filteredMedian = 0;
+    for (size_t m = 0; m < sizeof(MEASUREMENTS) / sizeof(MEASUREMENTS[0]); ++m) {
+        std::vector<double> times;
+        for (int r = 0; r < options.repeat; ++r)
+            times.push_back(MEASUREMENTS[m].run(f));
+        std::sort(times.begin(), times.end());
+        const double median = times[times.size() / 2];
+        if (MEASUREMENTS[m].run == parse)
+            parseMedian = median;
+        else if (MEASUREMENTS[m].run == parseFiltered)
+            filteredMedian = median;
+
+        json += m ? ",\n        " : "\n        ";
+        jsonString(json, MEASUREMENTS[m].name);
+        json += ": {\"median_s\": ";
+        jsonNumber(json, median);
+        json += ", \"best_s\": ";
+        jsonNumber(json, times.front());
+        json += ", \"mb_per_s\": ";
+        jsonNumber(json, median > 0 ? mb / median : 0);
+        json += ", \"ns_per_node\": ";
+        jsonNumber(json, f.nodes ? median * 1e9 / f.nodes : 0);
+        json += "}";
+
+        fprintf(stderr, "%-12s %-10s %10.2f MB/s %8.1f ns/node\n", f.corpus.name.c_str(),
+            MEASUREMENTS[m].name, median > 0 ? mb / median : 0, f.nodes ? median * 1e9 / f.nodes : 0);
+    }
+    json += "}";
+    reportFiltering(f, parseMedian, filteredMedian, json);
+    reportCompaction(f, json);
+    json += "}";
+}
+
+/** Builds a document of 'nodes' elements, either all children of the root
+ *  or each nested in the one before, as XML text. */
+std::string scalingDocument(bool deep, size_t nodes) {
+    std::string xml;
+    xml.reserve(nodes * 8);
+    if (deep) {
+        for (size_t i = 0; i < nodes; ++i)
+            xml += "<n>";
+        for (size_t i = 0; i < nodes; ++i)
+            xml += "</n>";
+    } else {
+        xml += "<n>";
+        for (size_t i = 1; i < nodes; ++i)
+            xml += "<n a=\"1\"/>";
+        xml += "</n>";
+    }
+    return xml;
+}
+
+/** Times deleting documents of growing size, in both shapes, and appends the
+ *  "teardown_scaling" array. */
+void runTeardownScaling(const Options &options, std::string &json) {
+    json += ",\n  \"teardown_scaling\": [";
+    bool first = true;
+    for (int deep = 0; deep < 2; ++deep) {
+        for (size_t nodes = 1000; nodes <= options.scalingMax; nodes *= 10) {
+            const std::string xml = scalingDocument(deep != 0, nodes);
+            std::vector<double> times;
+            for (int r = 0; r < std::max(3, options.repeat / 3); ++r) {
+                TiXmlDocument *doc = new TiXmlDocument;
+                doc->Parse(xml.c_str());
+                if (doc->Error()) {
+                    fprintf(stderr, "scaling document: %s\n", doc->ErrorDesc());
+                    exit(1);
+                }
+                Clock::time_point start = Clock::now();
+                delete doc;
+                times.push_back(secondsSince(start));
+            }
+            std::sort(times.begin(), times.end());
+            const double median = times[times.size() / 2];
+
+            json += first ? "\n    " : ",\n    ";
+            first = false;
+            json += "{\"shape\": ";
+            jsonString(json, deep ? "deep" : "wide");
+            json += ", \"nodes\": ";
+            jsonNumber(json, (double)nodes);
+            json += ", \"median_s\": ";
+            jsonNumber(json, median);
+            json += ", \"ns_per_node\": ";
+            jsonNumber(json, median * 1e9 / nodes);
+            json += "}";
+
+            fprintf(stderr, "teardown     %-4s %9lu nodes %10.3f ms %8.1f ns/node\n", deep ? "deep" : "wide",
+                (unsigned long)nodes, median * 1e3, median * 1e9 / nodes);
+        }
+    }
+    json += "\n  ]";
+}
+
+#ifdef TIXML_USE_STL
+const TiXmlColumnSpec MANIFEST_COLUMNS[] = {
+    { "manifest", "ml:package", TiXmlColumnSpec::STRING, false },
+    { "manifest", "ml:version_code", TiXmlColumnSpec::INT64, false },
+    { "manifest/application", "ml:sdk_version", TiXmlColumnSpec::STRING, false },
+    { "manifest/application/component", "ml:type", TiXmlColumnSpec::STRING, true },
+    { "manifest/application/uses-privilege", "ml:name", TiXmlColumnSpec::STRING, true },
+};
+
+/** The same values as MANIFEST_COLUMNS through a DOM per document, into the
+ *  vectors a caller without the extractor would fill. Returns the values. */
+size_t domColumns(const std::vector<std::string> &documents) {
+    std::vector<std::string> packages, sdks, types, privileges;
+    std::vector<long long> codes;
+    for (const std::string &xml : documents) {
+        TiXmlDocument doc;
+        doc.Parse(xml.c_str());
+        const TiXmlElement *manifest = doc.RootElement();
+        if (!manifest)
+            continue;
+        const char *package = manifest->Attribute("ml:package");
+        packages.push_back(package ? package : "");
+        int code = 0;
+        manifest->QueryIntAttribute("ml:version_code", &code);
+        codes.push_back(code);
+        const TiXmlElement *application = manifest->FirstChildElement("application");
+        const char *sdk = application ? application->Attribute("ml:sdk_version") : nullptr;
+        sdks.push_back(sdk ? sdk : "");
+        if (!application)
+            continue;
+        for (const TiXmlElement *e = application->FirstChildElement("component"); e;
+             e = e->NextSiblingElement("component")) {
+            if (const char *type = e->Attribute("ml:type"))
+                types.push_back(type);
+        }
+        for (const TiXmlElement *e = application->FirstChildElement("uses-privilege"); e;
+             e = e->NextSiblingElement("uses-privilege")) {
+            if (const char *name = e->Attribute("ml:name"))
+                privileges.push_back(name);
+        }
+    }
+    return packages.size() + codes.size() + sdks.size() + types.size() + privileges.size();
+}
+
+size_t extractedValues(const TiXmlColumnBatch &batch) {
+    size_t values = 0;
+    for (int c = 0; c < batch.Columns(); ++c)
+        values += batch.Column(c).Values();
+    return values;
+}
+
+/** Generates the manifest corpus and cuts it into one document per manifest. */
+void splitManifests(const Options &options, Corpus *corpus, std::vector<std::string> *documents) {
+    generateCorpus("manifest", options.size, corpus);
+    for (size_t start = corpus->xml.find("<manifest\n"); start != std::string::npos;) {
+        const size_t end = corpus->xml.find("</manifest>", start) + strlen("</manifest>");
+        documents->push_back(corpus->xml.substr(start, end - start));
+        start = corpus->xml.find("<manifest\n", end);
+    }
+}
+
+/** Times extracting the manifest columns from every manifest of the corpus,
+ *  as separate documents, and appends the "columns" object. */
+void runColumns(const Options &options, std::string &json) {
+    Corpus corpus;
+    std::vector<std::string> documents;
+    splitManifests(options, &corpus, &documents);
+    std::vector<const char *> inputs;
+    for (const std::string &xml : documents)
+        inputs.push_back(xml.c_str());
+
+    const TiXmlColumnExtractor extractor(MANIFEST_COLUMNS, sizeof(MANIFEST_COLUMNS) / sizeof(MANIFEST_COLUMNS[0]));
+    const int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<double> dom, single, parallel;
+    for (int r = 0; r < std::max(3, options.repeat / 3); ++r) {
+        Clock::time_point start = Clock::now();
+        const size_t domValues = domColumns(documents);
+        dom.push_back(secondsSince(start));
+
+        TiXmlColumnBatch batch;
+        start = Clock::now();
+        extractor.ExtractBuffers(&inputs[0], inputs.size(), &batch, 1);
+        single.push_back(secondsSince(start));
+
+        start = Clock::now();
+        const bool ok = extractor.ExtractBuffers(&inputs[0], inputs.size(), &batch, threads);
+        parallel.push_back(secondsSince(start));
+
+        if (!ok || batch.Rows() != documents.size() || extractedValues(batch) != domValues) {
+            fprintf(stderr, "columns: extracted %zu values from %zu rows, expected %zu from %zu\n",
+                extractedValues(batch), batch.Rows(), domValues, documents.size());
+            exit(1);
+        }
+    }
+    std::sort(dom.begin(), dom.end());
+    std::sort(single.begin(), single.end());
+    std::sort(parallel.begin(), parallel.end());
+    const double domMedian = dom[dom.size() / 2];
+    const double singleMedian = single[single.size() / 2];
+    const double parallelMedian = parallel[parallel.size() / 2];
+
+    json += ",\n  \"columns\": {\"documents\": ";
+    jsonNumber(json, (double)documents.size());
+    json += ", \"bytes\": ";
+    jsonNumber(json, (double)corpus.xml.size());
+    json += ", \"threads\": ";
+    jsonNumber(json, threads);
+    json += ", \"dom_s\": ";
+    jsonNumber(json, domMedian);
+    json += ", \"extract_s\": ";
+    jsonNumber(json, singleMedian);
+    json += ", \"extract_parallel_s\": ";
+    jsonNumber(json, parallelMedian);
+    json += "}";
+
+    fprintf(stderr, "columns      %zu documents: dom %.1f ms, extract %.1f ms, %d threads %.1f ms\n",
+        documents.size(), domMedian * 1e3, singleMedian * 1e3, threads, parallelMedian * 1e3);
+}
+
+const char *const MANIFEST_TYPES[] = { "Fullscreen", "Console", nullptr };
+const char *const MANIFEST_PRIVILEGES[] = {
+    "AudioCaptureMic", "CameraCapture", "ControllerPose", "LowLatencyLightwear", "WorldReconstruction", nullptr
+};
+
+const TiXmlValidateRule MANIFEST_RULES[] = {
+    TIXML_VALIDATE_OCCURS("manifest", 1, 1),
+    TIXML_VALIDATE_OCCURS("manifest/application", 1, 1),
+    TIXML_VALIDATE_REQUIRED("manifest", "ml:package"),
+    TIXML_VALIDATE_REQUIRED("manifest", "ml:version_code"),
+    TIXML_VALIDATE_FORMAT("manifest", "ml:version_code", "#"),
+    TIXML_VALIDATE_REQUIRED("manifest/application", "ml:sdk_version"),
+    TIXML_VALIDATE_FORMAT("manifest/application", "ml:sdk_version", "#.#.#"),
+    TIXML_VALIDATE_REQUIRED("manifest/application/component", "ml:type"),
+    TIXML_VALIDATE_ONE_OF("manifest/application/component", "ml:type", MANIFEST_TYPES),
+    TIXML_VALIDATE_ONE_OF("manifest/application/uses-privilege", "ml:name", MANIFEST_PRIVILEGES),
+};
+
+bool oneOf(const char *value, const char *const *values) {
+    for (; *values; ++values) {
+        if (!strcmp(value, *values))
+            return true;
+    }
+    return false;
+}
+
+/** True if 'value' is "#.#.#": three dot separated runs of digits. */
+bool versionFormat(const char *value) {
+    for (int part = 0; part < 3; ++part) {
+        if (part && *value++ != '.')
+            return false;
+        if (!isdigit((unsigned char)*value))
+            return false;
+        while (isdigit((unsigned char)*value))
+            ++value;
+    }
+    return *value == 0;
+}
+
+/** MANIFEST_RULES checked the way they were before TiXmlValidator: a DOM
+ *  per document, walked once for each rule. Returns the violations. */
+size_t domValidate(const std::vector<std::string> &documents) {
+    size_t violations = 0;
+    for (const std::string &xml : documents) {
+        TiXmlDocument doc;
+        doc.Parse(xml.c_str());
+        const TiXmlElement *manifest = doc.RootElement();
+        if (doc.Error() || !manifest || strcmp(manifest->Value(), "manifest")) {
+            ++violations;
+            continue;
+        }
+        int applications = 0;
+        for (const TiXmlElement *e = manifest->FirstChildElement("application"); e; e = e->NextSiblingElement("application"))
+            ++applications;
+        violations += applications != 1;
+        violations += !manifest->Attribute("ml:package");
+        const char *code = manifest->Attribute("ml:version_code");
+        violations += !code || !*code || strspn(code, "0123456789") != strlen(code);
+        const TiXmlElement *application = manifest->FirstChildElement("application");
+        if (!application)
+            continue;
+        const char *sdk = application->Attribute("ml:sdk_version");
+        violations += !sdk || !versionFormat(sdk);
+        for (const TiXmlElement *e = application->FirstChildElement("component"); e; e = e->NextSiblingElement("component")) {
+            const char *type = e->Attribute("ml:type");
+            violations += !type || !oneOf(type, MANIFEST_TYPES);
+        }
+        for (const TiXmlElement *e = application->FirstChildElement("uses-privilege"); e;
+             e = e->NextSiblingElement("uses-privilege")) {
+            const char *name = e->Attribute("ml:name");
+            violations += name && !oneOf(name, MANIFEST_PRIVILEGES);
+        }
+    }
+    return violations;
+}
+
+/** Times checking MANIFEST_RULES on every manifest of the corpus, through a
+ *  DOM and with TiXmlValidator, and appends the "validate" object. */
+void runValidate(const Options &options, std::string &json) {
+    Corpus corpus;
+    std::vector<std::string> documents;
+    splitManifests(options, &corpus, &documents);
+
+    const TiXmlValidator validator(MANIFEST_RULES, sizeof(MANIFEST_RULES) / sizeof(MANIFEST_RULES[0]));
+    std::vector<double> dom, single;
+    std::vector<TiXmlValidationError> errors;
+    for (int r = 0; r < std::max(3, options.repeat / 3); ++r) {
+        Clock::time_point start = Clock::now();
+        const size_t domViolations = domValidate(documents);
+        dom.push_back(secondsSince(start));
+
+        size_t violations = 0;
+        start = Clock::now();
+        for (const std::string &xml : documents) {
+            validator.Validate(xml.c_str(), &errors);
+            violations += errors.size();
+        }
+        single.push_back(secondsSince(start));
+
+        if (violations != domViolations) {
+            fprintf(stderr, "validate: found %zu violations, expected %zu\n", violations, domViolations);
+            exit(1);
+        }
+    }
+    std::sort(dom.begin(), dom.end());
+    std::sort(single.begin(), single.end());
+    const double domMedian = dom[dom.size() / 2];
+    const double singleMedian = single[single.size() / 2];
+
+    json += ",\n  \"validate\": {\"documents\": ";
+    jsonNumber(json, (double)documents.size());
+    json += ", \"rules\": ";
+    jsonNumber(json, (double)(sizeof(MANIFEST_RULES) / sizeof(MANIFEST_RULES[0])));
+    json += ", \"dom_s\": ";
+    jsonNumber(json, domMedian);
+    json += ", \"validate_s\": ";
+    jsonNumber(json, singleMedian);
+    json += "}";
+
+    fprintf(stderr, "validate     %zu documents: dom %.1f ms, validate %.1f ms\n",
+        documents.size(), domMedian * 1e3, singleMedian * 1e3);
+}
+
+/** Runs 'readers' threads that each call read() 'reads' times, while this
+ *  thread calls publish() with the next document every millisecond, and
+ *  returns the seconds until the readers are done. */
+template <class Read, class Publish>
+double readWhilePublishing(int readers, size_t reads, const std::vector<std::string> &documents,
+                           Read read, Publish publish, size_t *found) {
+    std::atomic<int> running(readers);
+    std::atomic<size_t> total(0);
+    std::vector<std::thread> threads;
+    const Clock::time_point start = Clock::now();
+    for (int t = 0; t < readers; ++t) {
+        threads.emplace_back([&] {
+            size_t n = read(reads);
+            total += n;
+            --running;
+        });
+    }
+    for (size_t i = 1; running.load(); ++i) {
+        TiXmlDocument *doc = new TiXmlDocument();
+        doc->Parse(documents[i % documents.size()].c_str());
+        publish(doc);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (std::thread &t : threads)
+        t.join();
+    *found = total;
+    return secondsSince(start);
+}
+
+size_t packageLength(const TiXmlDocument *doc) {
+    const char *package = doc->RootElement()->Attribute("ml:package");
+    return package ? strlen(package) : 0;
+}
+
+/** Times reads of a document that is being replaced, and appends the
+ *  "publish" object. */
+void runPublish(const Options &options, std::string &json) {
+    Corpus corpus;
+    std::vector<std::string> documents;
+    splitManifests(options, &corpus, &documents);
+
+    const int readers = std::max(2u, std::thread::hardware_concurrency());
+    const size_t reads = 200000;
+    std::vector<double> locked, published;
+    for (int r = 0; r < std::max(3, options.repeat / 3); ++r) {
+        std::mutex mutex;
+        std::shared_ptr<const TiXmlDocument> shared;
+        TiXmlDocument *first = new TiXmlDocument();
+        first->Parse(documents[0].c_str());
+        shared.reset(first);
+        size_t lockedFound = 0;
+        locked.push_back(readWhilePublishing(readers, reads, documents,
+            [&](size_t n) {
+                size_t found = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    std::shared_ptr<const TiXmlDocument> doc;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        doc = shared;
+                    }
+                    found += packageLength(doc.get());
+                }
+                return found;
+            },
+            [&](TiXmlDocument *doc) {
+                std::shared_ptr<const TiXmlDocument> next(doc);
+                std::lock_guard<std::mutex> lock(mutex);
+                shared.swap(next);
+            }, &lockedFound));
+
+        TiXmlPublishedDocument publisher;
+        first = new TiXmlDocument();
+        first->Parse(documents[0].c_str());
+        publisher.Publish(first);
+        size_t publishedFound = 0;
+        published.push_back(readWhilePublishing(readers, reads, documents,
+            [&](size_t n) {
+                TiXmlDocumentSubscription subscription(publisher);
+                size_t found = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    TiXmlDocumentRead read(subscription);
+                    found += packageLength(read.Get());
+                }
+                return found;
+            },
+            [&](TiXmlDocument *doc) { publisher.Publish(doc); }, &publishedFound));
+
+        if (!lockedFound || !publishedFound) {
+            fprintf(stderr, "publish: no package names found\n");
+            exit(1);
+        }
+    }
+    std::sort(locked.begin(), locked.end());
+    std::sort(published.begin(), published.end());
+    const double lockedMedian = locked[locked.size() / 2];
+    const double publishedMedian = published[published.size() / 2];
+
+    json += ",\n  \"publish\": {\"readers\": ";
+    jsonNumber(json, readers);
+    json += ", \"reads\": ";
+    jsonNumber(json, (double)(reads * readers));
+    json += ", \"mutex_s\": ";
+    jsonNumber(json, lockedMedian);
+    json += ", \"publish_s\": ";
+    jsonNumber(json, publishedMedian);
+    json += "}";
+
+    fprintf(stderr, "publish      %d readers x %zu reads: mutex %.1f ms, published %.1f ms\n",
+        readers, reads, lockedMedian * 1e3, publishedMedian * 1e3);
+}
+
+/** Looks a record up by reading the file from the start, as there is no
+ *  other way without an index, and returns the length of its name. */
+size_t scanRecord(const std::string &xml, const std::string &id) {
+    TiXmlReader reader(xml.c_str());
+    TiXmlReader::Token token;
+    bool found = false;
+    while ((token = reader.Next()) != TiXmlReader::TOKEN_END_DOCUMENT && token != TiXmlReader::TOKEN_ERROR) {
+        if (token == TiXmlReader::TOKEN_START_ELEMENT && reader.Depth() == 2) {
+            const char *value = reader.Attribute("id");
+            found = value && id == value;
+        } else if (found && token == TiXmlReader::TOKEN_TEXT) {
+            return reader.TextLength();
+        }
+    }
+    return 0;
+}
+
+/** Times building an offset index of the annotated corpus and looking
+ *  records up with and without it, and appends the "index" object. */
+void runIndex(const Options &options, std::string &json) {
+    Corpus corpus;
+    generateCorpus("annotated", options.size, &corpus);
+    const std::string path = options.dir + "/tinyxmlbench-index.xml";
+    const std::string indexPath = path + ".idx";
+    if (!writeFile(path, corpus.xml)) {
+        fprintf(stderr, "can't write %s\n", path.c_str());
+        exit(1);
+    }
+
+    std::vector<double> build, scan, lookup;
+    size_t records = 0, indexBytes = 0;
+    const int lookups = 1000, scans = 10;
+    for (int r = 0; r < std::max(3, options.repeat / 3); ++r) {
+        std::string error;
+        Clock::time_point start = Clock::now();
+        const bool built = TiXmlOffsetIndex::Build(path.c_str(), indexPath.c_str(), 2, "id", &error);
+        build.push_back(secondsSince(start));
+
+        TiXmlOffsetIndex index;
+        if (!built || !index.Open(path.c_str(), indexPath.c_str(), &error)) {
+            fprintf(stderr, "index: %s\n", error.c_str());
+            exit(1);
+        }
+        records = index.Records();
+        std::string image;
+        readFile(indexPath, &image);
+        indexBytes = image.size();
+
+        // The same spread of records both ways, from the start to the end.
+        size_t scanned = 0, indexed = 0;
+        start = Clock::now();
+        for (int i = 0; i < scans; ++i)
+            scanned += scanRecord(corpus.xml, std::to_string(records * i / scans));
+        scan.push_back(secondsSince(start) / scans);
+
+        TiXmlDocument doc;
+        start = Clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            const TiXmlElement *record = index.Find(std::to_string(records * i / lookups).c_str(), &doc);
+            const char *name = record ? record->FirstChildElement("name")->GetText() : nullptr;
+            if (!name) {
+                fprintf(stderr, "index: record %zu not found\n", records * i / lookups);
+                exit(1);
+            }
+            if (i % (lookups / scans) == 0)
+                indexed += strlen(name);
+        }
+        lookup.push_back(secondsSince(start) / lookups);
+
+        if (scanned != indexed) {
+            fprintf(stderr, "index: scanning found %zu name bytes, the index %zu\n", scanned, indexed);
+            exit(1);
+        }
+    }
+    std::sort(build.begin(), build.end());
+    std::sort(scan.begin(), scan.end());
+    std::sort(lookup.begin(), lookup.end());
+    const double buildMedian = build[build.size() / 2];
+    const double scanMedian = scan[scan.size() / 2];
+    const double lookupMedian = lookup[lookup.size() / 2];
+
+    json += ",\n  \"index\": {\"records\": ";
+    jsonNumber(json, (double)records);
+    json += ", \"bytes\": ";
+    jsonNumber(json, (double)corpus.xml.size());
+    json += ", \"index_bytes\": ";
+    jsonNumber(json, (double)indexBytes);
+    json += ", \"build_s\": ";
+    jsonNumber(json, buildMedian);
+    json += ", \"scan_lookup_s\": ";
+    jsonNumber(json, scanMedian);
+    json += ", \"index_lookup_s\": ";
+    jsonNumber(json, lookupMedian);
+    json += "}";
+
+    fprintf(stderr, "index        %zu records: build %.1f ms, lookup by scan %.3f ms, by index %.3f ms\n",
+        records, buildMedian * 1e3, scanMedian * 1e3, lookupMedian * 1e3);
+}
+#endif
+
+bool prepare(Fixture &f, const Options &options) {
+    if (f.path.empty()) {
+        f.path = options.dir + "/tinyxmlbench-" + f.corpus.name + ".xml";
+        if (!writeFile(f.path, f.corpus.xml)) {
+            fprintf(stderr, "can't write %s\n", f.path.c_str());
+            return false;
+        }
+    }
+    f.savePath = options.dir + "/tinyxmlbench-saved.xml";
+#ifdef TIXML_USE_ZLIB
+    // The same bytes gzipped, at zlib's default level. A corpus read from
+    // --file gets a scratch name, as it doesn't have one in --dir.
+    f.gzipPath = options.dir + "/tinyxmlbench-" +
+        (f.corpus.description == "file" ? std::string("file") : f.corpus.name) + ".xml.gz";
+    gzFile gz = gzopen(f.gzipPath.c_str(), "wb6");
+    if (!gz || gzwrite(gz, f.corpus.xml.data(), (unsigned)f.corpus.xml.size()) != (int)f.corpus.xml.size() ||
+        gzclose(gz) != Z_OK) {
+        fprintf(stderr, "can't write %s\n", f.gzipPath.c_str());
+        return false;
+    }
+    std::string compressed;
+    if (!readFile(f.gzipPath, &compressed))
+        return false;
+    f.gzipBytes = compressed.size();
+#endif
+    f.doc.Parse(f.corpus.xml.c_str());
+    if (f.doc.Error()) {
+        fprintf(stderr, "%s: %s (row %d)\n", f.corpus.name.c_str(), f.doc.ErrorDesc(), f.doc.ErrorRow());
+        return false;
+    }
+    CountingVisitor visitor;
+    f.doc.Accept(&visitor);
+    f.nodes = visitor.nodes;
+    f.reused.SetReuseStorage(true);
+    f.reused.Parse(f.corpus.xml.c_str());
+    f.edited.Parse(f.corpus.xml.c_str());
+    editBurst(f.edited);
+    f.compacted.Parse(f.corpus.xml.c_str());
+    editBurst(f.compacted);
+    f.compacted.Compact();
+    return true;
+}
+
+}
+
+
+int main(int argc, char **argv) {
+
+    Options options;
+    if (!parseOptions(argc, argv, &options))
+        return 2;
+    if (options.corpora.empty() && options.files.empty())
+        options.corpora = corpusNames();
+
+    std::string json = "{\n  \"benchmark\": \"tinyxml\",\n  \"tinyxml_version\": \"";
+    json += std::to_string(TIXML_MAJOR_VERSION) + "." + std::to_string(TIXML_MINOR_VERSION) + "." +
+        std::to_string(TIXML_PATCH_VERSION);
+    json += "\",\n  \"compiler\": ";
+#ifdef __VERSION__
+    jsonString(json, __VERSION__);
+#else
+    jsonString(json, "unknown");
+#endif
+#ifdef TIXML_USE_STL
+    json += ",\n  \"stl\": true";
+#else
+    json += ",\n  \"stl\": false";
+#endif
+#ifdef TIXML_USE_ZLIB
+    json += ",\n  \"zlib\": true";
+#else
+    json += ",\n  \"zlib\": false";
+#endif
+    json += ",\n  \"repeat\": " + std::to_string(options.repeat);
+    json += ",\n  \"results\": [\n";
+
+    bool first = true;
+    std::vector<Fixture *> fixtures;
+    for (const std::string &name : options.corpora) {
+        Fixture *f = new Fixture;
+        if (!generateCorpus(name, options.size, &f->corpus)) {
+            fprintf(stderr, "unknown corpus %s\n", name.c_str());
+            return 2;
+        }
+        fixtures.push_back(f);
+    }
+    for (const std::string &path : options.files) {
+        Fixture *f = new Fixture;
+        f->path = path;
+        f->corpus.name = path;
+        f->corpus.description = "file";
+        if (!readFile(path, &f->corpus.xml)) {
+            fprintf(stderr, "can't read %s\n", path.c_str());
+            return 2;
+        }
+        fixtures.push_back(f);
+    }
+
+    for (Fixture *f : fixtures) {
+        if (!prepare(*f, options))
+            return 1;
+        if (!first)
+            json += ",\n";
+        first = false;
+        runFixture(*f, options, json);
+        delete f;
+    }
+    json += "\n  ]";
+    if (options.scalingMax >= 1000)
+        runTeardownScaling(options, json);
+#ifdef TIXML_USE_STL
+    runColumns(options, json);
+    runValidate(options, json);
+    runPublish(options, json);
+    runIndex(options, json);
+#endif
+    json += "\n}\n";
+
+    if (options.out.empty()) {
+        fputs(json.c_str(), stdout);
+    } else if (!writeFile(options.out, json)) {
+        fprintf(stderr, "can't write %s\n", options.out.c_str());
+        return 1;
+    }
+    return 0;
+
+}
@@ -10,7 +10,8 @@
 #include <ml_logging.h>
 //#include <ml_perception.h>
 
-#include "tinyxml.h"
+#include "LoadTimingLog.h"
+#include "ManifestInfo.h"
 
 
 static const char APP_TAG[] = "ManifestParsing";
@@ -19,13 +20,31 @@ int main () {
 
     MLLifecycleInit(NULL, NULL);
 
-    TiXmlDocument manifest;
-    if (!manifest.LoadFile("manifest.xml")) {
-        ML_LOG_TAG(Error, APP_TAG, "Failed to load manifest.xml: %s", manifest.ErrorDesc());
+    // Validate and bind in one pass over the file, logging how long each phase takes.
+    LoadTimingLog timing(APP_TAG);
+    const TiXmlValidator validator(ManifestInfo::validateRules,
+        sizeof(ManifestInfo::validateRules) / sizeof(ManifestInfo::validateRules[0]));
+    std::vector<TiXmlValidationError> errors;
+    ManifestInfo manifest;
+    std::string error;
+    if (!TiXmlBindLoadFile("manifest.xml", &manifest, validator, &errors, &error, &timing)) {
+        for (size_t i = 0; i < errors.size(); ++i) {
+            ML_LOG_TAG(Error, APP_TAG, "manifest.xml:%d:%d: %s", errors[i].row, errors[i].col, errors[i].message.c_str());
+        }
+        if (!error.empty()) {
+            ML_LOG_TAG(Error, APP_TAG, "Failed to load manifest.xml: %s", error.c_str());
+        }
         return 1;
     }
 
-    ML_LOG_TAG(Info, APP_TAG, "Loaded manifest.");
+    ML_LOG_TAG(Info, APP_TAG, "Loaded manifest for %s %s (version code %d, sdk %s).",
+        manifest.package.c_str(), manifest.versionName.c_str(), manifest.versionCode, manifest.sdkVersion.c_str());
+    for (size_t i = 0; i < manifest.componentNames.size(); ++i) {
+        ML_LOG_TAG(Info, APP_TAG, "Component %s", manifest.componentNames[i].c_str());
+    }
+    for (size_t i = 0; i < manifest.privileges.size(); ++i) {
+        ML_LOG_TAG(Info, APP_TAG, "Privilege %s", manifest.privileges[i].c_str());
+    }
 
     MLLifecycleSetReadyIndication();
 
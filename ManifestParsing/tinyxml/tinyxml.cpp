@@ -23,18 +23,61 @@ distribution.
 */
 
 #include <ctype.h>
+#include <time.h>
+#include <new>
 
 #ifdef TIXML_USE_STL
 #include <sstream>
 #include <iostream>
 #endif
 
+#if defined( _WIN32 )
+#include <windows.h>
+#endif
+
 #include "tinyxml.h"
+#include "tinyxmlprepass.h"
+#include "tinyxmlfile.h"
 
 FILE* TiXmlFOpen( const char* filename, const char* mode );
+char* TiXmlReadFile( FILE* file, size_t maxBytes, long* length, int* errorId, long* fileLength = 0, unsigned long long* readEnd = 0, TiXmlPrepass* prepass = 0 );
+#ifdef TIXML_USE_ZLIB
+char* TiXmlInflateFile( FILE* file, long fileLength, size_t maxBytes, long* length, int* errorId );
+bool TiXmlDeflateDocument( const TiXmlDocument& document, bool bom, FILE* file, int level );
+#endif
 
 bool TiXmlBase::condenseWhiteSpace = true;
 
+bool TiXmlParseOptions::CondenseWhiteSpace() const
+{
+	if ( whiteSpace == WHITESPACE_DEFAULT )
+		return TiXmlBase::IsWhiteSpaceCondensed();
+	return whiteSpace == WHITESPACE_CONDENSE;
+}
+
+const char* TiXmlParsePhase::Name() const
+{
+	static const char* const names[] = { "open", "clear", "read", "normalize", "parse", "error", "release" };
+	return names[ phase ];
+}
+
+unsigned long long TiXmlParseObserver::Now()
+{
+	#if defined( _WIN32 )
+		LARGE_INTEGER count, frequency;
+		QueryPerformanceCounter( &count );
+		QueryPerformanceFrequency( &frequency );
+		return (unsigned long long)( count.QuadPart / frequency.QuadPart ) * 1000000000ULL
+			 + (unsigned long long)( count.QuadPart % frequency.QuadPart ) * 1000000000ULL / frequency.QuadPart;
+	#elif defined( CLOCK_MONOTONIC )
+		struct timespec now;
+		clock_gettime( CLOCK_MONOTONIC, &now );
+		return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+	#else
+		return (unsigned long long)clock() * ( 1000000000ULL / CLOCKS_PER_SEC );
+	#endif
+}
+
 // Microsoft compiler security
 FILE* TiXmlFOpen( const char* filename, const char* mode )
 {
@@ -137,24 +180,46 @@ TiXmlNode::TiXmlNode( NodeType _type ) : TiXmlBase()
 {
 	parent = 0;
 	type = _type;
+	packed = false;
 	firstChild = 0;
 	lastChild = 0;
 	prev = 0;
 	next = 0;
+	hash = 0;
 }
 
 
 TiXmlNode::~TiXmlNode()
 {
-	TiXmlNode* node = firstChild;
-	TiXmlNode* temp = 0;
+	DeleteNodes( firstChild );
+}
+
 
+void TiXmlNode::DeleteNodes( TiXmlNode* node )
+{
 	while ( node )
 	{
-		temp = node;
+		if ( node->firstChild )
+		{
+			node->lastChild->next = node->next;
+			node->next = node->firstChild;
+			node->firstChild = 0;
+			node->lastChild = 0;
+		}
+
+		TiXmlNode* temp = node;
 		node = node->next;
-		delete temp;
-	}	
+		Destroy( temp );
+	}
+}
+
+
+void TiXmlNode::Destroy( TiXmlNode* node )
+{
+	if ( node->packed )
+		node->~TiXmlNode();
+	else
+		delete node;
 }
 
 
@@ -168,18 +233,29 @@ void TiXmlNode::CopyTo( TiXmlNode* target ) const
 
 void TiXmlNode::Clear()
 {
-	TiXmlNode* node = firstChild;
-	TiXmlNode* temp = 0;
+	// Nothing to forget for a node without children, which is also how
+	// DeleteNodes() leaves a node it deletes.
+	if ( firstChild )
+		InvalidateHash();
 
-	while ( node )
-	{
-		temp = node;
-		node = node->next;
-		delete temp;
-	}	
+	// A document that reuses its storage keeps the nodes for its next parse.
+	TiXmlStorage* storage = ( type == TINYXML_DOCUMENT ) ? static_cast< TiXmlDocument* >( this )->storage : 0;
+	if ( storage )
+		storage->Reclaim( firstChild );
+	else
+		DeleteNodes( firstChild );
 
 	firstChild = 0;
 	lastChild = 0;
+
+	// With every node gone, so is the use of a document's block.
+	if ( type == TINYXML_DOCUMENT )
+	{
+		TiXmlDocument* document = static_cast< TiXmlDocument* >( this );
+		delete [] document->block;
+		document->block = 0;
+		document->blockBytes = 0;
+	}
 }
 
 
@@ -196,6 +272,7 @@ TiXmlNode* TiXmlNode::LinkEndChild( TiXmlNode* node )
 		return 0;
 	}
 
+	InvalidateHash();
 	node->parent = this;
 
 	node->prev = lastChild;
@@ -242,6 +319,7 @@ TiXmlNode* TiXmlNode::InsertBeforeChild( TiXmlNode* beforeThis, const TiXmlNode&
 	TiXmlNode* node = addThis.Clone();
 	if ( !node )
 		return 0;
+	InvalidateHash();
 	node->parent = this;
 
 	node->next = beforeThis;
@@ -275,6 +353,7 @@ TiXmlNode* TiXmlNode::InsertAfterChild( TiXmlNode* afterThis, const TiXmlNode& a
 	TiXmlNode* node = addThis.Clone();
 	if ( !node )
 		return 0;
+	InvalidateHash();
 	node->parent = this;
 
 	node->prev = afterThis;
@@ -312,6 +391,7 @@ TiXmlNode* TiXmlNode::ReplaceChild( TiXmlNode* replaceThis, const TiXmlNode& wit
 	TiXmlNode* node = withThis.Clone();
 	if ( !node )
 		return 0;
+	InvalidateHash();
 
 	node->next = replaceThis->next;
 	node->prev = replaceThis->prev;
@@ -326,7 +406,7 @@ TiXmlNode* TiXmlNode::ReplaceChild( TiXmlNode* replaceThis, const TiXmlNode& wit
 	else
 		firstChild = node;
 
-	delete replaceThis;
+	Destroy( replaceThis );
 	node->parent = this;
 	return node;
 }
@@ -343,6 +423,7 @@ bool TiXmlNode::RemoveChild( TiXmlNode* removeThis )
 		assert( 0 );
 		return false;
 	}
+	InvalidateHash();
 
 	if ( removeThis->next )
 		removeThis->next->prev = removeThis->prev;
@@ -354,7 +435,7 @@ bool TiXmlNode::RemoveChild( TiXmlNode* removeThis )
 	else
 		firstChild = removeThis->next;
 
-	delete removeThis;
+	Destroy( removeThis );
 	return true;
 }
 
@@ -445,7 +526,8 @@ void TiXmlElement::RemoveAttribute( const char * name )
 	if ( node )
 	{
 		attributeSet.Remove( node );
-		delete node;
+		TiXmlAttribute::Destroy( node );
+		InvalidateHash();
 	}
 }
 
@@ -509,6 +591,41 @@ const TiXmlElement* TiXmlNode::NextSiblingElement( const char * _value ) const
 }
 
 
+// The first element from 'node' on, itself included, named 'name'. Checks the
+// type rather than calling ToElement(), so each sibling costs two compares.
+static const TiXmlElement* TiXmlFindElement( const TiXmlNode* node, const TiXmlName& name )
+{
+	if ( !name.IsValid() )
+		return 0;
+	for ( ; node; node = node->NextSibling() )
+	{
+		if ( node->Type() == TiXmlNode::TINYXML_ELEMENT && static_cast< const TiXmlElement* >( node )->QName() == name )
+			return static_cast< const TiXmlElement* >( node );
+	}
+	return 0;
+}
+
+
+const TiXmlElement* TiXmlNode::FirstChildElement( const TiXmlName& name ) const
+{
+	return TiXmlFindElement( firstChild, name );
+}
+
+
+const TiXmlElement* TiXmlNode::NextSiblingElement( const TiXmlName& name ) const
+{
+	return TiXmlFindElement( next, name );
+}
+
+
+void TiXmlNode::ValueChanged()
+{
+	InvalidateHash();
+	if ( TiXmlElement* element = ToElement() )
+		element->qname = TiXmlName();
+}
+
+
 const TiXmlDocument* TiXmlNode::GetDocument() const
 {
 	const TiXmlNode* node;
@@ -527,6 +644,7 @@ TiXmlElement::TiXmlElement (const char * _value)
 {
 	firstChild = lastChild = 0;
 	value = _value;
+	attributeSet.SetOwner( this );
 }
 
 
@@ -536,6 +654,7 @@ TiXmlElement::TiXmlElement( const std::string& _value )
 {
 	firstChild = lastChild = 0;
 	value = _value;
+	attributeSet.SetOwner( this );
 }
 #endif
 
@@ -544,6 +663,7 @@ TiXmlElement::TiXmlElement( const TiXmlElement& copy)
 	: TiXmlNode( TiXmlNode::TINYXML_ELEMENT )
 {
 	firstChild = lastChild = 0;
+	attributeSet.SetOwner( this );
 	copy.CopyTo( this );	
 }
 
@@ -565,12 +685,7 @@ TiXmlElement::~TiXmlElement()
 void TiXmlElement::ClearThis()
 {
 	Clear();
-	while( attributeSet.First() )
-	{
-		TiXmlAttribute* node = attributeSet.First();
-		attributeSet.Remove( node );
-		delete node;
-	}
+	attributeSet.Clear();
 }
 
 
@@ -583,6 +698,21 @@ const char* TiXmlElement::Attribute( const char* name ) const
 }
 
 
+const TiXmlAttribute* TiXmlElement::FindAttribute( const TiXmlName& name ) const
+{
+	return attributeSet.Find( name );
+}
+
+
+const char* TiXmlElement::Attribute( const TiXmlName& name ) const
+{
+	const TiXmlAttribute* node = FindAttribute( name );
+	if ( node )
+		return node->Value();
+	return 0;
+}
+
+
 #ifdef TIXML_USE_STL
 const std::string* TiXmlElement::Attribute( const std::string& name ) const
 {
@@ -742,6 +872,7 @@ void TiXmlElement::SetAttribute( const char * name, int val )
 	TiXmlAttribute* attrib = attributeSet.FindOrCreate( name );
 	if ( attrib ) {
 		attrib->SetIntValue( val );
+		InvalidateHash();
 	}
 }
 
@@ -752,6 +883,7 @@ void TiXmlElement::SetAttribute( const std::string& name, int val )
 	TiXmlAttribute* attrib = attributeSet.FindOrCreate( name );
 	if ( attrib ) {
 		attrib->SetIntValue( val );
+		InvalidateHash();
 	}
 }
 #endif
@@ -762,6 +894,7 @@ void TiXmlElement::SetDoubleAttribute( const char * name, double val )
 	TiXmlAttribute* attrib = attributeSet.FindOrCreate( name );
 	if ( attrib ) {
 		attrib->SetDoubleValue( val );
+		InvalidateHash();
 	}
 }
 
@@ -772,6 +905,7 @@ void TiXmlElement::SetDoubleAttribute( const std::string& name, double val )
 	TiXmlAttribute* attrib = attributeSet.FindOrCreate( name );
 	if ( attrib ) {
 		attrib->SetDoubleValue( val );
+		InvalidateHash();
 	}
 }
 #endif 
@@ -782,6 +916,7 @@ void TiXmlElement::SetAttribute( const char * cname, const char * cvalue )
 	TiXmlAttribute* attrib = attributeSet.FindOrCreate( cname );
 	if ( attrib ) {
 		attrib->SetValue( cvalue );
+		InvalidateHash();
 	}
 }
 
@@ -792,6 +927,7 @@ void TiXmlElement::SetAttribute( const std::string& _name, const std::string& _v
 	TiXmlAttribute* attrib = attributeSet.FindOrCreate( _name );
 	if ( attrib ) {
 		attrib->SetValue( _value );
+		InvalidateHash();
 	}
 }
 #endif
@@ -912,15 +1048,31 @@ const char* TiXmlElement::GetText() const
 
 TiXmlDocument::TiXmlDocument() : TiXmlNode( TiXmlNode::TINYXML_DOCUMENT )
 {
-	tabsize = 4;
 	useMicrosoftBOM = false;
+	compression = COMPRESS_AUTO;
+	inputBytes = peakBytes = 0;
+	prepass = 0;
+	observer = 0;
+	errorTime = 0;
+	storage = 0;
+	names = 0;
+	block = 0;
+	blockBytes = 0;
 	ClearError();
 }
 
 TiXmlDocument::TiXmlDocument( const char * documentName ) : TiXmlNode( TiXmlNode::TINYXML_DOCUMENT )
 {
-	tabsize = 4;
 	useMicrosoftBOM = false;
+	compression = COMPRESS_AUTO;
+	inputBytes = peakBytes = 0;
+	prepass = 0;
+	observer = 0;
+	errorTime = 0;
+	storage = 0;
+	names = 0;
+	block = 0;
+	blockBytes = 0;
 	value = documentName;
 	ClearError();
 }
@@ -929,8 +1081,16 @@ TiXmlDocument::TiXmlDocument( const char * documentName ) : TiXmlNode( TiXmlNode
 #ifdef TIXML_USE_STL
 TiXmlDocument::TiXmlDocument( const std::string& documentName ) : TiXmlNode( TiXmlNode::TINYXML_DOCUMENT )
 {
-	tabsize = 4;
 	useMicrosoftBOM = false;
+	compression = COMPRESS_AUTO;
+	inputBytes = peakBytes = 0;
+	prepass = 0;
+	observer = 0;
+	errorTime = 0;
+	storage = 0;
+	names = 0;
+	block = 0;
+	blockBytes = 0;
     value = documentName;
 	ClearError();
 }
@@ -939,10 +1099,40 @@ TiXmlDocument::TiXmlDocument( const std::string& documentName ) : TiXmlNode( TiX
 
 TiXmlDocument::TiXmlDocument( const TiXmlDocument& copy ) : TiXmlNode( TiXmlNode::TINYXML_DOCUMENT )
 {
+	storage = 0;
+	names = 0;
+	block = 0;
+	blockBytes = 0;
 	copy.CopyTo( this );
 }
 
 
+TiXmlDocument::~TiXmlDocument()
+{
+	// The nodes go first, while the block they may be packed in is still here.
+	DeleteNodes( firstChild );
+	firstChild = 0;
+	lastChild = 0;
+	delete [] block;
+	delete storage;
+	delete names;
+}
+
+
+void TiXmlDocument::SetReuseStorage( bool reuse )
+{
+	if ( reuse && !storage )
+	{
+		storage = new TiXmlStorage();
+	}
+	else if ( !reuse )
+	{
+		delete storage;
+		storage = 0;
+	}
+}
+
+
 TiXmlDocument& TiXmlDocument::operator=( const TiXmlDocument& copy )
 {
 	Clear();
@@ -967,9 +1157,14 @@ bool TiXmlDocument::LoadFile( const char* _filename, TiXmlEncoding encoding )
 	TIXML_STRING filename( _filename );
 	value = filename;
 
+	const unsigned long long start = observer ? TiXmlParseObserver::Now() : 0;
+
 	// reading in binary mode so that tinyxml can normalize the EOL
 	FILE* file = TiXmlFOpen( value.c_str (), "rb" );	
 
+	if ( observer )
+		ReportPhase( TiXmlParsePhase::PHASE_OPEN, start, TiXmlParseObserver::Now(), 0, 0 );
+
 	if ( file )
 	{
 		bool result = LoadFile( file, encoding );
@@ -983,29 +1178,78 @@ bool TiXmlDocument::LoadFile( const char* _filename, TiXmlEncoding encoding )
 	}
 }
 
-bool TiXmlDocument::LoadFile( FILE* file, TiXmlEncoding encoding )
+bool TiXmlDocument::LoadFile( const char* filename, const TiXmlParseOptions& options )
 {
-	if ( !file ) 
-	{
-		SetError( TIXML_ERROR_OPENING_FILE, 0, 0, TIXML_ENCODING_UNKNOWN );
-		return false;
-	}
+	parseOptions = options;
+	return LoadFile( filename, options.encoding );
+}
 
-	// Delete the existing data:
-	Clear();
-	location.Clear();
+// True if a file starting with 'head' is gzip, or a zlib stream: a deflate
+// header whose check bits are right. No XML document starts that way.
+static bool TiXmlCompressed( const unsigned char* head )
+{
+	if ( head[0] == 0x1f && head[1] == 0x8b )
+		return true;
+	return ( head[0] & 0x0f ) == 8 && ( head[0] >> 4 ) <= 7 && ( ( head[0] << 8 ) | head[1] ) % 31 == 0;
+}
 
+// Reads all of 'file' into a new[]'d, null terminated buffer with the line
+// endings normalized, decompressing it first if it is gzip or zlib. Returns null and sets errorId on failure, including
+// when the file is longer than maxBytes (if not 0). If asked, also returns
+// the size of the file and the time reading it finished, before the
+// normalizing. The normalizing is done by 'prepass', if given, so the caller
+// can keep what it found out about the text. Shared by
+// TiXmlDocument::LoadFile() and TiXmlReader::LoadFile().
+char* TiXmlReadFile( FILE* file, size_t maxBytes, long* _length, int* errorId, long* fileLength, unsigned long long* readEnd, TiXmlPrepass* prepass )
+{
 	// Get the file size, so we can pre-allocate the string. HUGE speed impact.
 	long length = 0;
 	fseek( file, 0, SEEK_END );
 	length = ftell( file );
 	fseek( file, 0, SEEK_SET );
+	if ( fileLength )
+		*fileLength = length;
 
 	// Strange case, but good to handle up front.
 	if ( length <= 0 )
 	{
-		SetError( TIXML_ERROR_DOCUMENT_EMPTY, 0, 0, TIXML_ENCODING_UNKNOWN );
-		return false;
+		*errorId = TiXmlBase::TIXML_ERROR_DOCUMENT_EMPTY;
+		return 0;
+	}
+
+	// A compressed file is inflated into the buffer, and limited by the
+	// size of its text rather than its own.
+	unsigned char head[2] = { 0, 0 };
+	const bool compressed = length >= 2 && fread( head, 2, 1, file ) == 1 && TiXmlCompressed( head );
+	fseek( file, 0, SEEK_SET );
+	if ( compressed )
+	{
+		#ifdef TIXML_USE_ZLIB
+			long inflated = 0;
+			char* buf = TiXmlInflateFile( file, length, maxBytes, &inflated, errorId );
+			if ( !buf )
+				return 0;
+			if ( readEnd )
+				*readEnd = TiXmlParseObserver::Now();
+
+			TiXmlPrepass local( false );
+			if ( !prepass )
+				prepass = &local;
+			const size_t kept = prepass->Run( buf, (size_t)inflated );
+			if ( _length )
+				*_length = (long)kept;
+			return buf;
+		#else
+			*errorId = TiXmlBase::TIXML_ERROR_DECOMPRESSING;
+			return 0;
+		#endif
+	}
+
+	// Refuse an oversized file before allocating anything for it.
+	if ( maxBytes && (unsigned long)length > maxBytes )
+	{
+		*errorId = TiXmlBase::TIXML_ERROR_DOCUMENT_TOO_LARGE;
+		return 0;
 	}
 
 	// Subtle bug here. TinyXml did use fgets. But from the XML spec:
@@ -1034,13 +1278,15 @@ bool TiXmlDocument::LoadFile( FILE* file, TiXmlEncoding encoding )
 
 	if ( fread( buf, length, 1, file ) != 1 ) {
 		delete [] buf;
-		SetError( TIXML_ERROR_OPENING_FILE, 0, 0, TIXML_ENCODING_UNKNOWN );
-		return false;
+		*errorId = TiXmlBase::TIXML_ERROR_OPENING_FILE;
+		return 0;
 	}
+	if ( readEnd )
+		*readEnd = TiXmlParseObserver::Now();
 
 	// Process the buffer in place to normalize new lines. (See comment above.)
-	// Copies from the 'p' to 'q' pointer, where p can advance faster if
-	// a newline-carriage return is hit.
+	// The prepass rewrites CR LF and lone CRs as LF, and stops at the first
+	// null, in the same sweep that checks the UTF-8 and indexes the lines.
 	//
 	// Wikipedia:
 	// Systems based on ASCII or a compatible character set use either LF  (Line feed, '\n', 0x0A, 10 in decimal) or 
@@ -1049,45 +1295,99 @@ bool TiXmlDocument::LoadFile( FILE* file, TiXmlEncoding encoding )
     //		* CR+LF: DEC RT-11 and most other early non-Unix, non-IBM OSes, CP/M, MP/M, DOS, OS/2, Microsoft Windows, Symbian OS
     //		* CR:    Commodore 8-bit machines, Apple II family, Mac OS up to version 9 and OS-9
 
-	const char* p = buf;	// the read head
-	char* q = buf;			// the write head
-	const char CR = 0x0d;
-	const char LF = 0x0a;
-
-	buf[length] = 0;
-	while( *p ) {
-		assert( p < (buf+length) );
-		assert( q <= (buf+length) );
-		assert( q <= p );
-
-		if ( *p == CR ) {
-			*q++ = LF;
-			p++;
-			if ( *p == LF ) {		// check for CR+LF (and skip LF)
-				p++;
-			}
+	TiXmlPrepass local( false );
+	if ( !prepass )
+		prepass = &local;
+	const size_t kept = prepass->Run( buf, (size_t)length );
+
+	if ( _length )
+		*_length = (long)kept;
+	return buf;
+}
+
+
+bool TiXmlDocument::LoadFile( FILE* file, TiXmlEncoding encoding )
+{
+	if ( !file ) 
+	{
+		SetError( TIXML_ERROR_OPENING_FILE, 0, 0, TIXML_ENCODING_UNKNOWN );
+		return false;
+	}
+
+	unsigned long long start = observer ? TiXmlParseObserver::Now() : 0;
+
+	// Delete the existing data:
+	Clear();
+	location.Clear();
+
+	if ( observer )
+		start = ReportPhase( TiXmlParsePhase::PHASE_CLEAR, start, TiXmlParseObserver::Now(), 0, 0 );
+
+	int errorId = TIXML_NO_ERROR;
+	long length = 0;
+	long fileLength = 0;
+	unsigned long long readEnd = 0;
+	TiXmlPrepass pass( parseOptions.tabSize > 0 );
+	char* buf = TiXmlReadFile( file, parseOptions.maxBytes, &length, &errorId, &fileLength, observer ? &readEnd : 0, &pass );
+	if ( observer )
+	{
+		const unsigned long long now = TiXmlParseObserver::Now();
+		if ( buf )
+		{
+			ReportPhase( TiXmlParsePhase::PHASE_READ, start, readEnd, (size_t)fileLength, 0 );
+			ReportPhase( TiXmlParsePhase::PHASE_NORMALIZE, readEnd, now, (size_t)length, 0 );
 		}
-		else {
-			*q++ = *p++;
+		else
+		{
+			ReportPhase( TiXmlParsePhase::PHASE_READ, start, now, 0, 0 );
 		}
 	}
-	assert( q <= (buf+length) );
-	*q = 0;
+	if ( !buf )
+	{
+		SetError( errorId, 0, 0, TIXML_ENCODING_UNKNOWN );
+		return false;
+	}
 
+	// The buffer and its line index are in use for the whole parse, so they
+	// count toward the peak.
+	inputBytes = (size_t)length + 1 + pass.IndexBytes();
+	prepass = &pass;
 	Parse( buf, 0, encoding );
+	prepass = 0;
+	inputBytes = 0;
 
+	start = observer ? TiXmlParseObserver::Now() : 0;
 	delete [] buf;
+	if ( observer )
+		ReportPhase( TiXmlParsePhase::PHASE_RELEASE, start, TiXmlParseObserver::Now(), (size_t)length + 1, 0 );
 	return !Error();
 }
 
 
 bool TiXmlDocument::SaveFile( const char * filename ) const
 {
+	int level = compression;
+	if ( level == COMPRESS_AUTO )
+	{
+		const size_t length = strlen( filename );
+		level = COMPRESS_NONE;
+		#ifdef TIXML_USE_ZLIB
+			if ( length >= 3 && strcmp( filename + length - 3, ".gz" ) == 0 )
+				level = COMPRESS_DEFAULT;
+		#else
+			(void)length;
+		#endif
+	}
+	#ifndef TIXML_USE_ZLIB
+		if ( level > 0 )
+			return false;
+	#endif
+
 	// The old c stuff lives on...
-	FILE* fp = TiXmlFOpen( filename, "w" );
+	FILE* fp = TiXmlFOpen( filename, level > 0 ? "wb" : "w" );
 	if ( fp )
 	{
-		bool result = SaveFile( fp );
+		bool result = Save( fp, level );
 		fclose( fp );
 		return result;
 	}
@@ -1097,6 +1397,21 @@ bool TiXmlDocument::SaveFile( const char * filename ) const
 
 bool TiXmlDocument::SaveFile( FILE* fp ) const
 {
+	return Save( fp, compression > 0 ? compression : 0 );
+}
+
+
+bool TiXmlDocument::Save( FILE* fp, int level ) const
+{
+	if ( level > 0 )
+	{
+		#ifdef TIXML_USE_ZLIB
+			return TiXmlDeflateDocument( *this, useMicrosoftBOM, fp, level );
+		#else
+			return false;
+		#endif
+	}
+
 	if ( useMicrosoftBOM ) 
 	{
 		const unsigned char TIXML_UTF_LEAD_0 = 0xefU;
@@ -1119,15 +1434,678 @@ void TiXmlDocument::CopyTo( TiXmlDocument* target ) const
 	target->error = error;
 	target->errorId = errorId;
 	target->errorDesc = errorDesc;
-	target->tabsize = tabsize;
+	target->parseOptions = parseOptions;
+	target->inputBytes = 0;
+	target->prepass = 0;
+	target->peakBytes = peakBytes;
+	target->observer = observer;
+	target->errorTime = 0;
 	target->errorLocation = errorLocation;
 	target->useMicrosoftBOM = useMicrosoftBOM;
+	target->compression = compression;
 
 	TiXmlNode* node = 0;
 	for ( node = firstChild; node; node = node->NextSibling() )
 	{
 		target->LinkEndChild( node->Clone() );
 	}	
+
+	// The copies have no resolved names; the ids are the target's own.
+	if ( names )
+		target->ResolveNamespaces();
+}
+
+
+// The heap a string has allocated for its characters, or 0 if they are kept
+// inside the string itself.
+static size_t TiXmlStringHeap( const TIXML_STRING& str )
+{
+#ifdef TIXML_USE_STL
+	const char* chars = str.data();
+	const char* self = reinterpret_cast< const char* >( &str );
+	if ( chars >= self && chars < self + sizeof( str ) )
+		return 0;
+	return str.capacity() + 1;
+#else
+	if ( str.capacity() == 0 )
+		return 0;
+	// TiXmlString::Rep: the size, the capacity, then the characters, in ints.
+	const size_t bytes = 2 * sizeof( size_t ) + str.capacity() + 1;
+	return ( bytes + sizeof( int ) - 1 ) / sizeof( int ) * sizeof( int );
+#endif
+}
+
+
+static void TiXmlAddString( const TIXML_STRING& str, size_t* total, TiXmlMemoryStats* stats )
+{
+	const size_t heap = TiXmlStringHeap( str );
+	if ( heap )
+		*total += heap + TIXML_ALLOCATION_OVERHEAD;
+	if ( stats )
+	{
+		stats->stringBytes += str.length();
+		if ( heap )
+			stats->overheadBytes += heap - str.length() + TIXML_ALLOCATION_OVERHEAD;
+	}
+}
+
+
+size_t TiXmlDocument::NodeBytes( const TiXmlNode* node, TiXmlMemoryStats* stats )
+{
+	size_t object = 0;
+	switch ( node->Type() )
+	{
+		case TINYXML_DOCUMENT:		object = sizeof( TiXmlDocument );		break;
+		case TINYXML_ELEMENT:		object = sizeof( TiXmlElement );		break;
+		case TINYXML_COMMENT:		object = sizeof( TiXmlComment );		break;
+		case TINYXML_UNKNOWN:		object = sizeof( TiXmlUnknown );		break;
+		case TINYXML_TEXT:			object = sizeof( TiXmlText );			break;
+		case TINYXML_DECLARATION:	object = sizeof( TiXmlDeclaration );	break;
+		default:					object = sizeof( TiXmlNode );			break;
+	}
+	// The document is usually not on the heap, and packed nodes share one
+	// allocation; everything else is on the heap by itself.
+	const bool allocated = node->Type() != TINYXML_DOCUMENT && !node->packed;
+	size_t total = object + ( allocated ? TIXML_ALLOCATION_OVERHEAD : 0 );
+	if ( stats )
+	{
+		++stats->nodes[ node->Type() ];
+		stats->objectBytes += object;
+		if ( allocated )
+			stats->overheadBytes += TIXML_ALLOCATION_OVERHEAD;
+	}
+
+	TiXmlAddString( node->ValueTStr(), &total, stats );
+
+	const TiXmlDocument* document = node->ToDocument();
+	if ( document && document->names )
+	{
+		const size_t bytes = document->names->Bytes();
+		total += bytes;
+		if ( stats )
+			stats->overheadBytes += bytes;
+	}
+	if ( document && document->block )
+	{
+		total += TIXML_ALLOCATION_OVERHEAD;
+		if ( stats )
+			stats->overheadBytes += TIXML_ALLOCATION_OVERHEAD;
+	}
+
+	if ( const TiXmlElement* element = node->ToElement() )
+	{
+		for ( const TiXmlAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next() )
+		{
+			const size_t overhead = attribute->packed ? 0 : TIXML_ALLOCATION_OVERHEAD;
+			total += sizeof( TiXmlAttribute ) + overhead;
+			if ( stats )
+			{
+				++stats->attributes;
+				stats->objectBytes += sizeof( TiXmlAttribute );
+				stats->overheadBytes += overhead;
+			}
+			TiXmlAddString( attribute->name, &total, stats );
+			TiXmlAddString( attribute->value, &total, stats );
+		}
+	}
+	else if ( const TiXmlDeclaration* declaration = node->ToDeclaration() )
+	{
+		TiXmlAddString( declaration->version, &total, stats );
+		TiXmlAddString( declaration->encoding, &total, stats );
+		TiXmlAddString( declaration->standalone, &total, stats );
+	}
+	return total;
+}
+
+
+unsigned long long TiXmlDocument::ReportPhase( TiXmlParsePhase::Phase phase, unsigned long long start, unsigned long long end, size_t bytes, size_t nodes ) const
+{
+	TiXmlParsePhase report;
+	report.phase = phase;
+	report.start = start;
+	report.end = end;
+	report.bytes = bytes;
+	report.nodes = nodes;
+	observer->OnPhase( *this, report );
+	return TiXmlParseObserver::Now();
+}
+
+
+TiXmlMemoryStats TiXmlDocument::MemoryStats() const
+{
+	TiXmlMemoryStats stats;
+
+	// Pre-order, following the links rather than recursing.
+	const TiXmlNode* node = this;
+	while ( node )
+	{
+		stats.totalBytes += NodeBytes( node, &stats );
+
+		if ( node->FirstChild() )
+		{
+			node = node->FirstChild();
+			continue;
+		}
+		while ( node != this && !node->NextSibling() )
+			node = node->Parent();
+		node = ( node == this ) ? 0 : node->NextSibling();
+	}
+	stats.peakBytes = peakBytes;
+	return stats;
+}
+
+
+// Compact() starts every object at a multiple of this, enough for any member.
+static const size_t TIXML_PACK_ALIGN = 16;
+
+static size_t TiXmlPackedSize( size_t bytes )
+{
+	return ( bytes + TIXML_PACK_ALIGN - 1 ) & ~( TIXML_PACK_ALIGN - 1 );
+}
+
+
+// Reallocate 'str' with no spare capacity.
+static void TiXmlFitString( TIXML_STRING* str )
+{
+	TIXML_STRING fitted( str->c_str(), str->length() );
+	str->swap( fitted );
+}
+
+
+TiXmlNode* TiXmlDocument::PackNode( TiXmlNode* node, char** at )
+{
+	TiXmlNode* copy = 0;
+	switch ( node->Type() )
+	{
+		case TINYXML_ELEMENT:
+		{
+			TiXmlElement* element = node->ToElement();
+			TiXmlElement* e = new( *at ) TiXmlElement( "" );
+			*at += TiXmlPackedSize( sizeof( TiXmlElement ) );
+			e->qname = element->qname;
+			for ( TiXmlAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next() )
+			{
+				TiXmlAttribute* a = new( *at ) TiXmlAttribute();
+				*at += TiXmlPackedSize( sizeof( TiXmlAttribute ) );
+				a->packed = true;
+				a->name.swap( attribute->name );
+				a->value.swap( attribute->value );
+				a->document = attribute->document;
+				a->location = attribute->location;
+				a->userData = attribute->userData;
+				a->qname = attribute->qname;
+				e->attributeSet.Add( a );
+			}
+			copy = e;
+			break;
+		}
+		case TINYXML_TEXT:
+		{
+			TiXmlText* text = new( *at ) TiXmlText( "" );
+			*at += TiXmlPackedSize( sizeof( TiXmlText ) );
+			text->SetCDATA( node->ToText()->CDATA() );
+			copy = text;
+			break;
+		}
+		case TINYXML_COMMENT:
+			copy = new( *at ) TiXmlComment();
+			*at += TiXmlPackedSize( sizeof( TiXmlComment ) );
+			break;
+		case TINYXML_UNKNOWN:
+			copy = new( *at ) TiXmlUnknown();
+			*at += TiXmlPackedSize( sizeof( TiXmlUnknown ) );
+			break;
+		case TINYXML_DECLARATION:
+		{
+			TiXmlDeclaration* declaration = node->ToDeclaration();
+			TiXmlDeclaration* d = new( *at ) TiXmlDeclaration();
+			*at += TiXmlPackedSize( sizeof( TiXmlDeclaration ) );
+			d->version.swap( declaration->version );
+			d->encoding.swap( declaration->encoding );
+			d->standalone.swap( declaration->standalone );
+			copy = d;
+			break;
+		}
+		default:
+			assert( 0 );	// a document is never a child
+			return 0;
+	}
+
+	copy->packed = true;
+	copy->value.swap( node->value );
+	copy->location = node->location;
+	copy->userData = node->userData;
+	copy->hash = node->hash;
+	return copy;
+}
+
+
+void TiXmlDocument::Compact()
+{
+	// Size the block: every node under the document, and every attribute.
+	size_t bytes = 0;
+	for ( const TiXmlNode* node = firstChild; node; )
+	{
+		switch ( node->Type() )
+		{
+			case TINYXML_ELEMENT:		bytes += TiXmlPackedSize( sizeof( TiXmlElement ) );		break;
+			case TINYXML_COMMENT:		bytes += TiXmlPackedSize( sizeof( TiXmlComment ) );		break;
+			case TINYXML_UNKNOWN:		bytes += TiXmlPackedSize( sizeof( TiXmlUnknown ) );		break;
+			case TINYXML_TEXT:			bytes += TiXmlPackedSize( sizeof( TiXmlText ) );		break;
+			case TINYXML_DECLARATION:	bytes += TiXmlPackedSize( sizeof( TiXmlDeclaration ) );	break;
+			default:					break;
+		}
+		if ( const TiXmlElement* element = node->ToElement() )
+		{
+			for ( const TiXmlAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next() )
+				bytes += TiXmlPackedSize( sizeof( TiXmlAttribute ) );
+		}
+
+		if ( node->firstChild )
+		{
+			node = node->firstChild;
+			continue;
+		}
+		while ( node->parent != this && !node->next )
+			node = node->parent;
+		node = node->next;
+	}
+
+	TiXmlNode* old = firstChild;
+	char* oldBlock = block;
+	firstChild = 0;
+	lastChild = 0;
+	block = bytes ? new char[ bytes ] : 0;
+	blockBytes = bytes;
+
+	// Move the old tree in document order, linking each copy in as the last
+	// child of the copy of its parent, without recursion. The strings are
+	// moved rather than copied, so they are only allocated again below.
+	char* at = block;
+	TiXmlNode* into = this;
+	for ( TiXmlNode* node = old; node; )
+	{
+		TiXmlNode* copy = PackNode( node, &at );
+		copy->parent = into;
+		copy->prev = into->lastChild;
+		if ( into->lastChild )
+			into->lastChild->next = copy;
+		else
+			into->firstChild = copy;
+		into->lastChild = copy;
+
+		if ( node->firstChild )
+		{
+			node = node->firstChild;
+			into = copy;
+			continue;
+		}
+		while ( node->parent != this && !node->next )
+		{
+			node = node->parent;
+			into = into->parent;
+		}
+		node = node->next;
+	}
+	assert( at == block + bytes );
+
+	// The old nodes, and then the block some of them may be in.
+	DeleteNodes( old );
+	delete [] oldBlock;
+
+	// Now fit the strings, in document order, to the memory just given back.
+	for ( TiXmlNode* node = firstChild; node; )
+	{
+		TiXmlFitString( &node->value );
+		if ( TiXmlElement* element = node->ToElement() )
+		{
+			for ( TiXmlAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next() )
+			{
+				TiXmlFitString( &attribute->name );
+				TiXmlFitString( &attribute->value );
+			}
+		}
+		else if ( TiXmlDeclaration* declaration = node->ToDeclaration() )
+		{
+			TiXmlFitString( &declaration->version );
+			TiXmlFitString( &declaration->encoding );
+			TiXmlFitString( &declaration->standalone );
+		}
+
+		if ( node->firstChild )
+		{
+			node = node->firstChild;
+			continue;
+		}
+		while ( node->parent != this && !node->next )
+			node = node->parent;
+		node = node->next;
+	}
+}
+
+
+TiXmlStorage::TiXmlStorage()
+{
+	memset( nodes, 0, sizeof( nodes ) );
+	memset( &attributes, 0, sizeof( attributes ) );
+}
+
+
+TiXmlStorage::~TiXmlStorage()
+{
+	for ( int i = 0; i < TiXmlNode::TINYXML_TYPECOUNT; ++i )
+		Trim( &nodes[i], 0 );
+	Trim( &attributes, 0 );
+}
+
+
+size_t TiXmlStorage::Nodes() const
+{
+	size_t count = 0;
+	for ( int i = 0; i < TiXmlNode::TINYXML_TYPECOUNT; ++i )
+		count += nodes[i].count;
+	return count;
+}
+
+
+TiXmlNode* TiXmlStorage::NewNode( TiXmlNode::NodeType type )
+{
+	++nodes[ type ].asked;
+	TiXmlNode* node = Pop( &nodes[ type ] );
+	if ( node )
+		return node;
+
+	switch ( type )
+	{
+		case TiXmlNode::TINYXML_ELEMENT:		return new TiXmlElement( "" );
+		case TiXmlNode::TINYXML_COMMENT:		return new TiXmlComment();
+		case TiXmlNode::TINYXML_UNKNOWN:		return new TiXmlUnknown();
+		case TiXmlNode::TINYXML_TEXT:			return new TiXmlText( "" );
+		case TiXmlNode::TINYXML_DECLARATION:	return new TiXmlDeclaration();
+		default:								return 0;
+	}
+}
+
+
+TiXmlAttribute* TiXmlStorage::NewAttribute()
+{
+	++attributes.asked;
+	TiXmlAttribute* attribute = Pop( &attributes );
+	return attribute ? attribute : new TiXmlAttribute();
+}
+
+
+void TiXmlStorage::Reclaim( TiXmlNode* node )
+{
+	// The same walk as DeleteNodes(), so the nodes are taken back in
+	// document order: the order a parse of a similar document asks for them.
+	while ( node )
+	{
+		if ( node->firstChild )
+		{
+			node->lastChild->next = node->next;
+			node->next = node->firstChild;
+			node->firstChild = 0;
+			node->lastChild = 0;
+		}
+
+		TiXmlNode* temp = node;
+		node = node->next;
+		if ( temp->packed )
+		{
+			// Its memory belongs to the document's block, which goes with it.
+			TiXmlNode::Destroy( temp );
+			continue;
+		}
+		Reset( temp );
+		Append( &nodes[ temp->Type() ], temp );
+		++nodes[ temp->Type() ].taken;
+	}
+
+	// What is left over from before is at the front of each list.
+	for ( int i = 0; i < TiXmlNode::TINYXML_TYPECOUNT; ++i )
+		Trim( &nodes[i], nodes[i].asked > nodes[i].taken ? nodes[i].asked : nodes[i].taken );
+	Trim( &attributes, attributes.asked > attributes.taken ? attributes.asked : attributes.taken );
+}
+
+
+void TiXmlStorage::Discard( TiXmlNode* node )
+{
+	assert( !node->firstChild );
+	Reset( node );
+	Prepend( &nodes[ node->Type() ], node );
+}
+
+
+void TiXmlStorage::Discard( TiXmlAttribute* attribute )
+{
+	Reset( attribute );
+	Prepend( &attributes, attribute );
+}
+
+
+void TiXmlStorage::Reset( TiXmlNode* node )
+{
+	// Forget all but the capacity of the strings.
+	node->value.clear();
+	node->userData = 0;
+	node->location.Clear();
+	node->hash = 0;
+	node->parent = 0;
+	node->prev = 0;
+	node->next = 0;
+
+	if ( TiXmlElement* element = node->ToElement() )
+	{
+		element->qname = TiXmlName();
+		while ( TiXmlAttribute* attribute = element->attributeSet.First() )
+		{
+			element->attributeSet.Remove( attribute );
+			Reset( attribute );
+			Append( &attributes, attribute );
+			++attributes.taken;
+		}
+	}
+	else if ( TiXmlText* text = node->ToText() )
+	{
+		text->cdata = false;
+	}
+	else if ( TiXmlDeclaration* declaration = node->ToDeclaration() )
+	{
+		declaration->version.clear();
+		declaration->encoding.clear();
+		declaration->standalone.clear();
+	}
+}
+
+
+void TiXmlStorage::Reset( TiXmlAttribute* attribute )
+{
+	attribute->name.clear();
+	attribute->value.clear();
+	attribute->userData = 0;
+	attribute->location.Clear();
+	attribute->document = 0;
+	attribute->owner = 0;
+	attribute->qname = TiXmlName();
+	attribute->prev = 0;
+	attribute->next = 0;
+}
+
+
+template< class T >
+T* TiXmlStorage::Pop( List< T >* list )
+{
+	T* item = list->first;
+	if ( item )
+	{
+		list->first = item->next;
+		if ( !list->first )
+			list->last = 0;
+		item->next = 0;
+		--list->count;
+	}
+	return item;
+}
+
+
+template< class T >
+void TiXmlStorage::Append( List< T >* list, T* item )
+{
+	if ( list->last )
+		list->last->next = item;
+	else
+		list->first = item;
+	list->last = item;
+	++list->count;
+}
+
+
+template< class T >
+void TiXmlStorage::Prepend( List< T >* list, T* item )
+{
+	item->next = list->first;
+	list->first = item;
+	if ( !list->last )
+		list->last = item;
+	++list->count;
+}
+
+
+template< class T >
+void TiXmlStorage::Trim( List< T >* list, size_t keep )
+{
+	while ( list->count > keep )
+		delete Pop( list );
+	list->asked = 0;
+	list->taken = 0;
+}
+
+
+// MurmurHash64A, by Austin Appleby (public domain). Also hashes the files
+// TiXmlDocumentCache keeps images of.
+unsigned long long TiXmlHashBytes( const unsigned char* data, size_t length )
+{
+	const unsigned long long m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+	unsigned long long h = 0x5bd1e9955bd1e995ULL ^ ( length * m );
+
+	const unsigned char* end = data + ( length & ~(size_t)7 );
+	for ( ; data != end; data += 8 )
+	{
+		unsigned long long k;
+		memcpy( &k, data, 8 );
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+
+	switch ( length & 7 )
+	{
+		case 7: h ^= (unsigned long long)data[6] << 48;	// fall through
+		case 6: h ^= (unsigned long long)data[5] << 40;	// fall through
+		case 5: h ^= (unsigned long long)data[4] << 32;	// fall through
+		case 4: h ^= (unsigned long long)data[3] << 24;	// fall through
+		case 3: h ^= (unsigned long long)data[2] << 16;	// fall through
+		case 2: h ^= (unsigned long long)data[1] << 8;	// fall through
+		case 1: h ^= (unsigned long long)data[0];
+				h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+	return h;
+}
+
+
+// Folds 'value' into the hash 'h', in the way MurmurHash64A folds in each
+// word, so the order values are folded in matters.
+static unsigned long long TiXmlHashFold( unsigned long long h, unsigned long long value )
+{
+	const unsigned long long m = 0xc6a4a7935bd1e995ULL;
+	value *= m;
+	value ^= value >> 47;
+	value *= m;
+	h ^= value;
+	h *= m;
+	return h;
+}
+
+
+static unsigned long long TiXmlHashString( const TIXML_STRING& str )
+{
+	return TiXmlHashBytes( reinterpret_cast< const unsigned char* >( str.c_str() ), str.length() );
+}
+
+
+static unsigned long long TiXmlHashString( const char* str )
+{
+	return TiXmlHashBytes( reinterpret_cast< const unsigned char* >( str ), strlen( str ) );
+}
+
+
+unsigned long long TiXmlNode::ContentHash() const
+{
+	unsigned long long h = TiXmlHashFold( 0x5bd1e9955bd1e995ULL, (unsigned long long)type + 1 );
+
+	if ( const TiXmlElement* element = ToElement() )
+	{
+		h = TiXmlHashFold( h, TiXmlHashString( value ) );
+		// Attributes are unordered: their hashes are added up.
+		unsigned long long attributes = 0;
+		for ( const TiXmlAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next() )
+			attributes += TiXmlHashFold( TiXmlHashString( attribute->Name() ), TiXmlHashString( attribute->Value() ) );
+		h = TiXmlHashFold( h, attributes );
+	}
+	else if ( const TiXmlDeclaration* declaration = ToDeclaration() )
+	{
+		h = TiXmlHashFold( h, TiXmlHashString( declaration->Version() ) );
+		h = TiXmlHashFold( h, TiXmlHashString( declaration->Encoding() ) );
+		h = TiXmlHashFold( h, TiXmlHashString( declaration->Standalone() ) );
+	}
+	else if ( type != TINYXML_DOCUMENT )
+	{
+		h = TiXmlHashFold( h, TiXmlHashString( value ) );
+		if ( const TiXmlText* text = ToText() )
+			h = TiXmlHashFold( h, text->CDATA() );
+	}
+
+	for ( const TiXmlNode* child = firstChild; child; child = child->next )
+		h = TiXmlHashFold( h, child->hash );
+
+	h ^= h >> 47;
+	h *= 0xc6a4a7935bd1e995ULL;
+	h ^= h >> 47;
+	// 0 means no hash is kept.
+	return h ? h : 1;
+}
+
+
+unsigned long long TiXmlNode::Hash() const
+{
+	// Post-order, following the links rather than recursing: go down to
+	// the first child without a kept hash, and hash each node once all of
+	// its children have one.
+	const TiXmlNode* node = this;
+	const TiXmlNode* child = firstChild;
+	while ( !hash )
+	{
+		while ( child && child->hash )
+			child = child->next;
+		if ( child )
+		{
+			node = child;
+			child = node->firstChild;
+			continue;
+		}
+		node->hash = node->ContentHash();
+		child = node->next;
+		node = node->parent;
+	}
+	return hash;
 }
 
 
@@ -1249,24 +2227,18 @@ int TiXmlAttribute::QueryDoubleValue( double* dval ) const
 
 void TiXmlAttribute::SetIntValue( int _value )
 {
-	char buf [64];
-	#if defined(TIXML_SNPRINTF)		
-		TIXML_SNPRINTF(buf, sizeof(buf), "%d", _value);
-	#else
-		sprintf (buf, "%d", _value);
-	#endif
-	SetValue (buf);
+	char buf [TIXML_NUMBER_BUFFER_SIZE];
+	int len = FormatInt( _value, buf );
+	value.assign( buf, len );
+	Changed();
 }
 
 void TiXmlAttribute::SetDoubleValue( double _value )
 {
-	char buf [256];
-	#if defined(TIXML_SNPRINTF)		
-		TIXML_SNPRINTF( buf, sizeof(buf), "%g", _value);
-	#else
-		sprintf (buf, "%g", _value);
-	#endif
-	SetValue (buf);
+	char buf [TIXML_NUMBER_BUFFER_SIZE];
+	int len = FormatDouble( _value, buf );
+	value.assign( buf, len );
+	Changed();
 }
 
 int TiXmlAttribute::IntValue() const
@@ -1499,6 +2471,7 @@ TiXmlNode* TiXmlUnknown::Clone() const
 
 TiXmlAttributeSet::TiXmlAttributeSet()
 {
+	owner = 0;
 	sentinel.next = &sentinel;
 	sentinel.prev = &sentinel;
 }
@@ -1519,6 +2492,7 @@ void TiXmlAttributeSet::Add( TiXmlAttribute* addMe )
 	assert( !Find( addMe->Name() ) );	// Shouldn't be multiply adding to the set.
 	#endif
 
+	addMe->owner = owner;
 	addMe->next = &sentinel;
 	addMe->prev = sentinel.prev;
 
@@ -1526,6 +2500,29 @@ void TiXmlAttributeSet::Add( TiXmlAttribute* addMe )
 	sentinel.prev      = addMe;
 }
 
+void TiXmlAttribute::Destroy( TiXmlAttribute* attribute )
+{
+	if ( attribute->packed )
+		attribute->~TiXmlAttribute();
+	else
+		delete attribute;
+}
+
+
+void TiXmlAttributeSet::Clear()
+{
+	TiXmlAttribute* node = sentinel.next;
+	while ( node != &sentinel )
+	{
+		TiXmlAttribute* temp = node;
+		node = node->next;
+		TiXmlAttribute::Destroy( temp );
+	}
+	sentinel.next = &sentinel;
+	sentinel.prev = &sentinel;
+}
+
+
 void TiXmlAttributeSet::Remove( TiXmlAttribute* removeMe )
 {
 	TiXmlAttribute* node;
@@ -1538,6 +2535,7 @@ void TiXmlAttributeSet::Remove( TiXmlAttribute* removeMe )
 			node->next->prev = node->prev;
 			node->next = 0;
 			node->prev = 0;
+			node->owner = 0;
 			return;
 		}
 	}
@@ -1580,6 +2578,19 @@ TiXmlAttribute* TiXmlAttributeSet::Find( const char* name ) const
 }
 
 
+TiXmlAttribute* TiXmlAttributeSet::Find( const TiXmlName& name ) const
+{
+	if ( !name.IsValid() )
+		return 0;
+	for( TiXmlAttribute* node = sentinel.next; node != &sentinel; node = node->next )
+	{
+		if ( node->qname == name )
+			return node;
+	}
+	return 0;
+}
+
+
 TiXmlAttribute* TiXmlAttributeSet::FindOrCreate( const char* _name )
 {
 	TiXmlAttribute* attrib = Find( _name );
@@ -1592,19 +2603,6 @@ TiXmlAttribute* TiXmlAttributeSet::FindOrCreate( const char* _name )
 }
 
 
-#ifdef TIXML_USE_STL	
-std::istream& operator>> (std::istream & in, TiXmlNode & base)
-{
-	TIXML_STRING tag;
-	tag.reserve( 8 * 1000 );
-	base.StreamIn( &in, &tag );
-
-	base.Parse( tag.c_str(), 0, TIXML_DEFAULT_ENCODING );
-	return in;
-}
-#endif
-
-
 #ifdef TIXML_USE_STL	
 std::ostream& operator<< (std::ostream & out, const TiXmlNode & base)
 {
@@ -1677,6 +2675,18 @@ TiXmlHandle TiXmlHandle::FirstChildElement( const char * value ) const
 }
 
 
+TiXmlHandle TiXmlHandle::FirstChildElement( const TiXmlName& name ) const
+{
+	if ( node )
+	{
+		TiXmlElement* child = node->FirstChildElement( name );
+		if ( child )
+			return TiXmlHandle( child );
+	}
+	return TiXmlHandle( 0 );
+}
+
+
 TiXmlHandle TiXmlHandle::Child( int count ) const
 {
 	if ( node )
@@ -1753,6 +2763,18 @@ TiXmlHandle TiXmlHandle::ChildElement( const char* value, int count ) const
 }
 
 
+bool TiXmlPrinter::Drain( bool all )
+{
+	if ( sink && !sinkFailed && !buffer.empty() && ( all || buffer.size() >= chunk ) )
+	{
+		if ( !sink->Write( buffer.c_str(), buffer.size() ) )
+			sinkFailed = true;
+		buffer.clear();
+	}
+	return !sinkFailed;
+}
+
+
 bool TiXmlPrinter::VisitEnter( const TiXmlDocument& )
 {
 	return true;
@@ -1760,7 +2782,7 @@ bool TiXmlPrinter::VisitEnter( const TiXmlDocument& )
 
 bool TiXmlPrinter::VisitExit( const TiXmlDocument& )
 {
-	return true;
+	return Drain( true );
 }
 
 bool TiXmlPrinter::VisitEnter( const TiXmlElement& element, const TiXmlAttribute* firstAttribute )
@@ -1796,7 +2818,7 @@ bool TiXmlPrinter::VisitEnter( const TiXmlElement& element, const TiXmlAttribute
 		}
 	}
 	++depth;	
-	return true;
+	return Drain( false );
 }
 
 
@@ -1822,7 +2844,7 @@ bool TiXmlPrinter::VisitExit( const TiXmlElement& element )
 		buffer += ">";
 		DoLineBreak();
 	}
-	return true;
+	return Drain( false );
 }
 
 
@@ -1850,7 +2872,7 @@ bool TiXmlPrinter::Visit( const TiXmlText& text )
 		buffer += str;
 		DoLineBreak();
 	}
-	return true;
+	return Drain( false );
 }
 
 
@@ -1859,7 +2881,7 @@ bool TiXmlPrinter::Visit( const TiXmlDeclaration& declaration )
 	DoIndent();
 	declaration.Print( 0, 0, &buffer );
 	DoLineBreak();
-	return true;
+	return Drain( false );
 }
 
 
@@ -1870,7 +2892,7 @@ bool TiXmlPrinter::Visit( const TiXmlComment& comment )
 	buffer += comment.Value();
 	buffer += "-->";
 	DoLineBreak();
-	return true;
+	return Drain( false );
 }
 
 
@@ -1881,6 +2903,6 @@ bool TiXmlPrinter::Visit( const TiXmlUnknown& unknown )
 	buffer += unknown.Value();
 	buffer += ">";
 	DoLineBreak();
-	return true;
+	return Drain( false );
 }
 
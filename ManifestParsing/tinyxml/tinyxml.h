@@ -88,11 +88,23 @@ class TiXmlAttribute;
 class TiXmlText;
 class TiXmlDeclaration;
 class TiXmlParsingData;
+class TiXmlPrepass;
+class TiXmlStorage;
+class TiXmlNameTable;
+class TiXmlReader;
+#ifdef TIXML_USE_STL
+class TiXmlStreamReader;
+#endif
 
 const int TIXML_MAJOR_VERSION = 2;
 const int TIXML_MINOR_VERSION = 6;
 const int TIXML_PATCH_VERSION = 2;
 
+/*	Size of a buffer big enough for any number written by
+	TiXmlBase::FormatInt() or TiXmlBase::FormatDouble(), null included.
+*/
+const int TIXML_NUMBER_BUFFER_SIZE = 32;
+
 /*	Internal structure for tracking location of items 
 	in the XML file.
 */
@@ -106,6 +118,41 @@ struct TiXmlCursor
 };
 
 
+/**	The namespace and local name of an element or attribute, as ids in the
+	names of one document; see TiXmlParseOptions::namespaces. Two names are
+	the same if both ids are, whatever prefixes they were written with, so
+	looking one up compares two integers rather than two strings.
+
+	@verbatim
+	const TiXmlName application = doc.ResolveName( 0, "application" );
+	const TiXmlName package = doc.ResolveName( "magicleap", "package" );
+
+	const TiXmlElement* root = doc.RootElement();
+	const char* name = root->Attribute( package );
+	const TiXmlElement* app = root->FirstChildElement( application );
+	@endverbatim
+
+	The ids belong to the document that resolved them, and stay the same for
+	as long as it lives, over any number of parses.
+*/
+struct TiXmlName
+{
+	TiXmlName() : ns( 0 ), local( 0 )							{}
+	TiXmlName( int _ns, int _local ) : ns( _ns ), local( _local )	{}
+
+	/** False for the name of a node that hasn't been resolved, and for a
+		name the document has never seen: neither matches anything.
+	*/
+	bool IsValid() const								{ return local > 0; }
+
+	bool operator==( const TiXmlName& rhs ) const		{ return ns == rhs.ns && local == rhs.local; }
+	bool operator!=( const TiXmlName& rhs ) const		{ return !( *this == rhs ); }
+
+	int ns;		///< The namespace URI, or 0 for none.
+	int local;	///< The local name, the part after any prefix.
+};
+
+
 /**
 	Implements the interface to the "Visitor pattern" (see the Accept() method.)
 	If you call the Accept() method, it requires being passed a TiXmlVisitor
@@ -169,6 +216,121 @@ enum TiXmlEncoding
 
 const TiXmlEncoding TIXML_DEFAULT_ENCODING = TIXML_ENCODING_UNKNOWN;
 
+
+/**	How a TiXmlDocument parses. The options belong to the document they are
+	given to, so documents on different threads can be parsed at the same
+	time with different options, and without locking, as long as none of
+	them leave the white space setting at WHITESPACE_DEFAULT.
+
+	@verbatim
+	TiXmlParseOptions options;
+	options.whiteSpace = TiXmlParseOptions::WHITESPACE_PRESERVE;
+	options.maxDepth = 64;
+	options.maxBytes = 1024 * 1024;
+	options.keep = TiXmlParseOptions::KEEP_NONE;
+
+	TiXmlDocument doc;
+	doc.LoadFile( "manifest.xml", options );
+	@endverbatim
+*/
+struct TiXmlParseOptions
+{
+	enum WhiteSpace
+	{
+		WHITESPACE_DEFAULT,		///< Follow TiXmlBase::IsWhiteSpaceCondensed() when the parse starts.
+		WHITESPACE_CONDENSE,	///< Trim text and condense runs of white space to a single space.
+		WHITESPACE_PRESERVE		///< Keep text exactly as written.
+	};
+
+	/** Flags for 'keep': the kinds of node, besides elements and text, that
+		are added to the DOM. Kinds that aren't kept are read past without
+		being allocated. (Text that is only white space is never kept.)
+	*/
+	enum
+	{
+		KEEP_NONE			= 0,
+		KEEP_COMMENTS		= 1 << 0,
+		KEEP_UNKNOWNS		= 1 << 1,	///< <!DOCTYPE>, processing instructions and other markup TinyXml doesn't model.
+		KEEP_DECLARATIONS	= 1 << 2,	///< <?xml ... ?>; its encoding is still used when it isn't kept.
+		KEEP_ALL			= KEEP_COMMENTS | KEEP_UNKNOWNS | KEEP_DECLARATIONS
+	};
+
+	TiXmlParseOptions() :	whiteSpace( WHITESPACE_DEFAULT ),
+							tabSize( 4 ),
+							encoding( TIXML_DEFAULT_ENCODING ),
+							maxDepth( 0 ),
+							maxBytes( 0 ),
+							keep( KEEP_ALL ),
+							paths( 0 ),
+							maxMemory( 0 ),
+							validateUtf8( false ),
+							hashNodes( false ),
+							namespaces( false ) {}
+
+	/// Whether text is condensed: 'whiteSpace', with WHITESPACE_DEFAULT looked up.
+	bool CondenseWhiteSpace() const;
+
+	WhiteSpace whiteSpace;
+	int tabSize;			///< For row and column tracking. 0 turns tracking off. See TiXmlDocument::SetTabSize().
+	TiXmlEncoding encoding;	///< Force an encoding, or TIXML_ENCODING_UNKNOWN to detect it.
+	int maxDepth;			///< The deepest elements may nest, or 0 for no limit. See TiXmlDocument::SetMaxDepth().
+	size_t maxBytes;		///< The largest document, in bytes once decompressed, that will be parsed, or 0 for no limit.
+	int keep;				///< KEEP_ flags.
+
+	/** Build only these elements: a null terminated list of slash separated
+		paths from the root element, such as "manifest/application" (a leading
+		'/' is allowed). The DOM then holds each element on one of the paths
+		with all of its content, and the elements leading to it with their
+		attributes but nothing else. Every other element is read past without
+		copying names, making attributes or decoding text. The list isn't
+		copied, so it must outlive the parse. Null, the default, builds the
+		whole document.
+
+		@verbatim
+		const char* const application[] = { "manifest/application", 0 };
+		options.paths = application;
+		@endverbatim
+	*/
+	const char* const* paths;
+
+	/** The most memory the document may take while it is parsed, as counted
+		by TiXmlDocument::MemoryStats() with LoadFile()'s input buffer, or 0
+		for no limit. Going over stops the parse with
+		TIXML_ERROR_MEMORY_BUDGET.
+	*/
+	size_t maxMemory;
+
+	/** Refuse a UTF-8 document that isn't valid UTF-8, with
+		TIXML_ERROR_INVALID_UTF8 at the first bad byte. Overlong forms,
+		surrogates and values past U+10FFFF are all invalid. Documents read
+		as TIXML_ENCODING_LEGACY aren't checked. LoadFile() checks as part
+		of the pass it already makes over the file; Parse() makes one more
+		pass over the text.
+	*/
+	bool validateUtf8;
+
+	/** Work out every node's TiXmlNode::Hash() as the document is parsed,
+		each element as its end tag is read, rather than on a separate walk
+		the first time one is asked for. Each element is hashed while its
+		nodes are still in cache, so this costs less than that later walk.
+	*/
+	bool hashNodes;
+
+	/** Resolve namespace prefixes as the document is parsed. Each element
+		and attribute gets a TiXmlName: the URI its prefix (or, for an
+		element, the default namespace) is bound to by the xmlns attributes
+		in scope, and its local name, both interned in the document. The
+		xml prefix is always bound, and xmlns attributes are in the
+		http://www.w3.org/2000/xmlns/ namespace. A prefix that isn't bound
+		stops the parse with TIXML_ERROR_UNDECLARED_PREFIX.
+
+		Names and values are kept as written, so Value(), Attribute() and
+		printing are the same either way. Nodes added or renamed after the
+		parse aren't resolved until TiXmlDocument::ResolveNamespaces().
+	*/
+	bool namespaces;
+};
+
 /** TiXmlBase is a base class for every class in TinyXml.
 	It does little except to establish that TinyXml classes
 	can be printed and provide some utility functions.
@@ -196,6 +358,8 @@ class TiXmlBase
 	friend class TiXmlNode;
 	friend class TiXmlElement;
 	friend class TiXmlDocument;
+	friend class TiXmlReader;
+	friend class TiXmlDocumentCache;
 
 public:
 	TiXmlBase()	:	userData(0)		{}
@@ -216,7 +380,8 @@ public:
 		not. In order to make everyone happy, these global, static functions
 		are provided to set whether or not TinyXml will condense all white space
 		into a single space or not. The default is to condense. Note changing this
-		value is not thread safe.
+		value is not thread safe; to parse with different settings at the same
+		time, give each document its own TiXmlParseOptions::whiteSpace instead.
 	*/
 	static void SetCondenseWhiteSpace( bool condense )		{ condenseWhiteSpace = condense; }
 
@@ -261,6 +426,18 @@ public:
 	*/
 	static void EncodeString( const TIXML_STRING& str, TIXML_STRING* out );
 
+	/** Writes an integer in decimal to 'buffer', which must hold at least
+		TIXML_NUMBER_BUFFER_SIZE chars. Returns the length, not counting the null.
+	*/
+	static int FormatInt( int value, char* buffer );
+
+	/** Writes a double to 'buffer' (at least TIXML_NUMBER_BUFFER_SIZE chars) using
+		the shortest digits that read back to exactly the same value. The output
+		does not depend on the locale: the decimal point is always '.'. Returns the
+		length, not counting the null.
+	*/
+	static int FormatDouble( double value, char* buffer );
+
 	enum
 	{
 		TIXML_NO_ERROR = 0,
@@ -279,6 +456,12 @@ public:
 		TIXML_ERROR_EMBEDDED_NULL,
 		TIXML_ERROR_PARSING_CDATA,
 		TIXML_ERROR_DOCUMENT_TOP_ONLY,
+		TIXML_ERROR_DEPTH_EXCEEDED,
+		TIXML_ERROR_DOCUMENT_TOO_LARGE,
+		TIXML_ERROR_MEMORY_BUDGET,
+		TIXML_ERROR_INVALID_UTF8,
+		TIXML_ERROR_DECOMPRESSING,
+		TIXML_ERROR_UNDECLARED_PREFIX,
 
 		TIXML_ERROR_STRING_COUNT
 	};
@@ -299,8 +482,8 @@ protected:
 	}
 
 	#ifdef TIXML_USE_STL
-	static bool	StreamWhiteSpace( std::istream * in, TIXML_STRING * tag );
-	static bool StreamTo( std::istream * in, int character, TIXML_STRING * tag );
+	static bool	StreamWhiteSpace( TiXmlStreamReader * in, TIXML_STRING * tag );
+	static bool StreamTo( TiXmlStreamReader * in, int character, TIXML_STRING * tag );
 	#endif
 
 	/*	Reads an XML name into the string provided. Returns
@@ -314,7 +497,7 @@ protected:
 	*/
 	static const char* ReadText(	const char* in,				// where to start
 									TIXML_STRING* text,			// the string read
-									bool ignoreWhiteSpace,		// whether to keep the white space
+									bool trimWhiteSpace,		// whether to trim and condense the white space
 									const char* endTag,			// what ends this text
 									bool ignoreCase,			// whether to ignore case in the end tag
 									TiXmlEncoding encoding );	// the current encoding
@@ -424,6 +607,7 @@ class TiXmlNode : public TiXmlBase
 {
 	friend class TiXmlDocument;
 	friend class TiXmlElement;
+	friend class TiXmlStorage;
 
 public:
 	#ifdef TIXML_USE_STL	
@@ -505,14 +689,17 @@ public:
 		Text:		the text string
 		@endverbatim
 	*/
-	void SetValue(const char * _value) { value = _value;}
+	void SetValue(const char * _value) { value = _value; ValueChanged(); }
 
     #ifdef TIXML_USE_STL
 	/// STL std::string form.
-	void SetValue( const std::string& _value )	{ value = _value; }
+	void SetValue( const std::string& _value )	{ value = _value; ValueChanged(); }
 	#endif
 
-	/// Delete all the children of this node. Does not affect 'this'.
+	/** Delete all the children of this node. Does not affect 'this'.
+		Deleting a node, or clearing it, doesn't recurse: documents of any
+		depth can be freed.
+	*/
 	void Clear();
 
 	/// One step up the DOM.
@@ -677,6 +864,17 @@ public:
 	TiXmlElement* FirstChildElement( const std::string& _value )				{	return FirstChildElement (_value.c_str ());	}	///< STL std::string form.
 	#endif
 
+	/// The first child element with the resolved name 'name'. See TiXmlName.
+	const TiXmlElement* FirstChildElement( const TiXmlName& name ) const;
+	TiXmlElement* FirstChildElement( const TiXmlName& name ) {
+		return const_cast< TiXmlElement* >( (const_cast< const TiXmlNode* >(this))->FirstChildElement( name ) );
+	}
+	/// The next sibling element with the resolved name 'name'. See TiXmlName.
+	const TiXmlElement* NextSiblingElement( const TiXmlName& name ) const;
+	TiXmlElement* NextSiblingElement( const TiXmlName& name ) {
+		return const_cast< TiXmlElement* >( (const_cast< const TiXmlNode* >(this))->NextSiblingElement( name ) );
+	}
+
 	/** Query the type (as an enumerated value, above) of this node.
 		The possible types are: TINYXML_DOCUMENT, TINYXML_ELEMENT, TINYXML_COMMENT,
 								TINYXML_UNKNOWN, TINYXML_TEXT, and TINYXML_DECLARATION.
@@ -737,23 +935,83 @@ public:
 	*/
 	virtual bool Accept( TiXmlVisitor* visitor ) const = 0;
 
+	/** A hash of the content of this node and everything under it: its type
+		and value, an element's attributes (in any order), a text's CDATA
+		flag, a declaration's fields, and the hashes of its children in
+		order. Subtrees that are the same hash the same wherever they are, so
+		comparing hashes tells whether they differ; see TiXmlDiff. The
+		document's own value, its file name, isn't part of it.
+
+		The hashes are worked out, without recursion, the first time they are
+		asked for (or while parsing, with TiXmlParseOptions::hashNodes) and
+		kept in the nodes. Changing a node through the DOM forgets the kept
+		hash of the node and its ancestors, so the next Hash() only redoes
+		the changed path, whether the change is made through the node or
+		through one of its attributes. Hashes are only good within one run of
+		the program, so don't store them.
+	*/
+	unsigned long long Hash() const;
+
+	/// Forget the kept hash of this node and its ancestors. See Hash().
+	void InvalidateHash()
+	{
+		// A node whose hash isn't kept has none kept above it either.
+		for ( TiXmlNode* node = this; node && node->hash; node = node->parent )
+			node->hash = 0;
+	}
+
 protected:
 	TiXmlNode( NodeType _type );
 
+	// After the value changes: forgets the hash and, of an element, the resolved name.
+	void ValueChanged();
+
 	// Copy to the allocated object. Shared functionality between Clone, Copy constructor,
 	// and the assignment operator.
 	void CopyTo( TiXmlNode* target ) const;
 
 	#ifdef TIXML_USE_STL
 	    // The real work of the input operator.
-	virtual void StreamIn( std::istream* in, TIXML_STRING* tag ) = 0;
+	virtual void StreamIn( TiXmlStreamReader* in, TIXML_STRING* tag ) = 0;
 	#endif
 
 	// Figure out what is at *p, and parse it. Returns null if it is not an xml node.
-	TiXmlNode* Identify( const char* start, TiXmlEncoding encoding );
+	// The node is taken from 'storage', if given, rather than allocated.
+	TiXmlNode* Identify( const char* start, TiXmlEncoding encoding, TiXmlStorage* storage = 0 );
+
+	// If the markup at 'p' is a comment or unknown that the KEEP_ flags leave
+	// out of the DOM, read past it without making a node and return where it
+	// ends. Otherwise return null, and it is parsed as usual.
+	static const char* SkipUnkept( const char* p, int keep, TiXmlEncoding encoding );
+
+	// How the element starting at 'p', a child of the element at 'path'
+	// (empty for the root), relates to the paths in TiXmlParseOptions::paths.
+	enum { SELECT_NONE, SELECT_ANCESTOR, SELECT_BRANCH };
+	static int SelectElement( const char* p, const char* const* paths, const TIXML_STRING& path, TiXmlEncoding encoding );
+
+	// Reads past the element at 'p' and everything in it, tracking only tags,
+	// quotes, comments and CDATA. Returns where it ends, or the end of the
+	// input if it doesn't.
+	static const char* SkipElement( const char* p, TiXmlEncoding encoding );
+
+	// In the content of an element at 'path' that only leads to the selected
+	// paths: reads past whatever at 'p' isn't on one and returns where it
+	// ends. Returns null if 'p' starts an element to build, and sets
+	// '*selection' to its SelectElement().
+	static const char* SkipUnselected( const char* p, const char* const* paths, const TIXML_STRING& path, int* selection, TiXmlEncoding encoding );
+
+	// Deletes 'node', its following siblings and everything under them in a
+	// single pass, without recursion: each node's children are spliced into
+	// the list ahead of its next sibling before it is deleted.
+	static void DeleteNodes( TiXmlNode* node );
+
+	// Deletes 'node', or only destroys it if it is packed, as its memory is
+	// part of its document's block.
+	static void Destroy( TiXmlNode* node );
 
 	TiXmlNode*		parent;
 	NodeType		type;
+	bool			packed;		// in the block of its document's last Compact()
 
 	TiXmlNode*		firstChild;
 	TiXmlNode*		lastChild;
@@ -762,8 +1020,12 @@ protected:
 
 	TiXmlNode*		prev;
 	TiXmlNode*		next;
+	mutable unsigned long long hash;	// see Hash(); 0 when it isn't kept
 
 private:
+	// This node's hash, from its own content and its children's kept hashes.
+	unsigned long long ContentHash() const;
+
 	TiXmlNode( const TiXmlNode& );				// not implemented.
 	void operator=( const TiXmlNode& base );	// not allowed.
 };
@@ -779,13 +1041,19 @@ private:
 class TiXmlAttribute : public TiXmlBase
 {
 	friend class TiXmlAttributeSet;
+	friend class TiXmlDocument;
+	friend class TiXmlElement;
+	friend class TiXmlStorage;
+	friend class TiXmlNamespaceScope;
 
 public:
 	/// Construct an empty attribute.
 	TiXmlAttribute() : TiXmlBase()
 	{
 		document = 0;
+		owner = 0;
 		prev = next = 0;
+		packed = false;
 	}
 
 	#ifdef TIXML_USE_STL
@@ -795,7 +1063,9 @@ public:
 		name = _name;
 		value = _value;
 		document = 0;
+		owner = 0;
 		prev = next = 0;
+		packed = false;
 	}
 	#endif
 
@@ -805,7 +1075,9 @@ public:
 		name = _name;
 		value = _value;
 		document = 0;
+		owner = 0;
 		prev = next = 0;
+		packed = false;
 	}
 
 	const char*		Name()  const		{ return name.c_str(); }		///< Return the name of this attribute.
@@ -819,6 +1091,9 @@ public:
 	// Get the tinyxml string representation
 	const TIXML_STRING& NameTStr() const { return name; }
 
+	/// The resolved name of this attribute. See TiXmlParseOptions::namespaces.
+	const TiXmlName& QName() const		{ return qname; }
+
 	/** QueryIntValue examines the value string. It is an alternative to the
 		IntValue() method with richer error checking.
 		If the value is an integer, it is stored in 'value' and 
@@ -832,17 +1107,17 @@ public:
 	/// QueryDoubleValue examines the value string. See QueryIntValue().
 	int QueryDoubleValue( double* _value ) const;
 
-	void SetName( const char* _name )	{ name = _name; }				///< Set the name of this attribute.
-	void SetValue( const char* _value )	{ value = _value; }				///< Set the value.
+	void SetName( const char* _name )	{ name = _name; qname = TiXmlName(); Changed(); }	///< Set the name of this attribute.
+	void SetValue( const char* _value )	{ value = _value; Changed(); }					///< Set the value.
 
 	void SetIntValue( int _value );										///< Set the value from an integer.
 	void SetDoubleValue( double _value );								///< Set the value from a double.
 
     #ifdef TIXML_USE_STL
 	/// STL std::string form.
-	void SetName( const std::string& _name )	{ name = _name; }	
+	void SetName( const std::string& _name )	{ name = _name; qname = TiXmlName(); Changed(); }
 	/// STL std::string form.	
-	void SetValue( const std::string& _value )	{ value = _value; }
+	void SetValue( const std::string& _value )	{ value = _value; Changed(); }
 	#endif
 
 	/// Get the next sibling attribute in the DOM. Returns null at end.
@@ -880,11 +1155,20 @@ private:
 	TiXmlAttribute( const TiXmlAttribute& );				// not implemented.
 	void operator=( const TiXmlAttribute& base );	// not allowed.
 
+	// Deletes 'attribute', or only destroys it if it is packed; see TiXmlNode::Destroy().
+	static void Destroy( TiXmlAttribute* attribute );
+
+	// Forget the kept hash of the element this is in, if it is in one.
+	void Changed()						{ if ( owner ) owner->InvalidateHash(); }
+
 	TiXmlDocument*	document;	// A pointer back to a document, for error reporting.
+	TiXmlNode*		owner;		// The element whose attribute set this is in, or null.
 	TIXML_STRING name;
 	TIXML_STRING value;
+	TiXmlName qname;
 	TiXmlAttribute*	prev;
 	TiXmlAttribute*	next;
+	bool packed;				// in the block of its document's last Compact()
 };
 
 
@@ -908,6 +1192,8 @@ public:
 
 	void Add( TiXmlAttribute* attribute );
 	void Remove( TiXmlAttribute* attribute );
+	/// Delete every attribute in the set.
+	void Clear();
 
 	const TiXmlAttribute* First()	const	{ return ( sentinel.next == &sentinel ) ? 0 : sentinel.next; }
 	TiXmlAttribute* First()					{ return ( sentinel.next == &sentinel ) ? 0 : sentinel.next; }
@@ -915,6 +1201,7 @@ public:
 	TiXmlAttribute* Last()					{ return ( sentinel.prev == &sentinel ) ? 0 : sentinel.prev; }
 
 	TiXmlAttribute*	Find( const char* _name ) const;
+	TiXmlAttribute*	Find( const TiXmlName& name ) const;
 	TiXmlAttribute* FindOrCreate( const char* _name );
 
 #	ifdef TIXML_USE_STL
@@ -922,6 +1209,8 @@ public:
 	TiXmlAttribute* FindOrCreate( const std::string& _name );
 #	endif
 
+	// The element the set belongs to; attributes added to it point back to it.
+	void SetOwner( TiXmlNode* _owner )		{ owner = _owner; }
 
 private:
 	//*ME:	Because of hidden/disabled copy-construktor in TiXmlAttribute (sentinel-element),
@@ -930,6 +1219,7 @@ private:
 	void operator=( const TiXmlAttributeSet& );	// not allowed (as TiXmlAttribute)
 
 	TiXmlAttribute sentinel;
+	TiXmlNode* owner;
 };
 
 
@@ -939,6 +1229,11 @@ private:
 */
 class TiXmlElement : public TiXmlNode
 {
+	friend class TiXmlNode;
+	friend class TiXmlDocument;
+	friend class TiXmlStorage;
+	friend class TiXmlNamespaceScope;
+
 public:
 	/// Construct an element.
 	TiXmlElement (const char * in_value);
@@ -1081,6 +1376,14 @@ public:
 	void RemoveAttribute( const std::string& name )	{	RemoveAttribute (name.c_str ());	}	///< STL std::string form.
 	#endif
 
+	/// The resolved name of this element. See TiXmlParseOptions::namespaces.
+	const TiXmlName& QName() const		{ return qname; }
+
+	/// The value of the attribute with the resolved name 'name', or null if there is none. See TiXmlName.
+	const char* Attribute( const TiXmlName& name ) const;
+	/// The attribute with the resolved name 'name', or null if there is none.
+	const TiXmlAttribute* FindAttribute( const TiXmlName& name ) const;
+
 	const TiXmlAttribute* FirstAttribute() const	{ return attributeSet.First(); }		///< Access the first attribute in this element.
 	TiXmlAttribute* FirstAttribute() 				{ return attributeSet.First(); }
 	const TiXmlAttribute* LastAttribute()	const 	{ return attributeSet.Last(); }		///< Access the last attribute in this element.
@@ -1144,16 +1447,23 @@ protected:
 
 	// Used to be public [internal use]
 	#ifdef TIXML_USE_STL
-	virtual void StreamIn( std::istream * in, TIXML_STRING * tag );
+	virtual void StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag );
 	#endif
 	/*	[internal use]
-		Reads the "value" of the element -- another element, or text.
-		This should terminate with the current end tag.
+		Reads the start tag and attributes of the element. Sets 'closed' if it
+		was an empty tag (<foo/>); otherwise the content follows the returned
+		pointer.
+	*/
+	const char* ReadStartTag( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding, TiXmlDocument* document, bool* closed );
+	/*	[internal use]
+		LinkEndChild() for the parser, which only links new nodes of the same
+		document, so it skips the checks that walk up to the document.
 	*/
-	const char* ReadValue( const char* in, TiXmlParsingData* prevData, TiXmlEncoding encoding );
+	void LinkParsedChild( TiXmlNode* node );
 
 private:
 	TiXmlAttributeSet attributeSet;
+	TiXmlName qname;
 };
 
 
@@ -1195,7 +1505,7 @@ protected:
 
 	// used to be public
 	#ifdef TIXML_USE_STL
-	virtual void StreamIn( std::istream * in, TIXML_STRING * tag );
+	virtual void StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag );
 	#endif
 //	virtual void StreamOut( TIXML_OSTREAM * out ) const;
 
@@ -1212,6 +1522,7 @@ private:
 class TiXmlText : public TiXmlNode
 {
 	friend class TiXmlElement;
+	friend class TiXmlStorage;
 public:
 	/** Constructor for text element. By default, it is treated as 
 		normal, encoded text. If you want it be output as a CDATA text
@@ -1242,7 +1553,7 @@ public:
 	/// Queries whether this represents text using a CDATA section.
 	bool CDATA() const				{ return cdata; }
 	/// Turns on or off a CDATA representation of text.
-	void SetCDATA( bool _cdata )	{ cdata = _cdata; }
+	void SetCDATA( bool _cdata )	{ cdata = _cdata; InvalidateHash(); }
 
 	virtual const char* Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding );
 
@@ -1261,7 +1572,7 @@ protected :
 	bool Blank() const;	// returns true if all white space and new lines
 	// [internal use]
 	#ifdef TIXML_USE_STL
-	virtual void StreamIn( std::istream * in, TIXML_STRING * tag );
+	virtual void StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag );
 	#endif
 
 private:
@@ -1284,6 +1595,9 @@ private:
 */
 class TiXmlDeclaration : public TiXmlNode
 {
+	friend class TiXmlDocument;
+	friend class TiXmlStorage;
+
 public:
 	/// Construct an empty declaration.
 	TiXmlDeclaration()   : TiXmlNode( TiXmlNode::TINYXML_DECLARATION ) {}
@@ -1333,7 +1647,7 @@ protected:
 	void CopyTo( TiXmlDeclaration* target ) const;
 	// used to be public
 	#ifdef TIXML_USE_STL
-	virtual void StreamIn( std::istream * in, TIXML_STRING * tag );
+	virtual void StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag );
 	#endif
 
 private:
@@ -1378,7 +1692,7 @@ protected:
 	void CopyTo( TiXmlUnknown* target ) const;
 
 	#ifdef TIXML_USE_STL
-	virtual void StreamIn( std::istream * in, TIXML_STRING * tag );
+	virtual void StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag );
 	#endif
 
 private:
@@ -1386,12 +1700,254 @@ private:
 };
 
 
+/** What a document takes in memory; see TiXmlDocument::MemoryStats(). The
+	byte counts are estimates: they follow how TinyXml lays out its objects
+	and strings, and assume TIXML_ALLOCATION_OVERHEAD bytes of bookkeeping
+	per heap allocation.
+*/
+struct TiXmlMemoryStats
+{
+	TiXmlMemoryStats()
+	{
+		for ( int i=0; i<TiXmlNode::TINYXML_TYPECOUNT; ++i )
+			nodes[i] = 0;
+		attributes = stringBytes = objectBytes = overheadBytes = totalBytes = peakBytes = 0;
+	}
+
+	size_t nodes[ TiXmlNode::TINYXML_TYPECOUNT ];	///< Nodes of each TiXmlNode::NodeType, the document included.
+	size_t attributes;		///< Attributes of every element.
+	size_t stringBytes;		///< Characters in names, values and text.
+	size_t objectBytes;		///< The node and attribute objects themselves.
+	size_t overheadBytes;	///< String headers and spare capacity, and the allocator's bookkeeping.
+	size_t totalBytes;		///< All of it. Short strings kept inside their objects count only once.
+	size_t peakBytes;		///< The most in use during the last load or parse, including LoadFile()'s input buffer.
+};
+
+/// Heap bookkeeping assumed per allocation by TiXmlMemoryStats.
+#ifndef TIXML_ALLOCATION_OVERHEAD
+#define TIXML_ALLOCATION_OVERHEAD	( 2 * sizeof( void* ) )
+#endif
+
+
+/** One phase of TiXmlDocument::LoadFile() or Parse(), as reported to a
+	TiXmlParseObserver. Times are in nanoseconds, from TiXmlParseObserver::Now().
+*/
+struct TiXmlParsePhase
+{
+	enum Phase
+	{
+		PHASE_OPEN,			///< Opening the file.
+		PHASE_CLEAR,		///< Deleting what the document held before.
+		PHASE_READ,			///< Reading the file into memory. 'bytes' is the size of the file.
+		PHASE_NORMALIZE,	///< Normalizing its line endings. 'bytes' is what is left.
+		PHASE_PARSE,		///< Reading the markup and building the tree, which happen together. 'bytes' is the input parsed (0 on error), 'nodes' the nodes built.
+		PHASE_ERROR,		///< From finding an error to the parse returning.
+		PHASE_RELEASE		///< Freeing the file's buffer.
+	};
+
+	Phase phase;
+	unsigned long long start;
+	unsigned long long end;
+	size_t bytes;
+	size_t nodes;
+
+	/// The phase's name, such as "parse".
+	const char* Name() const;
+};
+
+
+/** Receives the timing of each phase of a load or parse, once the phase is
+	over. See TiXmlDocument::SetParseObserver(). Only the phases that happen
+	are reported: Parse() on its own reports just PHASE_PARSE, and
+	PHASE_ERROR if it fails.
+*/
+class TiXmlParseObserver
+{
+public:
+	virtual ~TiXmlParseObserver() {}
+
+	virtual void OnPhase( const TiXmlDocument& document, const TiXmlParsePhase& phase ) = 0;
+
+	/** The phases of a TiXmlReader; see TiXmlReader::SetParseObserver().
+		LoadFile() reports its phases as a document's does. PHASE_PARSE runs
+		from the input being set to the end of the document, so it includes
+		whatever the caller did with the tokens, and has no nodes. An error
+		is reported as soon as it is found, with an empty PHASE_ERROR.
+		Ignored unless overridden.
+	*/
+	virtual void OnReaderPhase( const TiXmlReader& reader, const TiXmlParsePhase& phase )	{ (void)reader; (void)phase; }
+
+	/// The clock the phases are timed with: monotonic, in nanoseconds.
+	static unsigned long long Now();
+};
+
+
+/*	[internal use] The nodes and attributes a document keeps for its next
+	parse when it reuses its storage; see TiXmlDocument::SetReuseStorage().
+	Each kind has its own list, in the order the nodes were taken back, so
+	parsing a document like the last one gets each node back with strings
+	that already have room for what it held before.
+*/
+class TiXmlStorage
+{
+public:
+	TiXmlStorage();
+	~TiXmlStorage();
+
+	// An empty node of 'type', in no tree: kept, or else allocated.
+	TiXmlNode* NewNode( TiXmlNode::NodeType type );
+	TiXmlAttribute* NewAttribute();
+
+	// Take back 'node', the siblings after it and everything under them.
+	// Of each kind, no more is kept than this took back or the last parse
+	// asked for, whichever is more, so nodes that didn't come from here (a
+	// copy, say) don't pile up.
+	void Reclaim( TiXmlNode* node );
+	// Take back a node, with no children, or an attribute, that a parse made
+	// and had no use for. It is the next of its kind handed out.
+	void Discard( TiXmlNode* node );
+	void Discard( TiXmlAttribute* attribute );
+
+	// The nodes, and the attributes, kept.
+	size_t Nodes() const;
+	size_t Attributes() const	{ return attributes.count; }
+
+private:
+	TiXmlStorage( const TiXmlStorage& );		// not implemented.
+	void operator=( const TiXmlStorage& );		// not implemented.
+
+	template< class T >
+	struct List
+	{
+		T* first;		// linked through 'next'
+		T* last;
+		size_t count;
+		size_t asked;	// handed out since the last Reclaim()
+		size_t taken;	// taken back by this Reclaim()
+	};
+
+	void Reset( TiXmlNode* node );
+	void Reset( TiXmlAttribute* attribute );
+	template< class T > static T* Pop( List< T >* list );
+	template< class T > static void Append( List< T >* list, T* item );
+	template< class T > static void Prepend( List< T >* list, T* item );
+	template< class T > static void Trim( List< T >* list, size_t keep );
+
+	List< TiXmlNode > nodes[ TiXmlNode::TINYXML_TYPECOUNT ];
+	List< TiXmlAttribute > attributes;
+};
+
+
+/*	[internal use]
+	The names a document has resolved: namespace URIs, prefixes, local and
+	qualified names, each interned once and known by its index. Index 0 is
+	the empty string, which is the id of "no namespace".
+*/
+class TiXmlNameTable
+{
+public:
+	TiXmlNameTable();
+	~TiXmlNameTable();
+
+	// The id of the 'length' bytes at 's', adding them if they're new.
+	int Intern( const char* s, size_t length );
+	// The id of 's', or -1 if it has never been interned.
+	int Find( const char* s ) const;
+	// The string with id 'id', or null if there is none.
+	const char* String( int id ) const	{ return ( id >= 0 && id < count ) ? entries[id].string : 0; }
+
+	// The prefix and local name of the qualified name with id 'id', the
+	// prefix 0 if it has none. Worked out once per name.
+	void Split( int id, int* prefix, int* local );
+
+	// The heap the table takes.
+	size_t Bytes() const;
+
+private:
+	TiXmlNameTable( const TiXmlNameTable& );		// not implemented.
+	void operator=( const TiXmlNameTable& );		// not implemented.
+
+	struct Entry
+	{
+		char* string;
+		size_t length;
+		unsigned hash;
+		int prefix;		// -1 until Split() works it out
+		int local;
+	};
+
+	static unsigned HashOf( const char* s, size_t length );
+	void Grow();
+
+	Entry* entries;
+	int count;
+	int capacity;
+	int* slots;			// open addressing over 'entries', -1 for empty
+	int slotCount;		// a power of 2, at least twice 'count'
+};
+
+
+/*	[internal use]
+	The namespace bindings in scope while elements are opened and closed in
+	document order, by the parser or by TiXmlDocument::ResolveNamespaces().
+*/
+class TiXmlNamespaceScope
+{
+public:
+	TiXmlNamespaceScope( TiXmlNameTable* names );
+	~TiXmlNamespaceScope();
+
+	// Bind the xmlns attributes of 'element' and resolve its name and the
+	// names of its attributes. Returns false if a prefix isn't bound, leaving
+	// those names unresolved; the element is open either way.
+	bool Open( TiXmlElement* element );
+	// Drop the bindings of the innermost open element.
+	void Close();
+
+private:
+	TiXmlNamespaceScope( const TiXmlNamespaceScope& );		// not implemented.
+	void operator=( const TiXmlNamespaceScope& );			// not implemented.
+
+	void Bind( int prefix, int uri );
+	// The URI bound to 'prefix', or -1 if there is none.
+	int Lookup( int prefix ) const;
+	// The resolved name of 'qualified'; an unprefixed name is in 'unprefixed'.
+	bool Resolve( const TIXML_STRING& qualified, int unprefixed, TiXmlName* name );
+
+	TiXmlNameTable* names;
+	int xmlnsPrefix;
+	int xmlnsURI;
+	int* bindings;			// prefix and URI pairs, innermost last
+	int bindingCount;
+	int bindingCapacity;
+	int* marks;				// the binding count when each open element was opened
+	int depth;
+	int markCapacity;
+};
+
+
 /** Always the top level node. A document binds together all the
 	XML pieces. It can be saved, loaded, and printed to the screen.
 	The 'value' of a document node is the xml file name.
+
+	A document that isn't being changed can be read by any number of
+	threads at once. Every const member function of the document, its
+	nodes, attributes and handles only reads, with one exception: Hash()
+	keeps the hashes it works out in the nodes, so the first Hash() of a
+	node (including those TiXmlDiff asks for) writes to it. Once the whole
+	document has been hashed, by Hash() on the document or by parsing with
+	TiXmlParseOptions::hashNodes, that is a read too. So finish changing a
+	document, call Hash() on it, then share it; TiXmlPublishedDocument and
+	TiXmlFileWatcher do this for the documents they hand out. Each thread
+	needs its own TiXmlPrinter, visitor, TiXmlDiff or other working state,
+	and nothing may change the document while it is being read.
 */
 class TiXmlDocument : public TiXmlNode
 {
+	friend class TiXmlNode;
+	friend class TiXmlDocumentCache;
+	friend class TiXmlParsingData;
+
 public:
 	/// Create an empty document, that has no name.
 	TiXmlDocument();
@@ -1406,18 +1962,26 @@ public:
 	TiXmlDocument( const TiXmlDocument& copy );
 	TiXmlDocument& operator=( const TiXmlDocument& copy );
 
-	virtual ~TiXmlDocument() {}
+	virtual ~TiXmlDocument();
 
 	/** Load a file using the current document value.
 		Returns true if successful. Will delete any existing
 		document data before loading.
+
+		A file compressed with gzip, or a zlib (deflate) stream, is
+		recognized by its first bytes and, when TinyXML is built with
+		TIXML_USE_ZLIB, decompressed as it is read: the text is inflated a
+		chunk at a time straight into the buffer that is parsed. Without
+		zlib such a file fails with TIXML_ERROR_DECOMPRESSING.
 	*/
 	bool LoadFile( TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
 	/// Save a file using the current document value. Returns true if successful.
 	bool SaveFile() const;
 	/// Load a file using the given filename. Returns true if successful.
 	bool LoadFile( const char * filename, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
-	/// Save a file using the given filename. Returns true if successful.
+	/** Save a file using the given filename. Returns true if successful.
+		The file is compressed with gzip as SetCompression() says.
+	*/
 	bool SaveFile( const char * filename ) const;
 	/** Load a file using the given FILE*. Returns true if successful. Note that this method
 		doesn't stream - the entire object pointed at by the FILE*
@@ -1425,14 +1989,25 @@ public:
 		file location. Streaming may be added in the future.
 	*/
 	bool LoadFile( FILE*, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
-	/// Save a file using the given FILE*. Returns true if successful.
+	/** Save a file using the given FILE*. Returns true if successful.
+		The output is compressed only if SetCompression() gave a level.
+	*/
 	bool SaveFile( FILE* ) const;
 
+	/** Load a file with the given options, which replace the document's
+		ParseOptions(). Returns true if successful.
+	*/
+	bool LoadFile( const char * filename, const TiXmlParseOptions& options );
+
 	#ifdef TIXML_USE_STL
 	bool LoadFile( const std::string& filename, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING )			///< STL std::string version.
 	{
 		return LoadFile( filename.c_str(), encoding );
 	}
+	bool LoadFile( const std::string& filename, const TiXmlParseOptions& options )	///< STL std::string version.
+	{
+		return LoadFile( filename.c_str(), options );
+	}
 	bool SaveFile( const std::string& filename ) const		///< STL std::string version.
 	{
 		return SaveFile( filename.c_str() );
@@ -1442,9 +2017,28 @@ public:
 	/** Parse the given null terminated block of xml data. Passing in an encoding to this
 		method (either TIXML_ENCODING_LEGACY or TIXML_ENCODING_UTF8 will force TinyXml
 		to use that encoding, regardless of what TinyXml might otherwise try to detect.
+		The rest of the document's ParseOptions() apply.
 	*/
 	virtual const char* Parse( const char* p, TiXmlParsingData* data = 0, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
 
+	/// Parse with the given options, which replace the document's ParseOptions().
+	const char* Parse( const char* p, const TiXmlParseOptions& options );
+
+	/** Parse the one element that starts at 'p', after any white space, and
+		stop after its end tag, however much text follows; the element is
+		added to the document's top level nodes. Returns the position just
+		past the element, or null on error. For reading a record out of a
+		larger file (see TiXmlOffsetIndex): rows and columns are counted
+		from 'p', and the namespace prefixes in scope there aren't known.
+	*/
+	const char* ParseElement( const char* p, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+
+	/** The options the next load or parse of this document will use. Every
+		setting is held by the document; see TiXmlParseOptions.
+	*/
+	void SetParseOptions( const TiXmlParseOptions& options )	{ parseOptions = options; }
+	const TiXmlParseOptions& ParseOptions() const				{ return parseOptions; }
+
 	/** Get the root element -- the only top level element -- of the document.
 		In well formed XML, there should only be one. TinyXml is tolerant of
 		multiple elements at the document level.
@@ -1501,9 +2095,114 @@ public:
 
 		@sa Row, Column
 	*/
-	void SetTabSize( int _tabsize )		{ tabsize = _tabsize; }
+	void SetTabSize( int _tabsize )		{ parseOptions.tabSize = _tabsize; }
+
+	int TabSize() const	{ return parseOptions.tabSize; }
+
+	/** Limit how deeply elements may nest. Parsing a document that nests
+		deeper stops with TIXML_ERROR_DEPTH_EXCEEDED. Elements are parsed
+		without recursion, so the limit guards memory, not the stack. The
+		default of 0 means no limit.
+	*/
+	void SetMaxDepth( int _maxDepth )	{ parseOptions.maxDepth = _maxDepth; }
+	int MaxDepth() const				{ return parseOptions.maxDepth; }
+
+	/** Count the document's nodes, attributes and memory as it is now, with
+		the peak reached by the last load or parse. Walks the whole tree.
+	*/
+	TiXmlMemoryStats MemoryStats() const;
+
+	/** Report the timing of each phase of LoadFile() and Parse() to
+		'observer', or stop if it is null. The document does not own it.
+		With no observer the phases aren't timed at all.
+	*/
+	void SetParseObserver( TiXmlParseObserver* _observer )	{ observer = _observer; }
+	TiXmlParseObserver* ParseObserver() const				{ return observer; }
+
+	/** Keep the storage of the nodes Clear() removes, the Clear() that starts
+		LoadFile() included, for the next load or parse to build its nodes
+		in, instead of freeing it and allocating it all again. Nodes,
+		attributes and, with TIXML_USE_STL, the capacity of their strings are
+		reused, so parsing documents of much the same size and shape over and
+		over allocates next to nothing once the first has been through:
+
+		@verbatim
+		TiXmlDocument doc;
+		doc.SetReuseStorage( true );
+		for ( ;; )
+		{
+			doc.Clear();
+			doc.Parse( NextRequest() );
+			...
+		}
+		@endverbatim
+
+		What is kept is at most what the last Clear() took back. Only
+		Clear() on the document keeps anything; removing a node from the
+		tree frees it as usual. Turning reuse off frees what is kept.
+		See also TiXmlDocumentPool.
+	*/
+	void SetReuseStorage( bool reuse );
+	bool ReuseStorage() const				{ return storage != 0; }
+
+	/** Rebuild the tree in one block of memory, for a document that is kept
+		for a long time and read far more than it is changed. The nodes are
+		laid out in document order, each element followed by its attributes,
+		so a walk over the tree reads memory in sequence; and every name and
+		value is copied to a string of just its length, allocated in the same
+		order, so the spare capacity edits leave behind is given back.
+
+		Every node and attribute is replaced: pointers to them, and handles
+		holding them, no longer work, but handles and lookups made from the
+		document afterwards find the same content as before. Hashes, user
+		data, locations and resolved names are kept.
+
+		The document can still be changed. A node added afterwards is
+		allocated as usual, and a packed node that is removed is destroyed
+		in place, its memory staying part of the block until the next
+		Compact(), Clear() or the document's destruction.
+	*/
+	void Compact();
+	/// The size of the block the last Compact() built, or 0.
+	size_t CompactBytes() const				{ return blockBytes; }
 
-	int TabSize() const	{ return tabsize; }
+	/** The TiXmlName for a namespace URI (null or "" for no namespace) and
+		a local name, to look elements and attributes up with. A name this
+		document has never resolved comes back invalid, and matches nothing.
+		See TiXmlParseOptions::namespaces.
+	*/
+	TiXmlName ResolveName( const char* namespaceURI, const char* localName ) const;
+	/// The URI or local name an id of a TiXmlName stands for, or null.
+	const char* NameString( int id ) const;
+
+	/** Resolve the name of every element and attribute, as a parse with
+		TiXmlParseOptions::namespaces does, for a document built or changed
+		through the DOM. Returns false if a prefix isn't bound; the names
+		using it are left unresolved.
+	*/
+	bool ResolveNamespaces();
+
+	enum
+	{
+		COMPRESS_AUTO = -1,		///< gzip if the file name ends in ".gz"
+		COMPRESS_NONE = 0,
+		COMPRESS_FASTEST = 1,
+		COMPRESS_DEFAULT = 6,
+		COMPRESS_BEST = 9
+	};
+
+	/** How SaveFile() compresses: COMPRESS_NONE writes plain text, and a
+		level from COMPRESS_FASTEST to COMPRESS_BEST writes gzip at that zlib
+		level. The default, COMPRESS_AUTO, uses COMPRESS_DEFAULT for a file
+		name ending in ".gz" and plain text otherwise. The text is compressed
+		as it is printed, through a TiXmlPrintSink, so the whole document is
+		never held in memory. It is printed by a TiXmlPrinter, which differs
+		from Print() only in laying out CDATA sections mixed with other text.
+		Compressing needs TIXML_USE_ZLIB; without it a level makes SaveFile()
+		fail, and COMPRESS_AUTO writes plain text.
+	*/
+	void SetCompression( int level )	{ compression = level < COMPRESS_AUTO ? COMPRESS_AUTO : level > COMPRESS_BEST ? COMPRESS_BEST : level; }
+	int Compression() const				{ return compression; }
 
 	/** If you have handled the error, it can be reset with this call. The error
 		state is automatically cleared if you Parse a new XML block.
@@ -1540,18 +2239,45 @@ protected :
 	// [internal use]
 	virtual TiXmlNode* Clone() const;
 	#ifdef TIXML_USE_STL
-	virtual void StreamIn( std::istream * in, TIXML_STRING * tag );
+	virtual void StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag );
 	#endif
 
 private:
 	void CopyTo( TiXmlDocument* target ) const;
 
+	// The bytes 'node' takes, not counting its children; adds the detail to
+	// 'stats' if it isn't null.
+	static size_t NodeBytes( const TiXmlNode* node, TiXmlMemoryStats* stats );
+
+	// Copy 'node', without its children, into the block at '*at', moving
+	// its strings, and move '*at' past it and its attributes.
+	static TiXmlNode* PackNode( TiXmlNode* node, char** at );
+
+	const char* ParseContent( const char* p, TiXmlParsingData* prevData, TiXmlEncoding encoding, size_t* nodes );
+
+	// Write the document to 'fp', as gzip at 'level' if it is above 0.
+	bool Save( FILE* fp, int level ) const;
+
+	// Pass a phase to the observer. Returns the time the next phase starts,
+	// so the observer's own time isn't counted.
+	unsigned long long ReportPhase( TiXmlParsePhase::Phase phase, unsigned long long start, unsigned long long end, size_t bytes, size_t nodes ) const;
+
 	bool error;
 	int  errorId;
 	TIXML_STRING errorDesc;
-	int tabsize;
+	TiXmlParseOptions parseOptions;
+	size_t inputBytes;			// the buffer LoadFile() is parsing, counted toward the peak and the budget
+	size_t peakBytes;
+	const TiXmlPrepass* prepass;	// what LoadFile()'s pass over the buffer it is parsing found, if anything
+	TiXmlParseObserver* observer;
+	unsigned long long errorTime;	// when the error was set, if there is an observer
 	TiXmlCursor errorLocation;
 	bool useMicrosoftBOM;		// the UTF-8 BOM were found when read. Note this, and try to write.
+	int compression;
+	TiXmlStorage* storage;		// what Clear() keeps for reuse, if it does
+	TiXmlNameTable* names;		// the names resolved, once there are any
+	char* block;				// the nodes and attributes of the last Compact()
+	size_t blockBytes;
 };
 
 
@@ -1652,6 +2378,8 @@ public:
 	TiXmlHandle FirstChildElement() const;
 	/// Return a handle to the first child element with the given name.
 	TiXmlHandle FirstChildElement( const char * value ) const;
+	/// Return a handle to the first child element with the given resolved name.
+	TiXmlHandle FirstChildElement( const TiXmlName& name ) const;
 
 	/** Return a handle to the "index" child with the given name. 
 		The first child is 0, the second 1, etc.
@@ -1715,10 +2443,23 @@ private:
 };
 
 
+/** Where a TiXmlPrinter streams its output; see TiXmlPrinter::SetSink().
+	Write() returns false to stop the printing.
+*/
+class TiXmlPrintSink
+{
+public:
+	virtual ~TiXmlPrintSink() {}
+
+	virtual bool Write( const char* data, size_t length ) = 0;
+};
+
+
 /** Print to memory functionality. The TiXmlPrinter is useful when you need to:
 
 	-# Print to memory (especially in non-STL mode)
 	-# Control formatting (line endings, etc.)
+	-# Stream the output a piece at a time (SetSink())
 
 	When constructed, the TiXmlPrinter is in its default "pretty printing" mode.
 	Before calling Accept() you can call methods to control the printing
@@ -1738,7 +2479,8 @@ class TiXmlPrinter : public TiXmlVisitor
 {
 public:
 	TiXmlPrinter() : depth( 0 ), simpleTextPrint( false ),
-					 buffer(), indent( "    " ), lineBreak( "\n" ) {}
+					 buffer(), indent( "    " ), lineBreak( "\n" ),
+					 sink( 0 ), chunk( 0 ), sinkFailed( false ) {}
 
 	virtual bool VisitEnter( const TiXmlDocument& doc );
 	virtual bool VisitExit( const TiXmlDocument& doc );
@@ -1771,6 +2513,14 @@ public:
 	void SetStreamPrinting()						{ indent = "";
 													  lineBreak = "";
 													}	
+	/** Hand the output to 'sink' whenever at least 'chunk' bytes of it are
+		waiting, and the rest when the document is done, instead of keeping
+		it all. CStr(), Str() and Size() then hold only what hasn't been
+		written yet. If the sink fails, Accept() stops and returns false.
+		The printer does not own the sink.
+	*/
+	void SetSink( TiXmlPrintSink* _sink, size_t _chunk = 16384 )	{ sink = _sink; chunk = _chunk; sinkFailed = false; }
+
 	/// Return the result.
 	const char* CStr()								{ return buffer.c_str(); }
 	/// Return the length of the result string.
@@ -1789,12 +2539,18 @@ private:
 	void DoLineBreak() {
 		buffer += lineBreak;
 	}
+	// Pass the output to the sink, if there is one and enough is waiting
+	// (or any, with 'all'). False once the sink has failed.
+	bool Drain( bool all );
 
 	int depth;
 	bool simpleTextPrint;
 	TIXML_STRING buffer;
 	TIXML_STRING indent;
 	TIXML_STRING lineBreak;
+	TiXmlPrintSink* sink;
+	size_t chunk;
+	bool sinkFailed;
 };
 
 
@@ -0,0 +1,258 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#ifdef TIXML_USE_STL
+
+#include "tinyxmlbind.h"
+#include "tinyxmlreader.h"
+
+
+static bool TiXmlBindEqualNoCase( const char* a, const char* b )
+{
+	while ( *a && tolower( (unsigned char)*a ) == tolower( (unsigned char)*b ) )
+	{
+		++a;
+		++b;
+	}
+	return *a == *b;
+}
+
+
+bool TiXmlBindConverter< bool >::Convert( const char* value, bool* out )
+{
+	static const char* const trueValues[] = { "true", "yes", "1" };
+	static const char* const falseValues[] = { "false", "no", "0" };
+
+	for ( int i=0; i<3; ++i )
+	{
+		if ( TiXmlBindEqualNoCase( value, trueValues[i] ) )
+		{
+			*out = true;
+			return true;
+		}
+		if ( TiXmlBindEqualNoCase( value, falseValues[i] ) )
+		{
+			*out = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+static void TiXmlBindReport( std::string* error, const std::string& message )
+{
+	if ( !error )
+		return;
+	if ( !error->empty() )
+		*error += "; ";
+	*error += message;
+}
+
+
+static std::string TiXmlBindFieldName( const TiXmlBindField& field )
+{
+	std::string result = field.path;
+	if ( field.attribute )
+	{
+		result += "@";
+		result += field.attribute;
+	}
+	return result;
+}
+
+
+static std::string TiXmlBindLocation( const TiXmlReader& reader )
+{
+	TiXmlCursor at = reader.Locate( reader.TokenStart() );
+	char location[ 64 ];
+	TIXML_SNPRINTF( location, sizeof( location ), " (row %d, col %d)", at.row + 1, at.col + 1 );
+	return location;
+}
+
+
+static bool TiXmlBindAssignField( const TiXmlBindField& field, void* object, const char* value, const TiXmlReader& reader, std::string* error )
+{
+	if ( field.assign( object, value ) )
+		return true;
+
+	TiXmlBindReport( error, "bad value '" + std::string( value ) + "' for " + TiXmlBindFieldName( field ) + TiXmlBindLocation( reader ) );
+	return false;
+}
+
+
+bool TiXmlBindRead( TiXmlReader* reader, TiXmlValidationPass* validation, void* object, const TiXmlBindField* fields, int count, std::string* error )
+{
+	if ( error )
+		error->clear();
+
+	bool ok = true;
+	std::vector< char > seen( count, 0 );
+
+	// The path of the open element, and where each step of it starts.
+	std::string path;
+	std::vector< size_t > steps;
+
+	// Text fields of the open elements being collected, with their depth.
+	std::vector< int > textFields;
+	std::vector< int > textDepths;
+	std::vector< std::string > textValues;
+
+	for( ;; )
+	{
+		TiXmlReader::Token token = reader->Next();
+		if ( validation )
+			validation->Next( reader, token );
+
+		if ( token == TiXmlReader::TOKEN_END_DOCUMENT )
+			break;
+
+		if ( token == TiXmlReader::TOKEN_ERROR )
+		{
+			char buf[ 128 ];
+			TIXML_SNPRINTF( buf, sizeof( buf ), "%s (row %d, col %d)", reader->ErrorDesc(), reader->ErrorRow(), reader->ErrorCol() );
+			TiXmlBindReport( error, buf );
+			return false;
+		}
+
+		if ( token == TiXmlReader::TOKEN_START_ELEMENT )
+		{
+			steps.push_back( path.size() );
+			if ( !path.empty() )
+				path += '/';
+			path += reader->Name();
+
+			for ( int i=0; i<count; ++i )
+			{
+				if ( path != fields[i].path )
+					continue;
+
+				if ( fields[i].attribute )
+				{
+					const char* value = reader->Attribute( fields[i].attribute );
+					if ( value )
+					{
+						seen[i] = 1;
+						ok = TiXmlBindAssignField( fields[i], object, value, *reader, error ) && ok;
+					}
+					else if ( fields[i].required && fields[i].repeated )
+					{
+						// A gap would put the rest of this vector out of step
+						// with the others bound from the same elements.
+						TiXmlBindReport( error, "missing required " + TiXmlBindFieldName( fields[i] ) + TiXmlBindLocation( *reader ) );
+						ok = false;
+					}
+				}
+				else
+				{
+					textFields.push_back( i );
+					textDepths.push_back( reader->Depth() );
+					textValues.push_back( std::string() );
+				}
+			}
+		}
+		else if ( token == TiXmlReader::TOKEN_TEXT )
+		{
+			for ( size_t j=0; j<textFields.size(); ++j )
+			{
+				if ( textDepths[j] == reader->Depth() )
+					textValues[j].append( reader->Text(), reader->TextLength() );
+			}
+		}
+		else if ( token == TiXmlReader::TOKEN_END_ELEMENT )
+		{
+			// Close out the text fields of the element that just ended.
+			while ( !textDepths.empty() && textDepths.back() > reader->Depth() )
+			{
+				const int i = textFields.back();
+				seen[i] = 1;
+				ok = TiXmlBindAssignField( fields[i], object, textValues.back().c_str(), *reader, error ) && ok;
+				textFields.pop_back();
+				textDepths.pop_back();
+				textValues.pop_back();
+			}
+
+			assert( !steps.empty() );
+			path.resize( steps.back() );
+			steps.pop_back();
+		}
+	}
+
+	for ( int i=0; i<count; ++i )
+	{
+		if ( fields[i].required && !fields[i].repeated && !seen[i] )
+		{
+			TiXmlBindReport( error, "missing required " + TiXmlBindFieldName( fields[i] ) );
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+
+// Binds what 'reader' holds, validating it in the same pass if there is a validator.
+static bool TiXmlBindReadValidated(	TiXmlReader* reader, const TiXmlValidator* validator, std::vector< TiXmlValidationError >* validationErrors,
+									void* object, const TiXmlBindField* fields, int count, std::string* error )
+{
+	if ( !validator )
+		return TiXmlBindRead( reader, 0, object, fields, count, error );
+
+	TiXmlValidationPass validation( *validator, validationErrors );
+	const bool bound = TiXmlBindRead( reader, &validation, object, fields, count, error );
+	const bool valid = validation.Finish( *reader );
+	return bound && valid;
+}
+
+
+bool TiXmlBindReadBuffer(	const char* xml, const TiXmlParseOptions& options, TiXmlParseObserver* observer,
+							const TiXmlValidator* validator, std::vector< TiXmlValidationError >* validationErrors,
+							void* object, const TiXmlBindField* fields, int count, std::string* error )
+{
+	TiXmlReader reader;
+	reader.SetParseOptions( options );
+	reader.SetParseObserver( observer );
+	reader.Reset( xml, options.encoding );
+	return TiXmlBindReadValidated( &reader, validator, validationErrors, object, fields, count, error );
+}
+
+
+bool TiXmlBindReadFile(	const char* filename, const TiXmlParseOptions& options, TiXmlParseObserver* observer,
+						const TiXmlValidator* validator, std::vector< TiXmlValidationError >* validationErrors,
+						void* object, const TiXmlBindField* fields, int count, std::string* error )
+{
+	TiXmlReader reader;
+	reader.SetParseOptions( options );
+	reader.SetParseObserver( observer );
+	if ( !reader.LoadFile( filename, options.encoding ) )
+	{
+		if ( error )
+			*error = std::string( reader.ErrorDesc() ) + ": " + filename;
+		if ( validationErrors )
+			validationErrors->clear();
+		return false;
+	}
+	return TiXmlBindReadValidated( &reader, validator, validationErrors, object, fields, count, error );
+}
+
+#endif
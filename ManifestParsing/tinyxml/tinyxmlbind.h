@@ -0,0 +1,341 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+#ifndef TINYXML_BIND_INCLUDED
+#define TINYXML_BIND_INCLUDED
+
+#include "tinyxml.h"
+#include "tinyxmlvalidate.h"
+
+#ifndef TIXML_USE_STL
+#error "tinyxmlbind.h requires TIXML_USE_STL"
+#endif
+
+#include <string>
+#include <vector>
+#include <errno.h>
+
+/**	Binding XML straight into a C++ struct, without building a DOM.
+
+	A bound struct declares a constexpr field map named bindFields. Each entry
+	ties a member to an element path (slash separated, starting at the root
+	element) and either an attribute of that element or its text:
+
+	@verbatim
+	struct Version
+	{
+		std::string name;
+		int code;
+		std::vector< std::string > notes;
+
+		static constexpr TiXmlBindField bindFields[] =
+		{
+			TIXML_BIND_ATTRIBUTE( Version, name,  "version", "name", true ),
+			TIXML_BIND_ATTRIBUTE( Version, code,  "version", "code", true ),
+			TIXML_BIND_TEXT(      Version, notes, "version/note",    false ),
+		};
+	};
+	constexpr TiXmlBindField Version::bindFields[];	// in one .cpp file
+
+	Version v;
+	std::string error;
+	if ( !TiXmlBindLoadFile( "version.xml", &v, &error ) )
+		printf( "%s\n", error.c_str() );
+	@endverbatim
+
+	The member types are checked when the map is compiled: a member with no
+	TiXmlBindConverter is a compile error, as is a malformed or duplicated
+	path. std::vector members collect every occurrence; other members take the
+	last one. A required std::vector attribute must be on every element at its
+	path, so vectors bound from the same elements stay in step; any other
+	required field must appear at least once. Missing required values are
+	reported, together with any values that failed to convert, after the
+	single streaming pass.
+
+	A TiXmlValidator can be given as well, to check the document in the same
+	pass rather than reading it a second time; see TiXmlValidationPass.
+*/
+struct TiXmlBindField
+{
+	constexpr TiXmlBindField(	const char* _path,
+								const char* _attribute,
+								bool _required,
+								bool _repeated,
+								bool (*_assign)( void* object, const char* value ) )
+		: path( _path ), attribute( _attribute ), required( _required ), repeated( _repeated ), assign( _assign ) {}
+
+	const char* path;		///< Element path from the root, e.g. "manifest/application".
+	const char* attribute;	///< Attribute name, or null to bind the element's text.
+	bool required;			///< Report an error if the value never appears, or for a repeated attribute, if any element at 'path' lacks it.
+	bool repeated;			///< The member collects every occurrence.
+	bool (*assign)( void* object, const char* value );	///< Generated converter.
+};
+
+
+/**	Converts attribute or text values to a member type. Specialize this to
+	bind additional types; each specialization provides 'repeated' and a
+	Convert() that returns false when the text isn't a valid value.
+*/
+template< typename M >
+struct TiXmlBindConverter
+{
+	static_assert( sizeof( M ) == 0, "TiXmlBind: there is no TiXmlBindConverter for this member type" );
+};
+
+// True if only white space is left: numbers must use the whole value.
+inline bool TiXmlBindAtEnd( const char* p )
+{
+	while ( isspace( (unsigned char)*p ) )
+		++p;
+	return *p == 0;
+}
+
+template<>
+struct TiXmlBindConverter< std::string >
+{
+	static const bool repeated = false;
+	static bool Convert( const char* value, std::string* out )	{ *out = value; return true; }
+};
+
+template<>
+struct TiXmlBindConverter< int >
+{
+	static const bool repeated = false;
+	static bool Convert( const char* value, int* out )
+	{
+		char* end = 0;
+		errno = 0;
+		long v = strtol( value, &end, 10 );
+		if ( end == value || errno || v < -2147483647L - 1 || v > 2147483647L || !TiXmlBindAtEnd( end ) )
+			return false;
+		*out = (int)v;
+		return true;
+	}
+};
+
+template<>
+struct TiXmlBindConverter< unsigned >
+{
+	static const bool repeated = false;
+	static bool Convert( const char* value, unsigned* out )
+	{
+		long long v;
+		char* end = 0;
+		errno = 0;
+		v = strtoll( value, &end, 10 );
+		if ( end == value || errno || v < 0 || v > 0xffffffffLL || !TiXmlBindAtEnd( end ) )
+			return false;
+		*out = (unsigned)v;
+		return true;
+	}
+};
+
+template<>
+struct TiXmlBindConverter< double >
+{
+	static const bool repeated = false;
+	static bool Convert( const char* value, double* out )
+	{
+		char* end = 0;
+		double v = strtod( value, &end );
+		if ( end == value || !TiXmlBindAtEnd( end ) )
+			return false;
+		*out = v;
+		return true;
+	}
+};
+
+template<>
+struct TiXmlBindConverter< float >
+{
+	static const bool repeated = false;
+	static bool Convert( const char* value, float* out )
+	{
+		double d;
+		if ( !TiXmlBindConverter< double >::Convert( value, &d ) )
+			return false;
+		*out = (float)d;
+		return true;
+	}
+};
+
+template<>
+struct TiXmlBindConverter< bool >
+{
+	static const bool repeated = false;
+	// Same spellings as TiXmlElement::QueryBoolAttribute().
+	static bool Convert( const char* value, bool* out );
+};
+
+template< typename E >
+struct TiXmlBindConverter< std::vector< E > >
+{
+	static const bool repeated = true;
+	static bool Convert( const char* value, std::vector< E >* out )
+	{
+		E e = E();
+		if ( !TiXmlBindConverter< E >::Convert( value, &e ) )
+			return false;
+		out->push_back( e );
+		return true;
+	}
+};
+
+
+/// [internal use] The generated assignment for one member.
+template< typename T, typename M, M T::*member >
+bool TiXmlBindAssign( void* object, const char* value )
+{
+	return TiXmlBindConverter< M >::Convert( value, &( static_cast< T* >( object )->*member ) );
+}
+
+/// Bind 'member' of 'Type' to 'attribute' of the element at 'path'.
+#define TIXML_BIND_ATTRIBUTE( Type, member, path, attribute, required )				\
+	TiXmlBindField( path, attribute, required,										\
+					TiXmlBindConverter< decltype( Type::member ) >::repeated,			\
+					&TiXmlBindAssign< Type, decltype( Type::member ), &Type::member > )
+
+/// Bind 'member' of 'Type' to the text of the element at 'path'.
+#define TIXML_BIND_TEXT( Type, member, path, required )								\
+	TIXML_BIND_ATTRIBUTE( Type, member, path, 0, required )
+
+
+// Compile time checks of a field map: every path is non-empty, relative to
+// the root (no leading or trailing '/', no empty steps), and no two fields
+// bind the same value.
+constexpr bool TiXmlBindStrEqual( const char* a, const char* b )
+{
+	return ( !a || !b ) ? ( a == b ) : ( *a != *b ) ? false : ( *a == 0 ) ? true : TiXmlBindStrEqual( a+1, b+1 );
+}
+
+constexpr bool TiXmlBindPathValid( const char* path, char previous )
+{
+	return ( *path == 0 ) ? ( previous != '/' && previous != 0 )
+						  : ( *path == '/' && ( previous == '/' || previous == 0 ) ) ? false
+						  : TiXmlBindPathValid( path+1, *path );
+}
+
+constexpr bool TiXmlBindUnique( const TiXmlBindField* field, const TiXmlBindField* others, int count )
+{
+	return count == 0 ||	(	!(    TiXmlBindStrEqual( field->path, others->path )
+									&& TiXmlBindStrEqual( field->attribute, others->attribute ) )
+							 && TiXmlBindUnique( field, others+1, count-1 ) );
+}
+
+constexpr bool TiXmlBindFieldsValid( const TiXmlBindField* fields, int count )
+{
+	return count == 0 || (		fields->path
+							 && TiXmlBindPathValid( fields->path, 0 )
+							 && ( !fields->attribute || *fields->attribute )
+							 && TiXmlBindUnique( fields, fields+1, count-1 )
+							 && TiXmlBindFieldsValid( fields+1, count-1 ) );
+}
+
+
+/** [internal use] The streaming pass shared by every binding. Reads the
+	document from 'reader' and fills 'object' from the field map, giving
+	each token to 'validation' as well if it isn't null. On failure 'error'
+	(if not null) describes every problem found.
+*/
+bool TiXmlBindRead( TiXmlReader* reader, TiXmlValidationPass* validation, void* object, const TiXmlBindField* fields, int count, std::string* error );
+
+/** [internal use] Opens 'xml' with 'options' and 'observer' and calls
+	TiXmlBindRead(), validating with 'validator' if it isn't null.
+*/
+bool TiXmlBindReadBuffer(	const char* xml, const TiXmlParseOptions& options, TiXmlParseObserver* observer,
+							const TiXmlValidator* validator, std::vector< TiXmlValidationError >* validationErrors,
+							void* object, const TiXmlBindField* fields, int count, std::string* error );
+
+/// [internal use] As TiXmlBindReadBuffer(), loading 'filename'.
+bool TiXmlBindReadFile(	const char* filename, const TiXmlParseOptions& options, TiXmlParseObserver* observer,
+						const TiXmlValidator* validator, std::vector< TiXmlValidationError >* validationErrors,
+						void* object, const TiXmlBindField* fields, int count, std::string* error );
+
+
+/** Fill 'object' from a null terminated block of xml in one streaming pass,
+	read with 'options' as TiXmlReader::SetParseOptions() takes them. The
+	phases of the read are reported to 'observer' if it isn't null; see
+	TiXmlReader::SetParseObserver(). Returns true if the xml was well
+	formed, every value converted and every required field was found.
+*/
+template< typename T >
+bool TiXmlBindParse( const char* xml, T* object, const TiXmlParseOptions& options, std::string* error = 0, TiXmlParseObserver* observer = 0 )
+{
+	static_assert(	TiXmlBindFieldsValid( T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ) ),
+					"TiXmlBind: malformed or duplicated path in bindFields" );
+	return TiXmlBindReadBuffer( xml, options, observer, 0, 0, object, T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ), error );
+}
+
+/// Fill 'object' from a null terminated block of xml, with the default options.
+template< typename T >
+bool TiXmlBindParse( const char* xml, T* object, std::string* error = 0 )
+{
+	return TiXmlBindParse( xml, object, TiXmlParseOptions(), error );
+}
+
+/** Fill 'object' from a null terminated block of xml, checking it against
+	'validator' in the same pass and with the validator's ParseOptions().
+	'validationErrors' (if not null) gets the violations, as
+	TiXmlValidator::Validate() reports them. 'observer' is as above.
+	Returns false if the xml broke a rule or couldn't be bound.
+*/
+template< typename T >
+bool TiXmlBindParse(	const char* xml, T* object, const TiXmlValidator& validator, std::vector< TiXmlValidationError >* validationErrors,
+						std::string* error = 0, TiXmlParseObserver* observer = 0 )
+{
+	static_assert(	TiXmlBindFieldsValid( T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ) ),
+					"TiXmlBind: malformed or duplicated path in bindFields" );
+	return TiXmlBindReadBuffer( xml, validator.ParseOptions(), observer, &validator, validationErrors,
+								object, T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ), error );
+}
+
+/// Fill 'object' from a file. See TiXmlBindParse().
+template< typename T >
+bool TiXmlBindLoadFile( const char* filename, T* object, const TiXmlParseOptions& options, std::string* error = 0, TiXmlParseObserver* observer = 0 )
+{
+	static_assert(	TiXmlBindFieldsValid( T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ) ),
+					"TiXmlBind: malformed or duplicated path in bindFields" );
+	return TiXmlBindReadFile( filename, options, observer, 0, 0, object, T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ), error );
+}
+
+/// Fill 'object' from a file, with the default options.
+template< typename T >
+bool TiXmlBindLoadFile( const char* filename, T* object, std::string* error = 0 )
+{
+	return TiXmlBindLoadFile( filename, object, TiXmlParseOptions(), error );
+}
+
+/// Fill 'object' from a file, checking it against 'validator'. See TiXmlBindParse().
+template< typename T >
+bool TiXmlBindLoadFile(	const char* filename, T* object, const TiXmlValidator& validator, std::vector< TiXmlValidationError >* validationErrors,
+						std::string* error = 0, TiXmlParseObserver* observer = 0 )
+{
+	static_assert(	TiXmlBindFieldsValid( T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ) ),
+					"TiXmlBind: malformed or duplicated path in bindFields" );
+	return TiXmlBindReadFile(	filename, validator.ParseOptions(), observer, &validator, validationErrors,
+								object, T::bindFields, sizeof( T::bindFields ) / sizeof( TiXmlBindField ), error );
+}
+
+#endif
@@ -0,0 +1,460 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include <string.h>
+
+#include "tinyxmlcache.h"
+#include "tinyxmlfile.h"
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#define TIXML_CACHE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+// The image is a header that identifies the source file and the load
+// settings, followed by the nodes in document order. Each node is a type
+// byte (the NodeType plus one), its row and column, and its data; an
+// element's children follow its attributes and end with a zero byte, as
+// does the list of top level nodes. Everything is in the machine's own
+// byte order: an image is never moved to another machine.
+
+namespace {
+
+const char imageMagic[4] = { 'T', 'X', 'C', '5' };
+
+void Put( TIXML_STRING* out, const void* data, size_t length )
+{
+	out->append( static_cast< const char* >( data ), length );
+}
+
+void PutByte( TIXML_STRING* out, unsigned char v )		{ Put( out, &v, 1 ); }
+void PutInt( TIXML_STRING* out, int v )					{ Put( out, &v, sizeof( v ) ); }
+
+void PutString( TIXML_STRING* out, const char* str, size_t length )
+{
+	TiXmlU32 n = (TiXmlU32)length;
+	Put( out, &n, sizeof( n ) );
+	Put( out, str, length );
+}
+
+void PutString( TIXML_STRING* out, const TIXML_STRING& str )
+{
+	PutString( out, str.c_str(), str.length() );
+}
+
+// Bounds checked reads from an image. A failed read leaves the cursor
+// exhausted, so the caller only needs to check once per node.
+class ImageCursor
+{
+public:
+	ImageCursor( const char* _p, size_t length ) : p( _p ), end( _p + length ), ok( true ) {}
+
+	bool Get( void* data, size_t length )
+	{
+		if ( (size_t)( end - p ) < length )
+		{
+			p = end;
+			ok = false;
+			return false;
+		}
+		memcpy( data, p, length );
+		p += length;
+		return true;
+	}
+
+	unsigned char GetByte()		{ unsigned char v = 0; Get( &v, 1 ); return v; }
+	int GetInt()				{ int v = 0; Get( &v, sizeof( v ) ); return v; }
+
+	// Points 'str' at the next string in the image and sets its length.
+	bool GetString( const char** str, size_t* length )
+	{
+		TiXmlU32 n = 0;
+		if ( !Get( &n, sizeof( n ) ) || (size_t)( end - p ) < n )
+		{
+			p = end;
+			ok = false;
+			return false;
+		}
+		*str = p;
+		*length = n;
+		p += n;
+		return true;
+	}
+
+	bool GetString( TIXML_STRING* str )
+	{
+		const char* s = 0;
+		size_t n = 0;
+		if ( !GetString( &s, &n ) )
+			return false;
+		str->assign( s, n );
+		return true;
+	}
+
+	bool AtEnd() const	{ return p == end; }
+	bool Ok() const		{ return ok; }
+
+private:
+	const char* p;
+	const char* end;
+	bool ok;
+};
+
+}	// namespace
+
+
+TiXmlDocumentCache::TiXmlDocumentCache( const char* _directory )
+	: directory( _directory ), hits( 0 ), misses( 0 )
+{
+}
+
+
+TIXML_STRING TiXmlDocumentCache::CachePath( const char* filename ) const
+{
+	static const char hexDigits[] = "0123456789abcdef";
+
+	TiXmlU64 h = TiXmlHashBytes( reinterpret_cast< const unsigned char* >( filename ), strlen( filename ) );
+	char name[ 16 + 5 ];
+	for ( int i=15; i>=0; --i, h >>= 4 )
+		name[i] = hexDigits[ h & 15 ];
+	memcpy( name + 16, ".txc", 5 );
+
+	TIXML_STRING path( directory );
+	if ( path.length() && path[ path.length()-1 ] != '/' )
+		path += "/";
+	path += name;
+	return path;
+}
+
+
+bool TiXmlDocumentCache::LoadFile( TiXmlDocument* doc, const char* filename, TiXmlEncoding encoding )
+{
+#ifdef TIXML_CACHE_MMAP
+	int fd = open( filename, O_RDONLY );
+	struct stat source;
+	if ( fd < 0 || fstat( fd, &source ) != 0 || source.st_size <= 0 )
+	{
+		if ( fd >= 0 )
+			close( fd );
+		++misses;
+		return doc->LoadFile( filename, encoding );
+	}
+
+	TiXmlU64 contentHash = 0;
+	void* content = mmap( 0, (size_t)source.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	if ( content != MAP_FAILED )
+	{
+		contentHash = TiXmlHashBytes( static_cast< const unsigned char* >( content ), (size_t)source.st_size );
+		munmap( content, (size_t)source.st_size );
+	}
+
+	// Everything the parse result depends on goes in the header, so a cached
+	// image is used only if its header matches byte for byte.
+	TIXML_STRING header;
+	{
+		TiXmlFileStamp stamp;
+		TiXmlStampFile( source, &stamp );
+
+		Put( &header, imageMagic, sizeof( imageMagic ) );
+		Put( &header, &stamp, sizeof( stamp ) );
+		Put( &header, &contentHash, sizeof( contentHash ) );
+		const TiXmlParseOptions& options = doc->ParseOptions();
+		TiXmlU64 maxBytes = (TiXmlU64)options.maxBytes;
+		TiXmlU64 maxMemory = (TiXmlU64)options.maxMemory;
+
+		PutInt( &header, (int)encoding );
+		PutInt( &header, options.tabSize );
+		PutByte( &header, options.CondenseWhiteSpace() ? 1 : 0 );
+		PutInt( &header, options.keep );
+		PutInt( &header, options.maxDepth );
+		Put( &header, &maxBytes, sizeof( maxBytes ) );
+		Put( &header, &maxMemory, sizeof( maxMemory ) );
+		PutByte( &header, options.validateUtf8 ? 1 : 0 );
+		PutByte( &header, options.namespaces ? 1 : 0 );
+
+		int pathCount = 0;
+		while ( options.paths && options.paths[ pathCount ] )
+			++pathCount;
+		PutInt( &header, pathCount );
+		for ( int i=0; i<pathCount; ++i )
+			PutString( &header, options.paths[i], strlen( options.paths[i] ) );
+
+		PutString( &header, filename, strlen( filename ) );
+	}
+
+	const TIXML_STRING cachePath = CachePath( filename );
+
+	if ( content != MAP_FAILED )
+	{
+		int cacheFd = open( cachePath.c_str(), O_RDONLY );
+		struct stat cached;
+		if ( cacheFd >= 0 )
+		{
+			if (    fstat( cacheFd, &cached ) == 0
+				 && (size_t)cached.st_size > header.length() )
+			{
+				void* image = mmap( 0, (size_t)cached.st_size, PROT_READ, MAP_PRIVATE, cacheFd, 0 );
+				if ( image != MAP_FAILED )
+				{
+					const char* bytes = static_cast< const char* >( image );
+					bool restored =    memcmp( bytes, header.c_str(), header.length() ) == 0
+									&& Restore( doc, bytes + header.length(), (size_t)cached.st_size - header.length() );
+					munmap( image, (size_t)cached.st_size );
+
+					if ( restored )
+					{
+						close( cacheFd );
+						close( fd );
+						doc->SetValue( filename );
+						++hits;
+						// The image keeps names as written; resolve them as the parse did.
+						if ( doc->ParseOptions().namespaces && !doc->ResolveNamespaces() )
+						{
+							doc->SetError( TiXmlBase::TIXML_ERROR_UNDECLARED_PREFIX, 0, 0, encoding );
+							return false;
+						}
+						if ( doc->ParseOptions().hashNodes )
+							doc->Hash();
+						return true;
+					}
+				}
+			}
+			close( cacheFd );
+		}
+	}
+
+	++misses;
+
+	// Parse from the descriptor that was hashed, so the image can't describe
+	// a different version of the file than the one the header names.
+	FILE* file = fdopen( fd, "rb" );
+	if ( !file )
+	{
+		close( fd );
+		return doc->LoadFile( filename, encoding );
+	}
+	doc->SetValue( filename );
+	bool result = doc->LoadFile( file, encoding );
+
+	struct stat after;
+	bool unchanged =    fstat( fileno( file ), &after ) == 0
+					 && after.st_size == source.st_size
+					 && after.st_mtime == source.st_mtime;
+	fclose( file );
+
+	if ( result && unchanged && content != MAP_FAILED )
+		Store( *doc, header, cachePath.c_str() );
+	return result;
+#else
+	++misses;
+	return doc->LoadFile( filename, encoding );
+#endif
+}
+
+
+bool TiXmlDocumentCache::Restore( TiXmlDocument* doc, const char* image, size_t length ) const
+{
+	ImageCursor in( image, length );
+	TIXML_STRING value, name;
+
+	doc->Clear();
+	doc->ClearError();
+	doc->useMicrosoftBOM = in.GetByte() != 0;
+	doc->location.row = in.GetInt();
+	doc->location.col = in.GetInt();
+	// Nothing is freed while the tree is rebuilt, so its size is the peak.
+	doc->peakBytes = TiXmlDocument::NodeBytes( doc, 0 );
+
+	TiXmlNode* parent = doc;
+	while ( in.Ok() )
+	{
+		const unsigned char type = in.GetByte();
+		if ( !in.Ok() )
+			break;
+
+		if ( type == 0 )
+		{
+			if ( parent == doc )
+				break;
+			parent = parent->Parent();
+			continue;
+		}
+
+		TiXmlCursor location;
+		location.row = in.GetInt();
+		location.col = in.GetInt();
+
+		TiXmlNode* node = 0;
+		switch ( type - 1 )
+		{
+			case TiXmlNode::TINYXML_ELEMENT:
+			{
+				in.GetString( &value );
+				TiXmlElement* element = new TiXmlElement( value.c_str() );
+				node = element;
+
+				const int count = in.GetInt();
+				for ( int i=0; i<count && in.Ok(); ++i )
+				{
+					in.GetString( &name );
+					in.GetString( &value );
+					element->SetAttribute( name.c_str(), value.c_str() );
+					TiXmlAttribute* attribute = element->LastAttribute();
+					attribute->location.row = in.GetInt();
+					attribute->location.col = in.GetInt();
+				}
+				break;
+			}
+
+			case TiXmlNode::TINYXML_TEXT:
+			{
+				const bool cdata = in.GetByte() != 0;
+				in.GetString( &value );
+				TiXmlText* text = new TiXmlText( value.c_str() );
+				text->SetCDATA( cdata );
+				node = text;
+				break;
+			}
+
+			case TiXmlNode::TINYXML_COMMENT:
+				in.GetString( &value );
+				node = new TiXmlComment( value.c_str() );
+				break;
+
+			case TiXmlNode::TINYXML_UNKNOWN:
+				in.GetString( &value );
+				node = new TiXmlUnknown();
+				node->SetValue( value.c_str() );
+				break;
+
+			case TiXmlNode::TINYXML_DECLARATION:
+			{
+				TIXML_STRING version, encoding, standalone;
+				in.GetString( &version );
+				in.GetString( &encoding );
+				in.GetString( &standalone );
+				node = new TiXmlDeclaration( version.c_str(), encoding.c_str(), standalone.c_str() );
+				break;
+			}
+
+			default:
+				doc->Clear();
+				return false;
+		}
+
+		node->location = location;
+		parent->LinkEndChild( node );
+		doc->peakBytes += TiXmlDocument::NodeBytes( node, 0 );
+		if ( type - 1 == TiXmlNode::TINYXML_ELEMENT )
+			parent = node;
+	}
+
+	if ( !in.Ok() || !in.AtEnd() || parent != doc )
+	{
+		doc->Clear();
+		return false;
+	}
+	return true;
+}
+
+
+void TiXmlDocumentCache::Store( const TiXmlDocument& doc, const TIXML_STRING& header, const char* cachePath ) const
+{
+#ifdef TIXML_CACHE_MMAP
+	TIXML_STRING image( header );
+	PutByte( &image, doc.useMicrosoftBOM ? 1 : 0 );
+	PutInt( &image, doc.location.row );
+	PutInt( &image, doc.location.col );
+
+	const TiXmlNode* parent = &doc;
+	const TiXmlNode* node = doc.FirstChild();
+	for( ;; )
+	{
+		if ( !node )
+		{
+			// End of the current child list.
+			PutByte( &image, 0 );
+			if ( parent == &doc )
+				break;
+			node = parent->NextSibling();
+			parent = parent->Parent();
+			continue;
+		}
+
+		PutByte( &image, (unsigned char)( node->Type() + 1 ) );
+		PutInt( &image, node->location.row );
+		PutInt( &image, node->location.col );
+
+		if ( const TiXmlElement* element = node->ToElement() )
+		{
+			PutString( &image, element->ValueTStr() );
+
+			int count = 0;
+			for ( const TiXmlAttribute* a = element->FirstAttribute(); a; a = a->Next() )
+				++count;
+			PutInt( &image, count );
+			for ( const TiXmlAttribute* a = element->FirstAttribute(); a; a = a->Next() )
+			{
+				PutString( &image, a->NameTStr() );
+				PutString( &image, a->Value(), strlen( a->Value() ) );
+				PutInt( &image, a->location.row );
+				PutInt( &image, a->location.col );
+			}
+
+			parent = node;
+			node = node->FirstChild();
+			continue;
+		}
+
+		if ( const TiXmlText* text = node->ToText() )
+		{
+			PutByte( &image, text->CDATA() ? 1 : 0 );
+			PutString( &image, text->ValueTStr() );
+		}
+		else if ( const TiXmlDeclaration* decl = node->ToDeclaration() )
+		{
+			PutString( &image, decl->Version(), strlen( decl->Version() ) );
+			PutString( &image, decl->Encoding(), strlen( decl->Encoding() ) );
+			PutString( &image, decl->Standalone(), strlen( decl->Standalone() ) );
+		}
+		else
+		{
+			PutString( &image, node->ValueTStr() );
+		}
+		node = node->NextSibling();
+	}
+
+	// Readers see the old image or the new one, never part of one.
+	TiXmlReplaceFile( cachePath, image.c_str(), image.length() );
+#else
+	(void)doc;
+	(void)header;
+	(void)cachePath;
+#endif
+}
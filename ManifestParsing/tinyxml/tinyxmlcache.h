@@ -0,0 +1,87 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+#ifndef TINYXML_CACHE_INCLUDED
+#define TINYXML_CACHE_INCLUDED
+
+#include "tinyxml.h"
+
+/**	A persistent cache of parsed documents, for files that are loaded over and
+	over but rarely change (an application's own manifest, for example).
+
+	The first load of a file parses it normally and writes a compact binary
+	image of the resulting DOM to the cache directory. Later loads memory map
+	that image and rebuild the document from it, without parsing, as long as
+	the file still has the same path, inode, modification time, size and
+	content hash, and is loaded with the same encoding and parse options.
+	Otherwise the file is parsed again and the image is replaced; images are
+	written to a temporary file and renamed into place, so a reader never
+	sees a partial one.
+
+	@verbatim
+	TiXmlDocumentCache cache( "/tmp/xmlcache" );
+	TiXmlDocument doc;
+	if ( cache.LoadFile( &doc, "manifest.xml" ) )
+		...
+	printf( "%lu hits, %lu misses\n", cache.Hits(), cache.Misses() );
+	@endverbatim
+
+	The cache is only a shortcut: any problem with the cache directory or an
+	image is treated as a miss, and the result is always the document
+	TiXmlDocument::LoadFile() would produce, row and column included. Where
+	memory mapping isn't available every load is a miss.
+*/
+class TiXmlDocumentCache
+{
+public:
+	/// Keep the cached images in 'directory', which must already exist.
+	TiXmlDocumentCache( const char* directory );
+
+	/** Load 'filename' into 'doc', from the cache if it is current. Returns
+		true if successful; on failure the document holds the parse error, as
+		with TiXmlDocument::LoadFile().
+	*/
+	bool LoadFile( TiXmlDocument* doc, const char* filename, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+
+	/// Loads that were rebuilt from a cached image.
+	unsigned long Hits() const			{ return hits; }
+	/// Loads that had to parse the file.
+	unsigned long Misses() const		{ return misses; }
+	/// Set the hit and miss counts back to zero.
+	void ResetCounters()				{ hits = misses = 0; }
+
+	/// The file that holds the image of 'filename'.
+	TIXML_STRING CachePath( const char* filename ) const;
+
+private:
+	bool Restore( TiXmlDocument* doc, const char* image, size_t length ) const;
+	void Store( const TiXmlDocument& doc, const TIXML_STRING& header, const char* cachePath ) const;
+
+	TIXML_STRING directory;
+	unsigned long hits;
+	unsigned long misses;
+};
+
+#endif
@@ -0,0 +1,513 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#ifdef TIXML_USE_STL
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "tinyxmlcolumns.h"
+#include "tinyxmlbind.h"
+#include "tinyxmlreader.h"
+
+// Documents handed to a thread at a time. Small enough to share out a batch
+// evenly, large enough that joining the runs costs little.
+const size_t TIXML_COLUMN_RUN = 64;
+
+
+struct TiXmlColumnExtractor::Run
+{
+	size_t first;
+	size_t count;
+	TiXmlColumnBatch out;
+
+	// Kept from one document of the run to the next, to save reallocating.
+	std::vector< int > open;			// step of each open element, -1 below one no path goes through
+	std::vector< int > textColumns;		// text columns being collected, with the depth of their element
+	std::vector< int > textDepths;
+	std::vector< std::string > textValues;
+};
+
+
+size_t TiXmlColumn::Values() const
+{
+	switch ( spec.type )
+	{
+		case TiXmlColumnSpec::STRING:	return offsets.empty() ? 0 : offsets.size() - 1;
+		case TiXmlColumnSpec::INT64:	return int64s.size();
+		case TiXmlColumnSpec::DOUBLE:	return doubles.size();
+		case TiXmlColumnSpec::BOOL:		return bools.size();
+	}
+	return 0;
+}
+
+
+TiXmlColumnExtractor::TiXmlColumnExtractor( const TiXmlColumnSpec* _specs, int count )
+	: specs( _specs, _specs + count ), steps( 1 )
+{
+	for ( int i=0; i<count; ++i )
+	{
+		int step = 0;
+		const char* p = specs[i].path;
+		while ( *p )
+		{
+			const char* end = strchr( p, '/' );
+			if ( !end )
+				end = p + strlen( p );
+			const std::string name( p, end );
+
+			int child = -1;
+			for ( size_t j=0; j<steps[step].children.size(); ++j )
+			{
+				if ( steps[ steps[step].children[j] ].name == name )
+					child = steps[step].children[j];
+			}
+			if ( child < 0 )
+			{
+				child = (int)steps.size();
+				steps.push_back( Step() );
+				steps.back().name = name;
+				steps[step].children.push_back( child );
+			}
+			step = child;
+			p = *end ? end + 1 : end;
+		}
+		assert( step > 0 );		// an empty path names no element
+		if ( specs[i].attribute )
+			steps[step].attributes.push_back( i );
+		else
+			steps[step].texts.push_back( i );
+	}
+}
+
+
+int TiXmlColumnExtractor::FindChild( int step, const char* name ) const
+{
+	if ( step < 0 )
+		return -1;
+	const std::vector< int >& children = steps[step].children;
+	for ( size_t i=0; i<children.size(); ++i )
+	{
+		if ( steps[ children[i] ].name == name )
+			return children[i];
+	}
+	return -1;
+}
+
+
+void TiXmlColumnExtractor::Start( TiXmlColumnBatch* batch, const std::vector< TiXmlColumnSpec >& specs )
+{
+	// Clear rather than replace the buffers, so a batch extracted into again
+	// keeps the memory it already has.
+	batch->rows = 0;
+	batch->failures.clear();
+	batch->columns.resize( specs.size() );
+	for ( size_t i=0; i<specs.size(); ++i )
+	{
+		TiXmlColumn& column = batch->columns[i];
+		column.spec = specs[i];
+		column.validity.clear();
+		column.listOffsets.clear();
+		column.int64s.clear();
+		column.doubles.clear();
+		column.bools.clear();
+		column.offsets.clear();
+		column.data.clear();
+		column.badValues = 0;
+		column.rowValues = column.rowData = column.rowBadValues = 0;
+
+		if ( column.spec.repeated )
+			column.listOffsets.push_back( 0 );
+		if ( column.spec.type == TiXmlColumnSpec::STRING )
+			column.offsets.push_back( 0 );
+	}
+}
+
+
+void TiXmlColumnExtractor::BeginRow( TiXmlColumnBatch* batch )
+{
+	++batch->rows;
+	for ( size_t i=0; i<batch->columns.size(); ++i )
+	{
+		TiXmlColumn& column = batch->columns[i];
+		column.rowValues = column.Values();
+		column.rowData = column.data.size();
+		column.rowBadValues = column.badValues;
+
+		// A list is there, if empty, once the document parses. A plain value
+		// gets a null slot that Store() fills in; a string's slot is the
+		// bytes after the last offset, closed off by EndRow().
+		column.validity.push_back( column.spec.repeated ? 1 : 0 );
+		if ( column.spec.repeated )
+			continue;
+		switch ( column.spec.type )
+		{
+			case TiXmlColumnSpec::STRING:	break;
+			case TiXmlColumnSpec::INT64:	column.int64s.push_back( 0 );	break;
+			case TiXmlColumnSpec::DOUBLE:	column.doubles.push_back( 0 );	break;
+			case TiXmlColumnSpec::BOOL:		column.bools.push_back( 0 );	break;
+		}
+	}
+}
+
+
+void TiXmlColumnExtractor::Store( TiXmlColumn* column, const char* value )
+{
+	const bool repeated = column->spec.repeated;
+	bool ok = true;
+
+	switch ( column->spec.type )
+	{
+		case TiXmlColumnSpec::STRING:
+			if ( !repeated )
+				column->data.resize( column->offsets.back() );
+			column->data += value;
+			if ( repeated )
+				column->offsets.push_back( column->data.size() );
+			break;
+
+		case TiXmlColumnSpec::INT64:
+		{
+			char* end = 0;
+			errno = 0;
+			long long v = strtoll( value, &end, 10 );
+			ok = end != value && !errno && TiXmlBindAtEnd( end );
+			if ( repeated && ok )
+				column->int64s.push_back( v );
+			else if ( !repeated )
+				column->int64s.back() = ok ? v : 0;
+			break;
+		}
+
+		case TiXmlColumnSpec::DOUBLE:
+		{
+			double v = 0;
+			ok = TiXmlBindConverter< double >::Convert( value, &v );
+			if ( repeated && ok )
+				column->doubles.push_back( v );
+			else if ( !repeated )
+				column->doubles.back() = ok ? v : 0;
+			break;
+		}
+
+		case TiXmlColumnSpec::BOOL:
+		{
+			bool v = false;
+			ok = TiXmlBindConverter< bool >::Convert( value, &v );
+			if ( repeated && ok )
+				column->bools.push_back( v ? 1 : 0 );
+			else if ( !repeated )
+				column->bools.back() = ok && v ? 1 : 0;
+			break;
+		}
+	}
+
+	if ( !ok )
+		++column->badValues;
+	// The last occurrence decides whether a plain value is null.
+	if ( !repeated )
+		column->validity.back() = ok ? 1 : 0;
+}
+
+
+void TiXmlColumnExtractor::EndRow( TiXmlColumnBatch* batch )
+{
+	for ( size_t i=0; i<batch->columns.size(); ++i )
+	{
+		TiXmlColumn& column = batch->columns[i];
+		if ( !column.spec.repeated && column.spec.type == TiXmlColumnSpec::STRING )
+			column.offsets.push_back( column.data.size() );
+		if ( column.spec.repeated )
+			column.listOffsets.push_back( column.Values() );
+	}
+}
+
+
+void TiXmlColumnExtractor::FailRow( TiXmlColumnBatch* batch, const std::string& error )
+{
+	// Take back whatever the document got as far as, and leave a null row.
+	for ( size_t i=0; i<batch->columns.size(); ++i )
+	{
+		TiXmlColumn& column = batch->columns[i];
+		const size_t values = column.rowValues + ( column.spec.repeated ? 0 : 1 );
+		switch ( column.spec.type )
+		{
+			case TiXmlColumnSpec::STRING:
+				column.offsets.resize( column.rowValues + 1 );
+				column.data.resize( column.rowData );
+				break;
+			case TiXmlColumnSpec::INT64:
+				column.int64s.resize( values );
+				break;
+			case TiXmlColumnSpec::DOUBLE:
+				column.doubles.resize( values );
+				break;
+			case TiXmlColumnSpec::BOOL:
+				column.bools.resize( values );
+				break;
+		}
+		if ( !column.spec.repeated && column.spec.type != TiXmlColumnSpec::STRING )
+		{
+			// resize() only fills new elements, and the slot may hold a value.
+			switch ( column.spec.type )
+			{
+				case TiXmlColumnSpec::INT64:	column.int64s.back() = 0;	break;
+				case TiXmlColumnSpec::DOUBLE:	column.doubles.back() = 0;	break;
+				case TiXmlColumnSpec::BOOL:		column.bools.back() = 0;	break;
+				default:						break;
+			}
+		}
+		column.badValues = column.rowBadValues;
+		column.validity.back() = 0;
+	}
+	EndRow( batch );
+
+	TiXmlColumnFailure failure;
+	failure.row = batch->rows - 1;
+	failure.error = error;
+	batch->failures.push_back( failure );
+}
+
+
+bool TiXmlColumnExtractor::ExtractDocument( TiXmlReader* reader, Run* run ) const
+{
+	TiXmlColumnBatch* out = &run->out;
+	std::vector< int >& open = run->open;
+	std::vector< int >& textColumns = run->textColumns;
+	std::vector< int >& textDepths = run->textDepths;
+	std::vector< std::string >& textValues = run->textValues;
+	open.clear();
+	textColumns.clear();
+	textDepths.clear();
+
+	for( ;; )
+	{
+		TiXmlReader::Token token = reader->Next();
+
+		if ( token == TiXmlReader::TOKEN_END_DOCUMENT )
+			break;
+
+		if ( token == TiXmlReader::TOKEN_ERROR )
+		{
+			char buf[ 128 ];
+			TIXML_SNPRINTF( buf, sizeof( buf ), "%s (row %d, col %d)", reader->ErrorDesc(), reader->ErrorRow(), reader->ErrorCol() );
+			FailRow( out, buf );
+			return false;
+		}
+
+		if ( token == TiXmlReader::TOKEN_START_ELEMENT )
+		{
+			const int step = FindChild( open.empty() ? 0 : open.back(), reader->Name() );
+			open.push_back( step );
+			if ( step < 0 )
+				continue;
+
+			const Step& s = steps[step];
+			for ( size_t i=0; i<s.attributes.size(); ++i )
+			{
+				const char* value = reader->Attribute( specs[ s.attributes[i] ].attribute );
+				if ( value )
+					Store( &out->columns[ s.attributes[i] ], value );
+			}
+			for ( size_t i=0; i<s.texts.size(); ++i )
+			{
+				textColumns.push_back( s.texts[i] );
+				textDepths.push_back( reader->Depth() );
+				if ( textValues.size() < textColumns.size() )
+					textValues.push_back( std::string() );
+				textValues[ textColumns.size() - 1 ].clear();
+			}
+		}
+		else if ( token == TiXmlReader::TOKEN_TEXT )
+		{
+			for ( size_t j=0; j<textColumns.size(); ++j )
+			{
+				if ( textDepths[j] == reader->Depth() )
+					textValues[j].append( reader->Text(), reader->TextLength() );
+			}
+		}
+		else if ( token == TiXmlReader::TOKEN_END_ELEMENT )
+		{
+			// Close out the text columns of the element that just ended.
+			while ( !textDepths.empty() && textDepths.back() > reader->Depth() )
+			{
+				Store( &out->columns[ textColumns.back() ], textValues[ textColumns.size() - 1 ].c_str() );
+				textColumns.pop_back();
+				textDepths.pop_back();
+			}
+			assert( !open.empty() );
+			open.pop_back();
+		}
+	}
+	EndRow( out );
+	return true;
+}
+
+
+void TiXmlColumnExtractor::ExtractRun( Run* run, const char* const* inputs, bool files, TiXmlReader* reader ) const
+{
+	Start( &run->out, specs );
+	for ( size_t i=0; i<run->count; ++i )
+	{
+		const char* input = inputs[ run->first + i ];
+		BeginRow( &run->out );
+		if ( files )
+		{
+			if ( !reader->LoadFile( input, parseOptions.encoding ) )
+			{
+				FailRow( &run->out, std::string( reader->ErrorDesc() ) + ": " + input );
+				continue;
+			}
+		}
+		else
+		{
+			reader->Reset( input, parseOptions.encoding );
+		}
+		ExtractDocument( reader, run );
+	}
+}
+
+
+void TiXmlColumnExtractor::Append( TiXmlColumnBatch* to, const TiXmlColumnBatch& from )
+{
+	for ( size_t i=0; i<from.failures.size(); ++i )
+	{
+		to->failures.push_back( from.failures[i] );
+		to->failures.back().row += to->rows;
+	}
+	to->rows += from.rows;
+
+	for ( size_t i=0; i<to->columns.size(); ++i )
+	{
+		TiXmlColumn& a = to->columns[i];
+		const TiXmlColumn& b = from.columns[i];
+
+		// The offsets of the run start at 0; move them past what's already here.
+		if ( a.spec.repeated )
+		{
+			const size_t base = a.Values();
+			for ( size_t j=1; j<b.listOffsets.size(); ++j )
+				a.listOffsets.push_back( base + b.listOffsets[j] );
+		}
+		if ( a.spec.type == TiXmlColumnSpec::STRING )
+		{
+			const size_t base = a.data.size();
+			for ( size_t j=1; j<b.offsets.size(); ++j )
+				a.offsets.push_back( base + b.offsets[j] );
+			a.data += b.data;
+		}
+		a.validity.insert( a.validity.end(), b.validity.begin(), b.validity.end() );
+		a.int64s.insert( a.int64s.end(), b.int64s.begin(), b.int64s.end() );
+		a.doubles.insert( a.doubles.end(), b.doubles.begin(), b.doubles.end() );
+		a.bools.insert( a.bools.end(), b.bools.begin(), b.bools.end() );
+		a.badValues += b.badValues;
+	}
+}
+
+
+bool TiXmlColumnExtractor::Extract( const char* const* inputs, size_t count, bool files, TiXmlColumnBatch* batch, int threads ) const
+{
+	std::vector< Run > runs( ( count + TIXML_COLUMN_RUN - 1 ) / TIXML_COLUMN_RUN );
+	for ( size_t i=0; i<runs.size(); ++i )
+	{
+		runs[i].first = i * TIXML_COLUMN_RUN;
+		runs[i].count = std::min( TIXML_COLUMN_RUN, count - runs[i].first );
+	}
+
+	if ( threads <= 0 )
+		threads = (int)std::thread::hardware_concurrency();
+	if ( threads > (int)runs.size() )
+		threads = (int)runs.size();
+
+	// Each thread takes the next run no one has started until there are none.
+	std::atomic< size_t > next( 0 );
+	auto work = [&]()
+	{
+		TiXmlReader reader;
+		reader.SetParseOptions( parseOptions );
+		for ( size_t i; ( i = next++ ) < runs.size(); )
+			ExtractRun( &runs[i], inputs, files, &reader );
+	};
+
+	if ( threads <= 1 )
+	{
+		work();
+	}
+	else
+	{
+		std::vector< std::thread > workers;
+		for ( int i=1; i<threads; ++i )
+			workers.push_back( std::thread( work ) );
+		work();
+		for ( size_t i=0; i<workers.size(); ++i )
+			workers[i].join();
+	}
+
+	Start( batch, specs );
+	if ( !runs.empty() )
+	{
+		// Size the joined buffers once, rather than growing them run by run.
+		for ( size_t c=0; c<specs.size(); ++c )
+		{
+			size_t values = 0, bytes = 0;
+			for ( size_t i=0; i<runs.size(); ++i )
+			{
+				values += runs[i].out.columns[c].Values();
+				bytes += runs[i].out.columns[c].data.size();
+			}
+			TiXmlColumn& column = batch->columns[c];
+			column.validity.reserve( count );
+			if ( column.spec.repeated )
+				column.listOffsets.reserve( count + 1 );
+			switch ( column.spec.type )
+			{
+				case TiXmlColumnSpec::STRING:	column.offsets.reserve( values + 1 );	column.data.reserve( bytes );	break;
+				case TiXmlColumnSpec::INT64:	column.int64s.reserve( values );	break;
+				case TiXmlColumnSpec::DOUBLE:	column.doubles.reserve( values );	break;
+				case TiXmlColumnSpec::BOOL:		column.bools.reserve( values );		break;
+			}
+		}
+		for ( size_t i=0; i<runs.size(); ++i )
+		{
+			Append( batch, runs[i].out );
+			runs[i].out = TiXmlColumnBatch();
+		}
+	}
+	return batch->failures.empty();
+}
+
+
+bool TiXmlColumnExtractor::ExtractBuffers( const char* const* xml, size_t count, TiXmlColumnBatch* batch, int threads ) const
+{
+	return Extract( xml, count, false, batch, threads );
+}
+
+
+bool TiXmlColumnExtractor::ExtractFiles( const char* const* filenames, size_t count, TiXmlColumnBatch* batch, int threads ) const
+{
+	return Extract( filenames, count, true, batch, threads );
+}
+
+#endif
@@ -0,0 +1,247 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+
+#ifndef TINYXML_COLUMNS_INCLUDED
+#define TINYXML_COLUMNS_INCLUDED
+
+#include "tinyxml.h"
+
+#ifndef TIXML_USE_STL
+#error "tinyxmlcolumns.h requires TIXML_USE_STL"
+#endif
+
+#include <string>
+#include <vector>
+
+class TiXmlReader;
+
+/**	One value to pull out of every document: an element path (slash separated,
+	starting at the root element, as in TiXmlBindField) and either an
+	attribute of that element or its text, converted to 'type'.
+*/
+struct TiXmlColumnSpec
+{
+	enum Type
+	{
+		STRING,
+		INT64,
+		DOUBLE,
+		BOOL		///< Same spellings as TiXmlElement::QueryBoolAttribute().
+	};
+
+	const char* path;		///< Element path from the root, e.g. "manifest/application".
+	const char* attribute;	///< Attribute name, or null for the element's text.
+	Type type;
+	bool repeated;			///< Keep every occurrence, as a list per row, rather than the last.
+};
+
+
+/**	The values of one TiXmlColumnSpec across a batch, one row per document,
+	laid out the way Apache Arrow lays out its arrays: every value of the
+	column in one contiguous buffer of its type, and strings as one block of
+	bytes with an offset buffer into it.
+
+	A plain column has Rows() values; value 'row' is null when the document
+	didn't have it, it didn't convert, or the document couldn't be read. A
+	repeated column is a list per row: the values of row 'r' are those from
+	ListOffsets()[r] up to ListOffsets()[r+1], and only the rows of documents
+	that couldn't be read are null. Values that don't convert are left out
+	of a list, and counted by BadValues() in either case.
+
+	The buffers belong to the column; the pointers stay valid until the batch
+	holding it is extracted into again or destroyed.
+*/
+class TiXmlColumn
+{
+public:
+	const TiXmlColumnSpec& Spec() const		{ return spec; }
+
+	/// The number of rows: one per document in the batch.
+	size_t Rows() const						{ return validity.size(); }
+	/// The number of values: Rows() for a plain column, the total of the lists for a repeated one.
+	size_t Values() const;
+	/// Values that were found but didn't convert to the column's type.
+	size_t BadValues() const				{ return badValues; }
+
+	/// False if row 'row' is null.
+	bool Valid( size_t row ) const			{ return validity[row] != 0; }
+	/// One byte per row, 1 for a row that has a value (or list) and 0 for a null one.
+	const unsigned char* Validity() const	{ return validity.empty() ? 0 : &validity[0]; }
+	/// Rows()+1 offsets into the values of a repeated column; null for a plain column.
+	const size_t* ListOffsets() const		{ return listOffsets.empty() ? 0 : &listOffsets[0]; }
+
+	/// The values of an INT64 column. Null rows hold 0.
+	const long long* Int64s() const			{ return int64s.empty() ? 0 : &int64s[0]; }
+	/// The values of a DOUBLE column. Null rows hold 0.
+	const double* Doubles() const			{ return doubles.empty() ? 0 : &doubles[0]; }
+	/// The values of a BOOL column, one byte each. Null rows hold 0.
+	const unsigned char* Bools() const		{ return bools.empty() ? 0 : &bools[0]; }
+
+	/** Values()+1 offsets into Data() for a STRING column: value 'i' is the
+		Offsets()[i+1] - Offsets()[i] bytes at Data() + Offsets()[i], and is
+		not null terminated. Null rows are empty.
+	*/
+	const size_t* Offsets() const			{ return offsets.empty() ? 0 : &offsets[0]; }
+	/// The bytes of every value of a STRING column, end to end.
+	const char* Data() const				{ return data.data(); }
+	/// Value 'i' of a STRING column, copied into a std::string.
+	std::string String( size_t i ) const	{ return data.substr( offsets[i], offsets[i+1] - offsets[i] ); }
+
+private:
+	friend class TiXmlColumnExtractor;
+
+	TiXmlColumnSpec spec;
+	std::vector< unsigned char > validity;
+	std::vector< size_t > listOffsets;
+	std::vector< long long > int64s;
+	std::vector< double > doubles;
+	std::vector< unsigned char > bools;
+	std::vector< size_t > offsets;
+	std::string data;
+	size_t badValues;
+
+	// Where the row being extracted starts, to take it back if its document fails.
+	size_t rowValues;
+	size_t rowData;
+	size_t rowBadValues;
+};
+
+
+/// A document of a batch that couldn't be read or parsed.
+struct TiXmlColumnFailure
+{
+	size_t row;				///< Its row in the batch.
+	std::string error;		///< What went wrong, with the row and column in the document.
+};
+
+
+/// The columns extracted from one batch of documents.
+class TiXmlColumnBatch
+{
+public:
+	TiXmlColumnBatch() : rows( 0 ) {}
+
+	/// The number of documents in the batch.
+	size_t Rows() const										{ return rows; }
+	/// The number of columns, one per TiXmlColumnSpec, in the same order.
+	int Columns() const										{ return (int)columns.size(); }
+	const TiXmlColumn& Column( int i ) const				{ return columns[i]; }
+	/// The documents that couldn't be read or parsed, by row. Every column is null on their rows.
+	const std::vector< TiXmlColumnFailure >& Failures() const	{ return failures; }
+
+private:
+	friend class TiXmlColumnExtractor;
+
+	size_t rows;
+	std::vector< TiXmlColumn > columns;
+	std::vector< TiXmlColumnFailure > failures;
+};
+
+
+/**	Pulls the same few values out of many documents into typed columns,
+	without building a DOM or an object per row.
+
+	@verbatim
+	static const TiXmlColumnSpec specs[] =
+	{
+		{ "manifest",                         "ml:package",      TiXmlColumnSpec::STRING, false },
+		{ "manifest",                         "ml:version_code", TiXmlColumnSpec::INT64,  false },
+		{ "manifest/application",             "ml:sdk_version",  TiXmlColumnSpec::STRING, false },
+		{ "manifest/application/component",   "ml:type",         TiXmlColumnSpec::STRING, true },
+		{ "manifest/application/uses-privilege", "ml:name",      TiXmlColumnSpec::STRING, true },
+	};
+
+	TiXmlColumnExtractor extractor( specs, 5 );
+	TiXmlColumnBatch batch;
+	extractor.ExtractFiles( &paths[0], paths.size(), &batch );
+
+	const TiXmlColumn& codes = batch.Column( 1 );
+	for ( size_t row=0; row<batch.Rows(); ++row )
+		if ( codes.Valid( row ) )
+			total += codes.Int64s()[row];
+	@endverbatim
+
+	Each document is read once with a TiXmlReader. The paths are compiled into
+	a tree up front, so an element costs one lookup among the names that can
+	follow its parent, and nothing at all below an element no path goes
+	through. A plain column keeps the last occurrence in a document, as
+	TiXmlBindRead() does.
+
+	The batch is shared out between threads a run of documents at a time.
+	Each run is extracted into columns of its own, and the runs are joined in
+	document order at the end, so the rows are in the order the documents
+	were given whatever the number of threads. The extractor itself is not
+	changed by extracting and can be used by several threads at once.
+*/
+class TiXmlColumnExtractor
+{
+public:
+	/// The columns to extract. The specs are copied; their strings must outlive the extractor.
+	TiXmlColumnExtractor( const TiXmlColumnSpec* specs, int count );
+
+	/** The options each document is read with, as TiXmlReader::SetParseOptions()
+		takes them. Set them before extracting, not while another thread is.
+	*/
+	void SetParseOptions( const TiXmlParseOptions& options )	{ parseOptions = options; }
+	const TiXmlParseOptions& ParseOptions() const				{ return parseOptions; }
+
+	/** Extract from 'count' null terminated documents in memory, one row
+		each, into 'batch' (replacing what it held). Up to 'threads' threads
+		are used, 0 for one per hardware thread. Returns true if every
+		document parsed; the ones that didn't are in the batch's Failures().
+	*/
+	bool ExtractBuffers( const char* const* xml, size_t count, TiXmlColumnBatch* batch, int threads = 0 ) const;
+	/// As ExtractBuffers(), reading each of 'count' files.
+	bool ExtractFiles( const char* const* filenames, size_t count, TiXmlColumnBatch* batch, int threads = 0 ) const;
+
+private:
+	struct Step
+	{
+		std::string name;
+		std::vector< int > children;	// steps that can follow this one
+		std::vector< int > attributes;	// columns read from an attribute of this element
+		std::vector< int > texts;		// columns read from the text of this element
+	};
+	struct Run;
+
+	bool Extract( const char* const* inputs, size_t count, bool files, TiXmlColumnBatch* batch, int threads ) const;
+	void ExtractRun( Run* run, const char* const* inputs, bool files, TiXmlReader* reader ) const;
+	bool ExtractDocument( TiXmlReader* reader, Run* run ) const;
+	int FindChild( int step, const char* name ) const;
+
+	static void Start( TiXmlColumnBatch* batch, const std::vector< TiXmlColumnSpec >& specs );
+	static void BeginRow( TiXmlColumnBatch* batch );
+	static void Store( TiXmlColumn* column, const char* value );
+	static void EndRow( TiXmlColumnBatch* batch );
+	static void FailRow( TiXmlColumnBatch* batch, const std::string& error );
+	static void Append( TiXmlColumnBatch* to, const TiXmlColumnBatch& from );
+
+	std::vector< TiXmlColumnSpec > specs;
+	std::vector< Step > steps;			// steps[0] is above the root element
+	TiXmlParseOptions parseOptions;
+};
+
+#endif
@@ -0,0 +1,415 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include <string.h>
+
+#include "tinyxmldiff.h"
+
+// How far ahead, in the other child list, a child that hasn't been lined up
+// by its hash looks for one of the same kind to be compared with.
+static const size_t TIXML_DIFF_WINDOW = 32;
+
+struct TiXmlDiff::Entry
+{
+	TiXmlDiffOp::Kind kind;		// DIFF_UPDATE for a pair still to be compared
+	const TiXmlNode* from;
+	const TiXmlNode* to;
+};
+
+struct TiXmlDiff::Slot
+{
+	unsigned long long hash;	// 0 when the slot is free
+	size_t countA;
+	size_t countB;
+	size_t indexA;
+	size_t indexB;
+};
+
+namespace {
+
+template< class T >
+void Reserve( T** buffer, size_t* capacity, size_t needed, size_t used )
+{
+	if ( needed <= *capacity )
+		return;
+	size_t grown = *capacity ? *capacity * 2 : 64;
+	if ( grown < needed )
+		grown = needed;
+	T* replacement = new T[ grown ];
+	for ( size_t i = 0; i < used; ++i )
+		replacement[i] = (*buffer)[i];
+	delete [] *buffer;
+	*buffer = replacement;
+	*capacity = grown;
+}
+
+// Nodes that can be compared with each other, rather than one replacing the other.
+bool Matches( const TiXmlNode* a, const TiXmlNode* b )
+{
+	if ( a->Type() != b->Type() )
+		return false;
+	return a->Type() != TiXmlNode::TINYXML_ELEMENT || strcmp( a->Value(), b->Value() ) == 0;
+}
+
+}
+
+
+TiXmlDiff::TiXmlDiff()
+	: handler( 0 ), reported( 0 ), compared( 0 ),
+	  stack( 0 ), stackSize( 0 ), stackCapacity( 0 ),
+	  nodes( 0 ), nodesCapacity( 0 ),
+	  indexes( 0 ), indexesCapacity( 0 ),
+	  slots( 0 ), slotsCapacity( 0 )
+{
+}
+
+
+TiXmlDiff::~TiXmlDiff()
+{
+	delete [] stack;
+	delete [] nodes;
+	delete [] indexes;
+	delete [] slots;
+}
+
+
+size_t TiXmlDiff::Compare( const TiXmlNode& from, const TiXmlNode& to, TiXmlDiffHandler* _handler )
+{
+	handler = _handler;
+	reported = 0;
+	compared = 0;
+	stackSize = 0;
+
+	if ( !Matches( &from, &to ) )
+	{
+		if ( Report( TiXmlDiffOp::DIFF_DELETE, &from, to.Parent() ) )
+			Report( TiXmlDiffOp::DIFF_INSERT, from.Parent(), &to );
+	}
+	else if ( from.Hash() != to.Hash() )
+	{
+		Push( TiXmlDiffOp::DIFF_UPDATE, &from, &to );
+	}
+
+	// Depth first, without recursion. A pair's children are pushed in
+	// reverse, so they come off the stack, and are reported, in order.
+	while ( stackSize )
+	{
+		Entry entry = stack[ --stackSize ];
+		if ( entry.kind != TiXmlDiffOp::DIFF_UPDATE )
+		{
+			if ( !Report( entry.kind, entry.from, entry.to ) )
+				break;
+			continue;
+		}
+
+		++compared;
+		if ( !ReportContent( entry.from, entry.to ) )
+			break;
+
+		size_t base = stackSize;
+		AlignChildren( entry.from, entry.to );
+		for ( size_t i = base, j = stackSize; i + 1 < j; ++i, --j )
+		{
+			Entry swap = stack[i];
+			stack[i] = stack[j-1];
+			stack[j-1] = swap;
+		}
+	}
+
+	stackSize = 0;
+	handler = 0;
+	return reported;
+}
+
+
+bool TiXmlDiff::Report( TiXmlDiffOp::Kind kind, const TiXmlNode* from, const TiXmlNode* to,
+						const char* name, const char* fromValue, const char* toValue )
+{
+	++reported;
+	if ( !handler )
+		return true;
+
+	TiXmlDiffOp op;
+	op.kind = kind;
+	op.from = from;
+	op.to = to;
+	op.name = name;
+	op.fromValue = fromValue;
+	op.toValue = toValue;
+	return handler->OnDiff( op );
+}
+
+
+bool TiXmlDiff::ReportContent( const TiXmlNode* from, const TiXmlNode* to )
+{
+	switch ( from->Type() )
+	{
+		case TiXmlNode::TINYXML_DOCUMENT:
+			return true;
+
+		case TiXmlNode::TINYXML_ELEMENT:
+		{
+			const TiXmlElement* a = from->ToElement();
+			const TiXmlElement* b = to->ToElement();
+			for ( const TiXmlAttribute* attribute = a->FirstAttribute(); attribute; attribute = attribute->Next() )
+			{
+				const char* value = b->Attribute( attribute->Name() );
+				if ( !value || strcmp( value, attribute->Value() ) != 0 )
+				{
+					if ( !Report( TiXmlDiffOp::DIFF_ATTRIBUTE, from, to, attribute->Name(), attribute->Value(), value ) )
+						return false;
+				}
+			}
+			for ( const TiXmlAttribute* attribute = b->FirstAttribute(); attribute; attribute = attribute->Next() )
+			{
+				if ( !a->Attribute( attribute->Name() ) )
+				{
+					if ( !Report( TiXmlDiffOp::DIFF_ATTRIBUTE, from, to, attribute->Name(), 0, attribute->Value() ) )
+						return false;
+				}
+			}
+			return true;
+		}
+
+		case TiXmlNode::TINYXML_DECLARATION:
+		{
+			const TiXmlDeclaration* a = from->ToDeclaration();
+			const TiXmlDeclaration* b = to->ToDeclaration();
+			if (    strcmp( a->Version(), b->Version() ) == 0
+				 && strcmp( a->Encoding(), b->Encoding() ) == 0
+				 && strcmp( a->Standalone(), b->Standalone() ) == 0 )
+				return true;
+			return Report( TiXmlDiffOp::DIFF_UPDATE, from, to );
+		}
+
+		case TiXmlNode::TINYXML_TEXT:
+			if ( from->ToText()->CDATA() != to->ToText()->CDATA() )
+				return Report( TiXmlDiffOp::DIFF_UPDATE, from, to );
+			// fall through
+
+		default:
+			if ( strcmp( from->Value(), to->Value() ) == 0 )
+				return true;
+			return Report( TiXmlDiffOp::DIFF_UPDATE, from, to );
+	}
+}
+
+
+void TiXmlDiff::AlignChildren( const TiXmlNode* from, const TiXmlNode* to )
+{
+	// Skip the children that are the same at the start and at the end, on
+	// the lists themselves, so that a change in a long list of children
+	// only costs a walk up to it.
+	const TiXmlNode* aFirst = from->FirstChild();
+	const TiXmlNode* bFirst = to->FirstChild();
+	while ( aFirst && bFirst && aFirst->Hash() == bFirst->Hash() )
+	{
+		aFirst = aFirst->NextSibling();
+		bFirst = bFirst->NextSibling();
+	}
+
+	const TiXmlNode* aLast = aFirst ? from->LastChild() : 0;
+	const TiXmlNode* bLast = bFirst ? to->LastChild() : 0;
+	while ( aLast && bLast && aLast->Hash() == bLast->Hash() )
+	{
+		if ( aLast == aFirst )
+			aFirst = aLast = 0;
+		else
+			aLast = aLast->PreviousSibling();
+		if ( bLast == bFirst )
+			bFirst = bLast = 0;
+		else
+			bLast = bLast->PreviousSibling();
+	}
+
+	size_t n = 0;
+	for ( const TiXmlNode* node = aFirst; node; node = node == aLast ? 0 : node->NextSibling() )
+	{
+		Reserve( &nodes, &nodesCapacity, n + 1, n );
+		nodes[n++] = node;
+	}
+	size_t m = 0;
+	for ( const TiXmlNode* node = bFirst; node; node = node == bLast ? 0 : node->NextSibling() )
+	{
+		Reserve( &nodes, &nodesCapacity, n + m + 1, n + m );
+		nodes[n + m++] = node;
+	}
+
+	if ( n > 1 && m > 1 && n + m > TIXML_DIFF_WINDOW )
+		AlignMiddle( from, to, n, m );
+	else
+		AlignGap( from, to, nodes, n, nodes + n, m );
+}
+
+
+void TiXmlDiff::AlignMiddle( const TiXmlNode* from, const TiXmlNode* to, size_t n, size_t m )
+{
+	const TiXmlNode* const* a = nodes;
+	const TiXmlNode* const* b = nodes + n;
+
+	// Count the hashes on each side. Children whose hash is unique on both
+	// sides are anchors: they can only go with each other.
+	size_t size = 64;
+	while ( size < 2 * ( n + m ) )
+		size *= 2;
+	Reserve( &slots, &slotsCapacity, size, 0 );
+	memset( slots, 0, size * sizeof( Slot ) );
+
+	for ( size_t k = 0; k < n + m; ++k )
+	{
+		const unsigned long long hash = nodes[k]->Hash();
+		size_t i = (size_t)( hash ^ ( hash >> 32 ) ) & ( size - 1 );
+		while ( slots[i].hash && slots[i].hash != hash )
+			i = ( i + 1 ) & ( size - 1 );
+		slots[i].hash = hash;
+		if ( k < n )
+		{
+			++slots[i].countA;
+			slots[i].indexA = k;
+		}
+		else
+		{
+			++slots[i].countB;
+			slots[i].indexB = k - n;
+		}
+	}
+
+	const size_t most = n < m ? n : m;
+	Reserve( &indexes, &indexesCapacity, 4 * most, 0 );
+	size_t* anchorA = indexes;
+	size_t* anchorB = indexes + most;
+	size_t* tails = indexes + 2 * most;
+	size_t* previous = indexes + 3 * most;
+
+	size_t anchors = 0;
+	for ( size_t k = 0; k < n; ++k )
+	{
+		const unsigned long long hash = a[k]->Hash();
+		size_t i = (size_t)( hash ^ ( hash >> 32 ) ) & ( size - 1 );
+		while ( slots[i].hash != hash )
+			i = ( i + 1 ) & ( size - 1 );
+		if ( slots[i].countA == 1 && slots[i].countB == 1 )
+		{
+			anchorA[anchors] = k;
+			anchorB[anchors] = slots[i].indexB;
+			++anchors;
+		}
+	}
+
+	// The anchors are in order in the first list; keep the longest run of
+	// them that is also in order in the second.
+	size_t length = 0;
+	for ( size_t k = 0; k < anchors; ++k )
+	{
+		size_t low = 0;
+		size_t high = length;
+		while ( low < high )
+		{
+			size_t middle = ( low + high ) / 2;
+			if ( anchorB[ tails[middle] ] < anchorB[k] )
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		previous[k] = low ? tails[low - 1] : 0;
+		tails[low] = k;
+		if ( low == length )
+			++length;
+	}
+	for ( size_t k = length, anchor = length ? tails[length - 1] : 0; k > 0; --k )
+	{
+		tails[k - 1] = anchor;
+		anchor = previous[anchor];
+	}
+
+	// Anchors hash the same, so only the gaps between them are left.
+	size_t i = 0;
+	size_t j = 0;
+	for ( size_t k = 0; k < length; ++k )
+	{
+		const size_t anchor = tails[k];
+		AlignGap( from, to, a + i, anchorA[anchor] - i, b + j, anchorB[anchor] - j );
+		i = anchorA[anchor] + 1;
+		j = anchorB[anchor] + 1;
+	}
+	AlignGap( from, to, a + i, n - i, b + j, m - j );
+}
+
+
+void TiXmlDiff::AlignGap( const TiXmlNode* from, const TiXmlNode* to, const TiXmlNode* const* a, size_t n, const TiXmlNode* const* b, size_t m )
+{
+	while ( n && m && a[0]->Hash() == b[0]->Hash() )
+	{
+		++a;
+		++b;
+		--n;
+		--m;
+	}
+	while ( n && m && a[n - 1]->Hash() == b[m - 1]->Hash() )
+	{
+		--n;
+		--m;
+	}
+
+	// Each child of the first list goes with the next one ahead in the
+	// second that is the same, or failing that of the same kind; what is
+	// passed over in the second was inserted.
+	size_t j = 0;
+	for ( size_t i = 0; i < n; ++i )
+	{
+		const size_t limit = m - j > TIXML_DIFF_WINDOW ? j + TIXML_DIFF_WINDOW : m;
+		const unsigned long long hash = a[i]->Hash();
+		size_t k = j;
+		while ( k < limit && b[k]->Hash() != hash )
+			++k;
+		if ( k == limit )
+		{
+			k = j;
+			while ( k < limit && !Matches( a[i], b[k] ) )
+				++k;
+		}
+		if ( k == limit )
+		{
+			Push( TiXmlDiffOp::DIFF_DELETE, a[i], to );
+			continue;
+		}
+		for ( ; j < k; ++j )
+			Push( TiXmlDiffOp::DIFF_INSERT, from, b[j] );
+		if ( b[k]->Hash() != hash )
+			Push( TiXmlDiffOp::DIFF_UPDATE, a[i], b[k] );
+		j = k + 1;
+	}
+	for ( ; j < m; ++j )
+		Push( TiXmlDiffOp::DIFF_INSERT, from, b[j] );
+}
+
+
+void TiXmlDiff::Push( TiXmlDiffOp::Kind kind, const TiXmlNode* from, const TiXmlNode* to )
+{
+	Reserve( &stack, &stackCapacity, stackSize + 1, stackSize );
+	Entry& entry = stack[ stackSize++ ];
+	entry.kind = kind;
+	entry.from = from;
+	entry.to = to;
+}
@@ -0,0 +1,145 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+
+#ifndef TINYXML_DIFF_INCLUDED
+#define TINYXML_DIFF_INCLUDED
+
+#include "tinyxml.h"
+
+/** One difference found by TiXmlDiff, from the first document to the second.
+
+	- DIFF_INSERT: 'to' is a node of the second document that has nothing
+	  matching it in the first; 'from' is the node of the first document it
+	  goes under.
+	- DIFF_DELETE: 'from' is a node of the first document that has nothing
+	  matching it in the second; 'to' is the node of the second document it
+	  was under.
+	- DIFF_UPDATE: 'from' and 'to' are the same kind of node, but the text,
+	  comment, unknown or declaration content differs.
+	- DIFF_ATTRIBUTE: 'from' and 'to' are elements whose attribute 'name'
+	  differs. 'fromValue' is null if the attribute was added, 'toValue' if
+	  it was removed.
+
+	The pointers are only good for as long as the documents are unchanged.
+*/
+struct TiXmlDiffOp
+{
+	enum Kind
+	{
+		DIFF_INSERT,
+		DIFF_DELETE,
+		DIFF_UPDATE,
+		DIFF_ATTRIBUTE
+	};
+
+	Kind kind;
+	const TiXmlNode* from;
+	const TiXmlNode* to;
+	const char* name;
+	const char* fromValue;
+	const char* toValue;
+};
+
+/// Receives the differences found by TiXmlDiff::Compare(), in document order.
+class TiXmlDiffHandler
+{
+public:
+	virtual ~TiXmlDiffHandler() {}
+
+	/// Return false to stop the comparison.
+	virtual bool OnDiff( const TiXmlDiffOp& op ) = 0;
+};
+
+/**	Finds the differences between two documents, or two subtrees, using
+	TiXmlNode::Hash(). Subtrees that hash the same are skipped without being
+	looked at, so the work done depends on what has changed and where, not
+	on the size of the documents: two large documents that differ in one
+	element are compared by walking down the one path to it, and along the
+	child lists on the way, as far as the change from either end.
+
+	@verbatim
+	TiXmlDiff diff;
+	size_t changes = diff.Compare( oldDoc, newDoc, &handler );
+	@endverbatim
+
+	The children of two matched nodes are lined up by their hashes: first
+	the runs that are the same at either end, then the children whose hash
+	is unique in both lists, and whatever is left between those by kind
+	(node type, and name for elements), looking a short way ahead. Two
+	children lined up but not the same are compared in turn; the rest are
+	reported as inserted or deleted. That gives a good answer for the usual
+	edits, but not always the smallest one: a moved node, for one, shows up
+	as a delete and an insert.
+
+	Hashes that haven't been worked out yet are, the first time, which means
+	a walk over each document (see TiXmlParseOptions::hashNodes). A TiXmlDiff
+	keeps its working storage from one Compare() to the next.
+*/
+class TiXmlDiff
+{
+public:
+	TiXmlDiff();
+	~TiXmlDiff();
+
+	/** Report the differences from 'from' to 'to' to 'handler', which may be
+		null to just count them. Returns the number of differences reported.
+	*/
+	size_t Compare( const TiXmlNode& from, const TiXmlNode& to, TiXmlDiffHandler* handler );
+
+	/// The number of node pairs the last Compare() had to look into.
+	size_t Compared() const		{ return compared; }
+
+private:
+	TiXmlDiff( const TiXmlDiff& );				// not implemented.
+	void operator=( const TiXmlDiff& );			// not implemented.
+
+	struct Entry;
+	struct Slot;
+
+	bool Report( TiXmlDiffOp::Kind kind, const TiXmlNode* from, const TiXmlNode* to,
+				 const char* name = 0, const char* fromValue = 0, const char* toValue = 0 );
+	bool ReportContent( const TiXmlNode* from, const TiXmlNode* to );
+	void AlignChildren( const TiXmlNode* from, const TiXmlNode* to );
+	void AlignMiddle( const TiXmlNode* from, const TiXmlNode* to, size_t n, size_t m );
+	void AlignGap( const TiXmlNode* from, const TiXmlNode* to, const TiXmlNode* const* a, size_t n, const TiXmlNode* const* b, size_t m );
+	void Push( TiXmlDiffOp::Kind kind, const TiXmlNode* from, const TiXmlNode* to );
+
+	TiXmlDiffHandler* handler;
+	size_t reported;
+	size_t compared;
+
+	Entry* stack;			// pairs still to compare, nodes still to report; last first
+	size_t stackSize;
+	size_t stackCapacity;
+	const TiXmlNode** nodes;	// the unmatched middles of the two child lists
+	size_t nodesCapacity;
+	size_t* indexes;		// anchors, and the longest run of them in order
+	size_t indexesCapacity;
+	Slot* slots;			// hash table of the middles' child hashes
+	size_t slotsCapacity;
+};
+
+#endif
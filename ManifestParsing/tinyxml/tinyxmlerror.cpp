@@ -49,4 +49,10 @@ const char* TiXmlBase::errorString[ TiXmlBase::TIXML_ERROR_STRING_COUNT ] =
 	"Error null (0) or unexpected EOF found in input stream.",
 	"Error parsing CDATA.",
 	"Error when TiXmlDocument added to document, because TiXmlDocument can only be at the root.",
+	"Error: elements nested deeper than the maximum depth.",
+	"Error document larger than the maximum size.",
+	"Error document needs more memory than its budget.",
+	"Error document is not valid UTF-8.",
+	"Error decompressing the document.",
+	"Error undeclared namespace prefix.",
 };
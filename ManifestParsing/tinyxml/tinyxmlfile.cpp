@@ -0,0 +1,92 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+#include "tinyxmlfile.h"
+
+#ifdef TIXML_FILE_POSIX
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+void TiXmlStampFile( const struct stat& source, TiXmlFileStamp* stamp )
+{
+	stamp->inode = (TiXmlU64)source.st_ino;
+	stamp->size = (TiXmlU64)source.st_size;
+	stamp->mtime = (long long)source.st_mtime;
+	#if defined( __APPLE__ )
+	stamp->mtimeNsec = source.st_mtimespec.tv_nsec;
+	#else
+	stamp->mtimeNsec = source.st_mtim.tv_nsec;
+	#endif
+}
+
+
+bool TiXmlReplaceFile( const char* path, const char* data, size_t length )
+{
+	const size_t pathLength = strlen( path );
+	char* temporary = new char[ pathLength + 8 ];
+	memcpy( temporary, path, pathLength );
+	memcpy( temporary + pathLength, ".XXXXXX", 8 );
+
+	int fd = mkstemp( temporary );
+	if ( fd < 0 )
+	{
+		delete [] temporary;
+		return false;
+	}
+	fchmod( fd, 0644 );
+
+	int failure = 0;
+	while ( length && !failure )
+	{
+		ssize_t written = write( fd, data, length );
+		if ( written < 0 )
+			failure = errno;
+		else if ( written == 0 )
+			failure = EIO;
+		else
+		{
+			data += written;
+			length -= (size_t)written;
+		}
+	}
+	if ( close( fd ) != 0 && !failure )
+		failure = errno;
+	if ( !failure && rename( temporary, path ) != 0 )
+		failure = errno;
+	if ( failure )
+		unlink( temporary );
+	delete [] temporary;
+	errno = failure;
+	return !failure;
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+
+#ifndef TINYXML_FILE_INCLUDED
+#define TINYXML_FILE_INCLUDED
+
+#include <stddef.h>
+
+/*	What the files TinyXML writes for itself share: TiXmlDocumentCache's
+	images and TiXmlOffsetIndex's indexes. Not part of the API.
+*/
+
+typedef unsigned long long TiXmlU64;
+typedef unsigned int TiXmlU32;
+
+// MurmurHash64A of 'length' bytes; defined in tinyxml.cpp.
+unsigned long long TiXmlHashBytes( const unsigned char* data, size_t length );
+
+// What tells one version of a file from another, as a cache image or an
+// index records it. There is no padding, so it can be written as it is.
+struct TiXmlFileStamp
+{
+	TiXmlU64 inode;
+	TiXmlU64 size;
+	long long mtime;
+	long long mtimeNsec;
+
+	bool Same( const TiXmlFileStamp& other ) const
+	{
+		return inode == other.inode && size == other.size && mtime == other.mtime && mtimeNsec == other.mtimeNsec;
+	}
+};
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#define TIXML_FILE_POSIX
+
+struct stat;
+
+void TiXmlStampFile( const struct stat& source, TiXmlFileStamp* stamp );
+
+// Write 'length' bytes to a private temporary next to 'path' and rename it
+// over 'path', so a reader sees the old file or the new one and never part
+// of one. mkstemp() gives every writer its own temporary, threads of one
+// process included. Returns false with errno set, and no temporary left.
+bool TiXmlReplaceFile( const char* path, const char* data, size_t length );
+
+#endif
+
+#endif
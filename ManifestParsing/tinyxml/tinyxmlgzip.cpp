@@ -0,0 +1,267 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+// Reading and writing gzip through zlib, for TiXmlDocument::LoadFile() and
+// SaveFile(). Built only with TIXML_USE_ZLIB.
+
+#ifdef TIXML_USE_ZLIB
+
+#include <string.h>
+#include <zlib.h>
+
+#include "tinyxml.h"
+
+// Compressed bytes are read, and written, this many at a time.
+static const size_t TIXML_GZIP_CHUNK = 16384;
+
+// Inflates the gzip or zlib stream 'file' holds, 'fileLength' bytes, into a
+// new[]'d buffer with a byte to spare for the null. The text is inflated
+// straight into that buffer a chunk of the file at a time. A gzip file
+// records the size of its text in its last four bytes, so for the usual
+// file of one member the buffer is allocated once, at its final size; for
+// a zlib stream, or a gzip file that misstates it, the buffer starts at a
+// guess and doubles. Gzip members following the first are inflated too, as
+// gunzip does. Returns null and sets errorId if the stream is damaged or
+// cut short, or its text is empty or longer than maxBytes (if not 0).
+char* TiXmlInflateFile( FILE* file, long fileLength, size_t maxBytes, long* _length, int* errorId )
+{
+	size_t capacity = 0;
+	unsigned char trailer[4];
+	unsigned char magic[2];
+	if (    fileLength >= 18
+		 && fread( magic, 2, 1, file ) == 1 && magic[0] == 0x1f && magic[1] == 0x8b
+		 && fseek( file, fileLength - 4, SEEK_SET ) == 0
+		 && fread( trailer, 4, 1, file ) == 1 )
+	{
+		capacity =   (size_t)trailer[0]
+				   | (size_t)trailer[1] << 8
+				   | (size_t)trailer[2] << 16
+				   | (size_t)trailer[3] << 24;
+	}
+	fseek( file, 0, SEEK_SET );
+	// Deflate can't shrink text more than about 1032 to 1, so a bigger
+	// size is a damaged file, not something to allocate.
+	if ( capacity / 1032 > (size_t)fileLength )
+		capacity = 0;
+
+	// The text is at least as long as the last member says, so a file that
+	// says too much can be refused before anything is allocated.
+	if ( maxBytes && capacity > maxBytes )
+	{
+		*errorId = TiXmlBase::TIXML_ERROR_DOCUMENT_TOO_LARGE;
+		return 0;
+	}
+	if ( capacity == 0 )
+		capacity = (size_t)fileLength * 4;
+	// The buffer has room for the null too, and zlib may use it: with the
+	// right size in hand the stream can then finish without the buffer
+	// growing. One byte past the limit is enough to tell the text is over it.
+	size_t size = capacity + 1;
+	if ( maxBytes && size > maxBytes + 1 )
+		size = maxBytes + 1;
+
+	z_stream stream;
+	memset( &stream, 0, sizeof( stream ) );
+	// 15 + 32: the largest window, and take either a gzip or a zlib header.
+	if ( inflateInit2( &stream, 15 + 32 ) != Z_OK )
+	{
+		*errorId = TiXmlBase::TIXML_ERROR_DECOMPRESSING;
+		return 0;
+	}
+
+	unsigned char in[ TIXML_GZIP_CHUNK ];
+	char* buf = new char[ size ];
+	size_t have = 0;
+	bool ended = false;
+	int error = TiXmlBase::TIXML_NO_ERROR;
+
+	while ( !ended && !error )
+	{
+		if ( stream.avail_in == 0 )
+		{
+			stream.next_in = in;
+			stream.avail_in = (uInt)fread( in, 1, sizeof( in ), file );
+			if ( stream.avail_in == 0 )
+			{
+				// The file ran out before the stream did.
+				error = TiXmlBase::TIXML_ERROR_DECOMPRESSING;
+				break;
+			}
+		}
+		if ( maxBytes && have > maxBytes )
+		{
+			error = TiXmlBase::TIXML_ERROR_DOCUMENT_TOO_LARGE;
+			break;
+		}
+		if ( have == size )
+		{
+			size_t grown = size * 2;
+			if ( maxBytes && grown > maxBytes + 1 )
+				grown = maxBytes + 1;
+			char* larger = new char[ grown ];
+			memcpy( larger, buf, have );
+			delete [] buf;
+			buf = larger;
+			size = grown;
+		}
+
+		size_t room = size - have;
+		if ( room > 0x40000000 )
+			room = 0x40000000;
+		stream.next_out = (Bytef*)( buf + have );
+		stream.avail_out = (uInt)room;
+		const int status = inflate( &stream, Z_NO_FLUSH );
+		have += room - stream.avail_out;
+
+		if ( status == Z_STREAM_END )
+		{
+			// Another gzip member may follow; anything else after the
+			// stream is ignored.
+			if ( stream.avail_in == 0 )
+			{
+				stream.next_in = in;
+				stream.avail_in = (uInt)fread( in, 1, sizeof( in ), file );
+			}
+			if ( stream.avail_in > 0 && stream.next_in[0] == 0x1f )
+				inflateReset( &stream );
+			else
+				ended = true;
+		}
+		else if ( status != Z_OK && status != Z_BUF_ERROR )
+		{
+			error = TiXmlBase::TIXML_ERROR_DECOMPRESSING;
+		}
+	}
+	inflateEnd( &stream );
+
+	if ( !error && have == 0 )
+		error = TiXmlBase::TIXML_ERROR_DOCUMENT_EMPTY;
+	if ( !error && maxBytes && have > maxBytes )
+		error = TiXmlBase::TIXML_ERROR_DOCUMENT_TOO_LARGE;
+	if ( error )
+	{
+		delete [] buf;
+		*errorId = error;
+		return 0;
+	}
+	if ( have == size )
+	{
+		// The text filled the buffer exactly; make room for the null.
+		char* larger = new char[ size + 1 ];
+		memcpy( larger, buf, have );
+		delete [] buf;
+		buf = larger;
+	}
+	buf[ have ] = 0;
+	*_length = (long)have;
+	return buf;
+}
+
+
+// Compresses what a TiXmlPrinter prints into a gzip file, a chunk at a time.
+class TiXmlGzipSink : public TiXmlPrintSink
+{
+public:
+	TiXmlGzipSink( FILE* _file ) : file( _file ), open( false )
+	{
+		memset( &stream, 0, sizeof( stream ) );
+	}
+	~TiXmlGzipSink()
+	{
+		if ( open )
+			deflateEnd( &stream );
+	}
+
+	bool Open( int level )
+	{
+		// 15 + 16: the largest window, with a gzip header and trailer.
+		open = deflateInit2( &stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) == Z_OK;
+		return open;
+	}
+
+	virtual bool Write( const char* data, size_t length )
+	{
+		while ( length > 0 )
+		{
+			const size_t piece = length < 0x40000000 ? length : 0x40000000;
+			if ( !Deflate( data, piece, Z_NO_FLUSH ) )
+				return false;
+			data += piece;
+			length -= piece;
+		}
+		return true;
+	}
+
+	// Write out the rest of the stream and the gzip trailer.
+	bool Finish()	{ return Deflate( 0, 0, Z_FINISH ); }
+
+private:
+	bool Deflate( const char* data, size_t length, int flush )
+	{
+		stream.next_in = (Bytef*)data;
+		stream.avail_in = (uInt)length;
+		do
+		{
+			stream.next_out = out;
+			stream.avail_out = sizeof( out );
+			if ( deflate( &stream, flush ) == Z_STREAM_ERROR )
+				return false;
+			const size_t produced = sizeof( out ) - stream.avail_out;
+			if ( produced && fwrite( out, produced, 1, file ) != 1 )
+				return false;
+		}
+		while ( stream.avail_out == 0 );
+		return true;
+	}
+
+	FILE* file;
+	bool open;
+	z_stream stream;
+	unsigned char out[ TIXML_GZIP_CHUNK ];
+};
+
+
+// Prints 'document' to 'file' as gzip at zlib's 'level', with the UTF-8 BOM
+// first if 'bom'. The text goes to zlib as it is printed.
+bool TiXmlDeflateDocument( const TiXmlDocument& document, bool bom, FILE* file, int level )
+{
+	TiXmlGzipSink sink( file );
+	if ( !sink.Open( level ) )
+		return false;
+
+	if ( bom )
+	{
+		const char utf8Bom[] = { (char)0xef, (char)0xbb, (char)0xbf };
+		if ( !sink.Write( utf8Bom, 3 ) )
+			return false;
+	}
+
+	TiXmlPrinter printer;
+	printer.SetSink( &sink, TIXML_GZIP_CHUNK );
+	if ( !document.Accept( &printer ) )
+		return false;
+	return sink.Finish() && ferror( file ) == 0;
+}
+
+#endif
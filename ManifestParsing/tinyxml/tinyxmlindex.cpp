@@ -0,0 +1,395 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include <string.h>
+
+#include "tinyxmlindex.h"
+
+#ifdef TIXML_USE_STL
+
+#include <algorithm>
+#include <vector>
+
+#include "tinyxmlfile.h"
+#include "tinyxmlreader.h"
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#define TIXML_INDEX_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+// The index is a header, the key attribute's name padded to 8 bytes, and
+// the entries sorted by hash, then by offset so a shared key finds its
+// first record. Everything is in the machine's own byte order.
+
+struct TiXmlOffsetIndex::Entry
+{
+	TiXmlU64 hash;			// of the key attribute's value
+	TiXmlU64 offset;		// of the element's '<'
+	TiXmlU64 length;		// up to and including its end tag
+};
+
+namespace {
+
+const char indexMagic[4] = { 'T', 'X', 'I', '1' };
+
+struct IndexHeader
+{
+	char magic[4];
+	TiXmlU32 depth;
+	TiXmlFileStamp stamp;	// of the file, when the index was built
+	TiXmlU64 records;
+	TiXmlU32 encoding;		// the encoding the file was read in
+	TiXmlU32 keyLength;
+};
+
+TiXmlU64 KeyHash( const char* value )
+{
+	return TiXmlHashBytes( reinterpret_cast< const unsigned char* >( value ), strlen( value ) );
+}
+
+void Fail( std::string* error, const char* file, const char* why )
+{
+	if ( error )
+	{
+		*error = file;
+		*error += ": ";
+		*error += why;
+	}
+}
+
+#ifdef TIXML_INDEX_MMAP
+
+// Map 'size' bytes of 'fd' followed by at least one zero byte, so the text
+// can be read as a null terminated string. The file is mapped over the
+// start of an anonymous mapping: past the end of the file's last page the
+// pages are the anonymous mapping's own, and read as zeros.
+const char* MapText( int fd, size_t size, size_t* mapped )
+{
+	const size_t page = (size_t)sysconf( _SC_PAGESIZE );
+	const size_t total = ( size + 1 + page - 1 ) / page * page;
+	void* base = mmap( 0, total, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if ( base == MAP_FAILED )
+		return 0;
+	if ( size && mmap( base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0 ) == MAP_FAILED )
+	{
+		munmap( base, total );
+		return 0;
+	}
+	*mapped = total;
+	return static_cast< const char* >( base );
+}
+
+#endif
+
+}
+
+
+TiXmlOffsetIndex::TiXmlOffsetIndex()
+	: text( 0 ), textBytes( 0 ), textMapped( 0 ), image( 0 ), imageBytes( 0 ),
+	  entries( 0 ), records( 0 ), depth( 0 ), encoding( TIXML_DEFAULT_ENCODING )
+{
+}
+
+
+TiXmlOffsetIndex::~TiXmlOffsetIndex()
+{
+	Close();
+}
+
+
+bool TiXmlOffsetIndex::Build(	const char* xmlFile, const char* indexFile, int depth, const char* key,
+								std::string* error, const TiXmlParseOptions& options )
+{
+#ifdef TIXML_INDEX_MMAP
+	if ( depth < 1 || !key || !*key )
+	{
+		Fail( error, indexFile, "no depth or key attribute to index by" );
+		return false;
+	}
+
+	int fd = open( xmlFile, O_RDONLY );
+	struct stat source;
+	if ( fd < 0 || fstat( fd, &source ) != 0 )
+	{
+		Fail( error, xmlFile, strerror( errno ) );
+		if ( fd >= 0 )
+			close( fd );
+		return false;
+	}
+	size_t mapped = 0;
+	const char* text = MapText( fd, (size_t)source.st_size, &mapped );
+	close( fd );
+	if ( !text )
+	{
+		Fail( error, xmlFile, strerror( errno ) );
+		return false;
+	}
+	madvise( const_cast< char* >( text ), mapped, MADV_SEQUENTIAL );
+
+	// An element at 'depth' opens a record if it has the key; the record
+	// closes with the end tag that brings the reader back out of it.
+	std::vector< Entry > entries;
+	Entry record = { 0, 0, 0 };
+	bool inRecord = false;
+	TiXmlReader reader( text, options );
+	TiXmlReader::Token token;
+	while (    ( token = reader.Next() ) != TiXmlReader::TOKEN_END_DOCUMENT
+			&& token != TiXmlReader::TOKEN_ERROR )
+	{
+		if ( token == TiXmlReader::TOKEN_START_ELEMENT && reader.Depth() == depth )
+		{
+			const char* value = reader.Attribute( key );
+			inRecord = value != 0;
+			if ( inRecord )
+			{
+				record.hash = KeyHash( value );
+				record.offset = (TiXmlU64)( reader.TokenStart() - text );
+			}
+		}
+		else if ( token == TiXmlReader::TOKEN_END_ELEMENT && reader.Depth() == depth - 1 && inRecord )
+		{
+			record.length = (TiXmlU64)( reader.Position() - text ) - record.offset;
+			entries.push_back( record );
+			inRecord = false;
+		}
+	}
+
+	if ( token == TiXmlReader::TOKEN_ERROR )
+	{
+		char where[64];
+		TIXML_SNPRINTF( where, sizeof( where ), " (row %d, column %d)", reader.ErrorRow(), reader.ErrorCol() );
+		Fail( error, xmlFile, ( std::string( reader.ErrorDesc() ) + where ).c_str() );
+		munmap( const_cast< char* >( text ), mapped );
+		return false;
+	}
+	const TiXmlEncoding encoding = reader.Encoding();
+	munmap( const_cast< char* >( text ), mapped );
+
+	std::sort( entries.begin(), entries.end(), []( const Entry& a, const Entry& b ) {
+		return a.hash < b.hash || ( a.hash == b.hash && a.offset < b.offset );
+	} );
+
+	IndexHeader header;
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, indexMagic, sizeof( indexMagic ) );
+	header.depth = (TiXmlU32)depth;
+	TiXmlStampFile( source, &header.stamp );
+	header.records = entries.size();
+	header.encoding = (TiXmlU32)encoding;
+	header.keyLength = (TiXmlU32)strlen( key );
+
+	std::string out( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+	out.append( key, header.keyLength );
+	out.append( ( 8 - out.length() % 8 ) % 8, '\0' );
+	if ( !entries.empty() )
+		out.append( reinterpret_cast< const char* >( &entries[0] ), entries.size() * sizeof( Entry ) );
+
+	if ( !TiXmlReplaceFile( indexFile, out.data(), out.length() ) )
+	{
+		Fail( error, indexFile, strerror( errno ) );
+		return false;
+	}
+	return true;
+#else
+	(void)xmlFile;
+	(void)depth;
+	(void)key;
+	Fail( error, indexFile, "memory mapping isn't available" );
+	return false;
+#endif
+}
+
+
+bool TiXmlOffsetIndex::Open( const char* xmlFile, const char* indexFile, std::string* error )
+{
+	Close();
+#ifdef TIXML_INDEX_MMAP
+	int fd = open( indexFile, O_RDONLY );
+	struct stat stats;
+	if ( fd < 0 || fstat( fd, &stats ) != 0 )
+	{
+		Fail( error, indexFile, strerror( errno ) );
+		if ( fd >= 0 )
+			close( fd );
+		return false;
+	}
+	if ( (size_t)stats.st_size < sizeof( IndexHeader ) )
+	{
+		close( fd );
+		Fail( error, indexFile, "not an index" );
+		return false;
+	}
+	void* mappedIndex = mmap( 0, (size_t)stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( mappedIndex == MAP_FAILED )
+	{
+		Fail( error, indexFile, strerror( errno ) );
+		return false;
+	}
+	image = static_cast< const char* >( mappedIndex );
+	imageBytes = (size_t)stats.st_size;
+
+	IndexHeader header;
+	memcpy( &header, image, sizeof( header ) );
+	const size_t keyEnd = sizeof( header ) + header.keyLength;
+	const size_t entriesAt = ( keyEnd + 7 ) / 8 * 8;
+	if (    memcmp( header.magic, indexMagic, sizeof( indexMagic ) ) != 0
+		 || header.keyLength > imageBytes
+		 || entriesAt > imageBytes
+		 || header.records != ( imageBytes - entriesAt ) / sizeof( Entry )
+		 || ( imageBytes - entriesAt ) % sizeof( Entry ) != 0 )
+	{
+		Close();
+		Fail( error, indexFile, "not an index" );
+		return false;
+	}
+
+	fd = open( xmlFile, O_RDONLY );
+	if ( fd < 0 || fstat( fd, &stats ) != 0 )
+	{
+		Fail( error, xmlFile, strerror( errno ) );
+		if ( fd >= 0 )
+			close( fd );
+		Close();
+		return false;
+	}
+	TiXmlFileStamp now;
+	TiXmlStampFile( stats, &now );
+	if ( !now.Same( header.stamp ) )
+	{
+		close( fd );
+		Close();
+		Fail( error, indexFile, "built from a different version of the file" );
+		return false;
+	}
+	text = MapText( fd, (size_t)stats.st_size, &textMapped );
+	close( fd );
+	if ( !text )
+	{
+		Fail( error, xmlFile, strerror( errno ) );
+		Close();
+		return false;
+	}
+	// Lookups land anywhere; reading ahead would only waste the cache.
+	madvise( const_cast< char* >( text ), textMapped, MADV_RANDOM );
+
+	textBytes = (size_t)stats.st_size;
+	entries = reinterpret_cast< const Entry* >( image + entriesAt );
+	records = (size_t)header.records;
+	depth = (int)header.depth;
+	encoding = (TiXmlEncoding)header.encoding;
+	key.assign( image + sizeof( header ), header.keyLength );
+	return true;
+#else
+	(void)xmlFile;
+	Fail( error, indexFile, "memory mapping isn't available" );
+	return false;
+#endif
+}
+
+
+void TiXmlOffsetIndex::Close()
+{
+#ifdef TIXML_INDEX_MMAP
+	if ( text )
+		munmap( const_cast< char* >( text ), textMapped );
+	if ( image )
+		munmap( const_cast< char* >( image ), imageBytes );
+#endif
+	text = 0;
+	textBytes = textMapped = 0;
+	image = 0;
+	imageBytes = 0;
+	entries = 0;
+	records = 0;
+	depth = 0;
+	key.clear();
+}
+
+
+const TiXmlOffsetIndex::Entry* TiXmlOffsetIndex::Lower( const char* value ) const
+{
+	if ( !entries || !value )
+		return 0;
+	const TiXmlU64 hash = KeyHash( value );
+	size_t low = 0;
+	size_t high = records;
+	while ( low < high )
+	{
+		const size_t mid = low + ( high - low ) / 2;
+		if ( entries[mid].hash < hash )
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return ( low < records && entries[low].hash == hash ) ? entries + low : 0;
+}
+
+
+bool TiXmlOffsetIndex::Locate( const char* value, const char** start, size_t* length ) const
+{
+	const Entry* entry = Lower( value );
+	if ( !entry || entry->offset > textBytes || entry->length > textBytes - entry->offset )
+		return false;
+	*start = text + entry->offset;
+	*length = (size_t)entry->length;
+	return true;
+}
+
+
+TiXmlElement* TiXmlOffsetIndex::Find( const char* value, TiXmlDocument* doc ) const
+{
+	doc->Clear();
+	const Entry* entry = Lower( value );
+	if ( !entry )
+		return 0;
+
+	// Keys that only share a hash are told apart by parsing each record
+	// with that hash in turn; nearly every hash has just the one.
+	const TiXmlU64 hash = entry->hash;
+	for ( const Entry* end = entries + records; entry < end && entry->hash == hash; ++entry )
+	{
+		if ( entry->offset > textBytes || entry->length > textBytes - entry->offset )
+			return 0;
+		doc->Clear();
+		if ( !doc->ParseElement( text + entry->offset, encoding ) )
+			return 0;
+		TiXmlElement* element = doc->RootElement();
+		const char* found = element->Attribute( key.c_str() );
+		if ( found && strcmp( found, value ) == 0 )
+			return element;
+	}
+	doc->Clear();
+	return 0;
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#ifndef TINYXML_INDEX_INCLUDED
+#define TINYXML_INDEX_INCLUDED
+
+#ifdef TIXML_USE_STL
+
+#include <string>
+
+#include "tinyxml.h"
+
+/**	Random access to the records of a large XML file - an export with
+	millions of <record id="..."> elements, say - through a sidecar index of
+	where each one starts and ends.
+
+	@verbatim
+	// Once, or whenever the export changes:
+	TiXmlOffsetIndex::Build( "export.xml", "export.xml.idx", 2, "id" );
+
+	TiXmlOffsetIndex index;
+	if ( index.Open( "export.xml", "export.xml.idx" ) )
+	{
+		TiXmlDocument doc;
+		const TiXmlElement* record = index.Find( "4711", &doc );
+		...
+	}
+	@endverbatim
+
+	Build() reads the file through once, with a TiXmlReader, and notes the
+	byte range of every element at the given depth that has the key
+	attribute. The index holds a hash of each key with the range, sorted by
+	hash, so a record costs 24 bytes whatever its key. Open() memory maps
+	the file and the index; Find() then binary searches the index, goes
+	straight to the record and parses only that element, checking that its
+	key really matches. A lookup reads a few pages of the index and the
+	record's own pages, however big the file is.
+
+	The index records the file's size, modification time and inode, and
+	Open() refuses one that was built from a different version of it. It
+	is in the machine's own byte order, so it is only good on the machine
+	(or machines of the same kind) that built it. A key that several
+	records share finds the first of them.
+
+	A record is parsed by TiXmlDocument::ParseElement(), so its rows and
+	columns are counted from its own start, and prefixes declared on the
+	elements around it aren't known: parse it without
+	TiXmlParseOptions::namespaces. Find() may be called from several
+	threads at once, each with its own document. Where memory mapping isn't
+	available Build() and Open() fail.
+*/
+class TiXmlOffsetIndex
+{
+public:
+	TiXmlOffsetIndex();
+	/// Unmaps the file and the index.
+	~TiXmlOffsetIndex();
+
+	/** Index the elements of 'xmlFile' at 'depth' (1 for the root element,
+		2 for its children, and so on) by their 'key' attribute, writing the
+		index to 'indexFile'. Elements without the attribute are left out.
+		The index is written to a temporary file that is renamed into place.
+		The file is read with 'options', as TiXmlReader::SetParseOptions()
+		takes them. Returns false, and says why in 'error' if that isn't
+		null, if the file can't be read or parsed or the index can't be
+		written.
+	*/
+	static bool Build(	const char* xmlFile, const char* indexFile, int depth, const char* key,
+						std::string* error = 0, const TiXmlParseOptions& options = TiXmlParseOptions() );
+
+	/** Map 'xmlFile' and the index Build() made of it, closing whatever
+		was open. Returns false, and says why in 'error' if that isn't null,
+		if either can't be mapped or the index doesn't match the file.
+	*/
+	bool Open( const char* xmlFile, const char* indexFile, std::string* error = 0 );
+	/// Unmap the file and the index.
+	void Close();
+
+	/// The number of records indexed.
+	size_t Records() const		{ return records; }
+	/// The depth the records are at.
+	int Depth() const			{ return depth; }
+	/// The attribute the records are found by.
+	const char* Key() const		{ return key.c_str(); }
+
+	/** The text of the record whose key is 'value': where it starts in the
+		mapped file and how long it is. Returns false if there's no record
+		with that key's hash. The text is only good until Close().
+	*/
+	bool Locate( const char* value, const char** start, size_t* length ) const;
+
+	/** Parse the record whose key is 'value' into 'doc', which is cleared
+		first, and return it: the document's root element. Returns null if
+		there's no such record, or if the record doesn't parse, with the
+		error in 'doc'. The document's ParseOptions() apply.
+	*/
+	TiXmlElement* Find( const char* value, TiXmlDocument* doc ) const;
+
+private:
+	TiXmlOffsetIndex( const TiXmlOffsetIndex& );		// not implemented.
+	void operator=( const TiXmlOffsetIndex& );			// not implemented.
+
+	struct Entry;
+
+	// The first entry with the hash of 'value', or null.
+	const Entry* Lower( const char* value ) const;
+
+	const char* text;			// the mapped file, with a zero byte after it
+	size_t textBytes;			// the file's size
+	size_t textMapped;			// the size of the mapping
+	const char* image;			// the mapped index
+	size_t imageBytes;
+	const Entry* entries;
+	size_t records;
+	int depth;
+	TiXmlEncoding encoding;
+	std::string key;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,257 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+#ifndef TINYXML_ITERATOR_INCLUDED
+#define TINYXML_ITERATOR_INCLUDED
+
+#include <stddef.h>
+#include <iterator>
+
+#include "tinyxml.h"
+
+/**	Forward iterators over the DOM, for range-for loops and the standard
+	algorithms:
+
+	@verbatim
+	for ( TiXmlElement* component : TiXmlChildElements( application ) )
+		printf( "%s\n", component->Attribute( "ml:name" ) );
+
+	size_t texts = std::count_if(	TiXmlDescendants( &doc ).begin(),
+									TiXmlDescendants( &doc ).end(),
+									[]( const TiXmlNode* n ) { return n->ToText() != 0; } );
+	@endverbatim
+
+	The iterators yield pointers, like the rest of the API. They follow the
+	sibling and parent links directly, with no virtual calls and no
+	recursion, and prefetch the node after the current one while it is being
+	used. Descendants are visited in document order (pre-order), not
+	including the node they start from.
+
+	Modifying the tree invalidates an iterator on the node that changes; it is
+	safe to change a node's attributes or value while iterating over it.
+*/
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+	#define TIXML_PREFETCH( p )		__builtin_prefetch( p )
+#else
+	#define TIXML_PREFETCH( p )		( (void)0 )
+#endif
+
+
+/// [internal use] The traversal policies behind the iterators.
+struct TiXmlChildStep
+{
+	template< typename N > static N* First( N* parent )	{ return parent->FirstChild(); }
+	template< typename N > static N* Next( N* node, N* )	{ return node->NextSibling(); }
+};
+
+struct TiXmlChildElementStep
+{
+	template< typename N > static N* Skip( N* node )
+	{
+		while ( node && node->Type() != TiXmlNode::TINYXML_ELEMENT )
+			node = node->NextSibling();
+		return node;
+	}
+	template< typename N > static N* First( N* parent )	{ return Skip( parent->FirstChild() ); }
+	template< typename N > static N* Next( N* node, N* )	{ return Skip( node->NextSibling() ); }
+};
+
+struct TiXmlDescendantStep
+{
+	template< typename N > static N* First( N* root )		{ return root->FirstChild(); }
+	template< typename N > static N* Next( N* node, N* root )
+	{
+		if ( node->FirstChild() )
+			return node->FirstChild();
+		while ( node != root )
+		{
+			if ( node->NextSibling() )
+				return node->NextSibling();
+			node = node->Parent();
+		}
+		return 0;
+	}
+};
+
+
+/**	A forward iterator over nodes. N is TiXmlNode or const TiXmlNode; V is the
+	pointer type it yields (TiXmlElement for TiXmlChildElements()).
+*/
+template< typename N, typename V, typename Step >
+class TiXmlNodeIterator
+{
+public:
+	typedef std::forward_iterator_tag	iterator_category;
+	typedef V*							value_type;
+	typedef ptrdiff_t					difference_type;
+	typedef V*							pointer;
+	typedef V* const&					reference;
+
+	TiXmlNodeIterator() : node( 0 ), root( 0 ) {}
+	TiXmlNodeIterator( N* _node, N* _root ) : root( _root )
+	{
+		Set( _node );
+	}
+
+	reference operator*() const			{ return node; }
+	V* operator->() const				{ return node; }		///< So it->Value() works.
+
+	TiXmlNodeIterator& operator++()
+	{
+		Set( Step::Next( static_cast< N* >( node ), root ) );
+		return *this;
+	}
+	TiXmlNodeIterator operator++( int )
+	{
+		TiXmlNodeIterator was( *this );
+		++*this;
+		return was;
+	}
+
+	bool operator==( const TiXmlNodeIterator& rhs ) const	{ return node == rhs.node; }
+	bool operator!=( const TiXmlNodeIterator& rhs ) const	{ return node != rhs.node; }
+
+private:
+	void Set( N* n )
+	{
+		node = static_cast< V* >( n );
+		if ( n )
+		{
+			// Start pulling in whatever is visited next.
+			TIXML_PREFETCH( n->NextSibling() );
+			TIXML_PREFETCH( n->FirstChild() );
+		}
+	}
+
+	V* node;
+	N* root;
+};
+
+
+/// A forward iterator over the attributes of an element.
+template< typename A >
+class TiXmlAttributeIterator
+{
+public:
+	typedef std::forward_iterator_tag	iterator_category;
+	typedef A*							value_type;
+	typedef ptrdiff_t					difference_type;
+	typedef A*							pointer;
+	typedef A* const&					reference;
+
+	TiXmlAttributeIterator() : attribute( 0 ) {}
+	explicit TiXmlAttributeIterator( A* _attribute ) : attribute( _attribute ) {}
+
+	reference operator*() const			{ return attribute; }
+	A* operator->() const				{ return attribute; }
+
+	TiXmlAttributeIterator& operator++()
+	{
+		attribute = attribute->Next();
+		return *this;
+	}
+	TiXmlAttributeIterator operator++( int )
+	{
+		TiXmlAttributeIterator was( *this );
+		++*this;
+		return was;
+	}
+
+	bool operator==( const TiXmlAttributeIterator& rhs ) const	{ return attribute == rhs.attribute; }
+	bool operator!=( const TiXmlAttributeIterator& rhs ) const	{ return attribute != rhs.attribute; }
+
+private:
+	A* attribute;
+};
+
+
+/// A begin() / end() pair, for range-for.
+template< typename I >
+class TiXmlRange
+{
+public:
+	TiXmlRange( I _first, I _last ) : first( _first ), last( _last ) {}
+	I begin() const		{ return first; }
+	I end() const		{ return last; }
+	bool empty() const	{ return first == last; }
+
+private:
+	I first;
+	I last;
+};
+
+
+typedef TiXmlNodeIterator< TiXmlNode, TiXmlNode, TiXmlChildStep >							TiXmlChildIterator;
+typedef TiXmlNodeIterator< const TiXmlNode, const TiXmlNode, TiXmlChildStep >				TiXmlConstChildIterator;
+typedef TiXmlNodeIterator< TiXmlNode, TiXmlElement, TiXmlChildElementStep >					TiXmlChildElementIterator;
+typedef TiXmlNodeIterator< const TiXmlNode, const TiXmlElement, TiXmlChildElementStep >		TiXmlConstChildElementIterator;
+typedef TiXmlNodeIterator< TiXmlNode, TiXmlNode, TiXmlDescendantStep >						TiXmlDescendantIterator;
+typedef TiXmlNodeIterator< const TiXmlNode, const TiXmlNode, TiXmlDescendantStep >			TiXmlConstDescendantIterator;
+
+
+/// The children of 'node'.
+inline TiXmlRange< TiXmlChildIterator > TiXmlChildren( TiXmlNode* node )
+{
+	return TiXmlRange< TiXmlChildIterator >( TiXmlChildIterator( TiXmlChildStep::First( node ), node ), TiXmlChildIterator() );
+}
+inline TiXmlRange< TiXmlConstChildIterator > TiXmlChildren( const TiXmlNode* node )
+{
+	return TiXmlRange< TiXmlConstChildIterator >( TiXmlConstChildIterator( TiXmlChildStep::First( node ), node ), TiXmlConstChildIterator() );
+}
+
+/// The children of 'node' that are elements.
+inline TiXmlRange< TiXmlChildElementIterator > TiXmlChildElements( TiXmlNode* node )
+{
+	return TiXmlRange< TiXmlChildElementIterator >( TiXmlChildElementIterator( TiXmlChildElementStep::First( node ), node ), TiXmlChildElementIterator() );
+}
+inline TiXmlRange< TiXmlConstChildElementIterator > TiXmlChildElements( const TiXmlNode* node )
+{
+	return TiXmlRange< TiXmlConstChildElementIterator >( TiXmlConstChildElementIterator( TiXmlChildElementStep::First( node ), node ), TiXmlConstChildElementIterator() );
+}
+
+/// Every node below 'node', in document order.
+inline TiXmlRange< TiXmlDescendantIterator > TiXmlDescendants( TiXmlNode* node )
+{
+	return TiXmlRange< TiXmlDescendantIterator >( TiXmlDescendantIterator( TiXmlDescendantStep::First( node ), node ), TiXmlDescendantIterator() );
+}
+inline TiXmlRange< TiXmlConstDescendantIterator > TiXmlDescendants( const TiXmlNode* node )
+{
+	return TiXmlRange< TiXmlConstDescendantIterator >( TiXmlConstDescendantIterator( TiXmlDescendantStep::First( node ), node ), TiXmlConstDescendantIterator() );
+}
+
+/// The attributes of 'element'.
+inline TiXmlRange< TiXmlAttributeIterator< TiXmlAttribute > > TiXmlAttributes( TiXmlElement* element )
+{
+	return TiXmlRange< TiXmlAttributeIterator< TiXmlAttribute > >(	TiXmlAttributeIterator< TiXmlAttribute >( element->FirstAttribute() ),
+																	TiXmlAttributeIterator< TiXmlAttribute >() );
+}
+inline TiXmlRange< TiXmlAttributeIterator< const TiXmlAttribute > > TiXmlAttributes( const TiXmlElement* element )
+{
+	return TiXmlRange< TiXmlAttributeIterator< const TiXmlAttribute > >(	TiXmlAttributeIterator< const TiXmlAttribute >( element->FirstAttribute() ),
+																			TiXmlAttributeIterator< const TiXmlAttribute >() );
+}
+
+#endif
@@ -0,0 +1,485 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include <ctype.h>
+#include <string.h>
+
+#include "tinyxmljson.h"
+
+
+TiXmlJsonTranscoder::TiXmlJsonTranscoder( const TiXmlJsonOptions& _options )
+	: options( _options )
+{
+	sink = 0;
+	chunk = 16384;
+	sinkFailed = false;
+	holding = 0;
+	levels = 0;
+	depth = 0;
+	capacity = 0;
+}
+
+
+TiXmlJsonTranscoder::~TiXmlJsonTranscoder()
+{
+	delete [] levels;
+}
+
+
+bool TiXmlJsonTranscoder::Transcode( const char* xml, TiXmlEncoding encoding )
+{
+	reader.Reset( xml, encoding );
+	return Run();
+}
+
+
+bool TiXmlJsonTranscoder::TranscodeFile( const char* filename, TiXmlEncoding encoding )
+{
+	if ( !reader.LoadFile( filename, encoding ) )
+	{
+		error = reader.ErrorDesc();
+		error += ": ";
+		error += filename;
+		return false;
+	}
+	return Run();
+}
+
+
+TiXmlJsonTranscoder::Level* TiXmlJsonTranscoder::Push()
+{
+	if ( depth == capacity )
+	{
+		const int newCapacity = capacity ? capacity * 2 : 16;
+		Level* newLevels = new Level[ newCapacity ];
+		for ( int i=0; i<depth; ++i )
+			newLevels[i] = levels[i];
+		delete [] levels;
+		levels = newLevels;
+		capacity = newCapacity;
+	}
+	// Levels are kept from one document to the next, strings and all.
+	Level* level = &levels[ depth++ ];
+	level->text = "";
+	level->step = path.length();
+	level->keys = "";
+	level->arrayKeys = "";
+	level->arrays = "";
+	level->start = buffer.length();
+	level->members = 0;
+	level->open = false;
+	level->held = false;
+	level->typed = options.inferTypes;
+	return level;
+}
+
+
+void TiXmlJsonTranscoder::TrimPath( size_t length )
+{
+	path.assign( path.c_str(), length );
+}
+
+
+int TiXmlJsonTranscoder::Match( const char* name ) const
+{
+	int flags = 0;
+	for ( int i=0; i<options.ruleCount; ++i )
+	{
+		const char* rule = options.rules[i].path;
+		if ( strchr( rule, '/' ) ? path == rule : strcmp( name, rule ) == 0 )
+			flags |= options.rules[i].flags;
+	}
+	return flags;
+}
+
+
+const char* TiXmlJsonTranscoder::Key( const char* name ) const
+{
+	if ( options.stripPrefixes )
+	{
+		const char* colon = strchr( name, ':' );
+		if ( colon )
+			return colon + 1;
+	}
+	return name;
+}
+
+
+void TiXmlJsonTranscoder::OpenObject( Level* level )
+{
+	if ( !level->open )
+	{
+		buffer += '{';
+		level->open = true;
+	}
+}
+
+
+bool TiXmlJsonTranscoder::AddKey( Level* level, const char* name, bool array )
+{
+	key = "/";
+	key += name;
+	key += '/';
+	if ( array && strstr( level->arrayKeys.c_str(), key.c_str() ) )
+		return true;
+	if ( strstr( level->keys.c_str(), key.c_str() ) )
+		return false;
+	// Kept as "/a/b/", so that "/a/" finds a key in full.
+	level->keys += key.c_str() + ( level->keys.empty() ? 0 : 1 );
+	if ( array )
+		level->arrayKeys += key.c_str() + ( level->arrayKeys.empty() ? 0 : 1 );
+	return true;
+}
+
+
+void TiXmlJsonTranscoder::BeginMember( Level* level, const char* name, size_t length )
+{
+	if ( level->members++ )
+		buffer += ',';
+	WriteKey( name, length );
+}
+
+
+void TiXmlJsonTranscoder::WriteArrays( Level* level )
+{
+	// level->arrays holds the key and then the value of each member, each
+	// ended by a 0; the members with one key go in one array, and the
+	// arrays in the order their keys first came.
+	const char* held = level->arrays.c_str();
+	const char* heldEnd = held + level->arrays.length();
+	for ( const char* k = level->arrayKeys.c_str(); *k && k[1]; )
+	{
+		++k;
+		const char* kEnd = strchr( k, '/' );
+		const size_t length = kEnd - k;
+		BeginMember( level, k, length );
+		buffer += '[';
+		bool first = true;
+		for ( const char* member = held; member < heldEnd; )
+		{
+			const size_t memberLength = strlen( member );
+			const char* value = member + memberLength + 1;
+			const size_t valueLength = strlen( value );
+			if ( memberLength == length && memcmp( member, k, length ) == 0 )
+			{
+				if ( !first )
+					buffer += ',';
+				first = false;
+				buffer.append( value, valueLength );
+			}
+			member = value + valueLength + 1;
+		}
+		buffer += ']';
+		k = kEnd;
+	}
+}
+
+
+void TiXmlJsonTranscoder::EndElement( Level* level )
+{
+	if ( level->open )
+	{
+		WriteArrays( level );
+		if ( !level->text.empty() )
+		{
+			BeginMember( level, options.textKey, strlen( options.textKey ) );
+			WriteValue( level->text.c_str(), level->text.length(), level->typed );
+		}
+		buffer += '}';
+	}
+	else if ( !level->text.empty() )
+	{
+		WriteValue( level->text.c_str(), level->text.length(), level->typed );
+	}
+	else
+	{
+		buffer += "null";
+	}
+}
+
+
+void TiXmlJsonTranscoder::WriteKey( const char* name, size_t length )
+{
+	WriteString( name, length );
+	buffer += ':';
+}
+
+
+// True if 'value' is, in full, a JSON number, true or false.
+static bool TiXmlJsonLiteral( const char* value, size_t length )
+{
+	if ( ( length == 4 && memcmp( value, "true", 4 ) == 0 ) || ( length == 5 && memcmp( value, "false", 5 ) == 0 ) )
+		return true;
+
+	const char* p = value;
+	const char* end = value + length;
+	if ( p < end && *p == '-' )
+		++p;
+	if ( p == end || !isdigit( (unsigned char)*p ) )
+		return false;
+	if ( *p == '0' )
+		++p;
+	else
+		while ( p < end && isdigit( (unsigned char)*p ) )
+			++p;
+	if ( p < end && *p == '.' )
+	{
+		if ( ++p == end || !isdigit( (unsigned char)*p ) )
+			return false;
+		while ( p < end && isdigit( (unsigned char)*p ) )
+			++p;
+	}
+	if ( p < end && ( *p == 'e' || *p == 'E' ) )
+	{
+		++p;
+		if ( p < end && ( *p == '+' || *p == '-' ) )
+			++p;
+		if ( p == end || !isdigit( (unsigned char)*p ) )
+			return false;
+		while ( p < end && isdigit( (unsigned char)*p ) )
+			++p;
+	}
+	return p == end;
+}
+
+
+void TiXmlJsonTranscoder::WriteValue( const char* value, size_t length, bool typed )
+{
+	if ( typed && TiXmlJsonLiteral( value, length ) )
+		buffer.append( value, length );
+	else
+		WriteString( value, length );
+}
+
+
+void TiXmlJsonTranscoder::WriteString( const char* s, size_t length )
+{
+	// Legacy text is taken to be Latin-1, and written as UTF-8 as JSON must be.
+	const bool legacy = reader.Encoding() == TIXML_ENCODING_LEGACY;
+	static const char hex[] = "0123456789abcdef";
+
+	buffer += '"';
+	const char* run = s;
+	for ( size_t i=0; i<length; ++i )
+	{
+		const unsigned char c = (unsigned char)s[i];
+		if ( c >= 0x20 && c != '"' && c != '\\' && !( legacy && c >= 0x80 ) )
+			continue;
+
+		buffer.append( run, s + i - run );
+		run = s + i + 1;
+		char escape[ 6 ] = { '\\', 0, 0, 0, 0, 0 };
+		switch ( c )
+		{
+			case '"':	escape[1] = '"';	break;
+			case '\\':	escape[1] = '\\';	break;
+			case '\n':	escape[1] = 'n';	break;
+			case '\r':	escape[1] = 'r';	break;
+			case '\t':	escape[1] = 't';	break;
+			case '\b':	escape[1] = 'b';	break;
+			case '\f':	escape[1] = 'f';	break;
+			default:
+				if ( c >= 0x80 )
+				{
+					buffer += (char)( 0xc0 | ( c >> 6 ) );
+					buffer += (char)( 0x80 | ( c & 0x3f ) );
+					continue;
+				}
+				buffer.append( "\\u00", 4 );
+				buffer += hex[ c >> 4 ];
+				buffer += hex[ c & 0xf ];
+				continue;
+		}
+		buffer.append( escape, 2 );
+	}
+	buffer.append( run, s + length - run );
+	buffer += '"';
+}
+
+
+bool TiXmlJsonTranscoder::Flush( bool all )
+{
+	if ( sink && !sinkFailed && !holding && !buffer.empty() && ( all || buffer.size() >= chunk ) )
+	{
+		if ( !sink->Write( buffer.c_str(), buffer.size() ) )
+			sinkFailed = true;
+		buffer.clear();
+	}
+	return !sinkFailed;
+}
+
+
+bool TiXmlJsonTranscoder::Run()
+{
+	error = "";
+	buffer = "";
+	sinkFailed = false;
+	path = "";
+	depth = 0;
+	holding = 0;
+	Push();
+
+	int skipDepth = 0;			// the reader's depth of the element being left out, if any
+	size_t skipStep = 0;
+	bool rootSeen = false;
+
+	for( ;; )
+	{
+		TiXmlReader::Token token = reader.Next();
+
+		if ( token == TiXmlReader::TOKEN_END_DOCUMENT )
+			break;
+
+		if ( token == TiXmlReader::TOKEN_ERROR )
+		{
+			char buf[ 128 ];
+			TIXML_SNPRINTF( buf, sizeof( buf ), "%s (row %d, col %d)", reader.ErrorDesc(), reader.ErrorRow(), reader.ErrorCol() );
+			error = buf;
+			return false;
+		}
+
+		if ( skipDepth )
+		{
+			if ( token == TiXmlReader::TOKEN_END_ELEMENT && reader.Depth() < skipDepth )
+			{
+				TrimPath( skipStep );
+				skipDepth = 0;
+			}
+			continue;
+		}
+
+		if ( token == TiXmlReader::TOKEN_START_ELEMENT )
+		{
+			const char* name = reader.Name();
+			const size_t step = path.length();
+			if ( step )
+				path += '/';
+			path += name;
+
+			const bool root = depth == 1;
+			const int flags = Match( name );
+			if ( ( flags & TIXML_JSON_SKIP ) || ( root && rootSeen && !options.keepRoot ) )
+			{
+				skipDepth = reader.Depth();
+				skipStep = step;
+				continue;
+			}
+			rootSeen = true;
+
+			bool held = false;
+			if ( !root || options.keepRoot )
+			{
+				Level* parent = &levels[ depth - 1 ];
+				const char* k = Key( name );
+				held = ( flags & TIXML_JSON_ARRAY ) != 0;
+				if ( !AddKey( parent, k, held ) )
+				{
+					const TiXmlCursor at = reader.Locate( reader.TokenStart() );
+					char buf[ 64 ];
+					TIXML_SNPRINTF( buf, sizeof( buf ), "' repeats with no array rule (row %d, col %d)", at.row+1, at.col+1 );
+					error = "Element '";
+					error += name;
+					error += buf;
+					return false;
+				}
+				OpenObject( parent );
+				if ( held )
+				{
+					// Written with the others of its key when the parent ends.
+					parent->arrays += k;
+					parent->arrays += '\0';
+					++holding;
+				}
+				else
+				{
+					BeginMember( parent, k, strlen( k ) );
+				}
+			}
+
+			Level* level = Push();
+			level->held = held;
+			level->step = step;
+			level->typed = options.inferTypes && !( flags & TIXML_JSON_STRING );
+			for ( int i=0; i<reader.AttributeCount(); ++i )
+			{
+				const char* attribute = reader.AttributeName( i );
+				if ( options.stripPrefixes && strncmp( attribute, "xmlns", 5 ) == 0 && ( !attribute[5] || attribute[5] == ':' ) )
+					continue;
+				key = options.attributePrefix;
+				key += Key( attribute );
+				OpenObject( level );
+				BeginMember( level, key.c_str(), key.length() );
+				const char* value = reader.AttributeValue( i );
+				WriteValue( value, strlen( value ), level->typed );
+			}
+		}
+		else if ( token == TiXmlReader::TOKEN_TEXT )
+		{
+			if ( depth > 1 )
+				levels[ depth - 1 ].text.append( reader.Text(), reader.TextLength() );
+		}
+		else if ( token == TiXmlReader::TOKEN_END_ELEMENT )
+		{
+			Level* level = &levels[ depth - 1 ];
+			EndElement( level );
+			if ( level->held )
+			{
+				Level* parent = level - 1;
+				parent->arrays.append( buffer.c_str() + level->start, buffer.length() - level->start );
+				parent->arrays += '\0';
+				buffer.assign( buffer.c_str(), level->start );
+				--holding;
+			}
+			TrimPath( level->step );
+			--depth;
+		}
+
+		if ( !Flush( false ) )
+			break;
+	}
+
+	if ( !sinkFailed )
+	{
+		if ( !options.keepRoot )
+		{
+			if ( !rootSeen )
+				buffer += "null";
+		}
+		else if ( levels[0].open )
+		{
+			WriteArrays( &levels[0] );
+			buffer += '}';
+		}
+		else
+		{
+			buffer += "{}";
+		}
+	}
+	if ( !Flush( true ) )
+	{
+		error = "Error writing the output.";
+		return false;
+	}
+	return true;
+}
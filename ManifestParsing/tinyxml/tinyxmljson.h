@@ -0,0 +1,196 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+
+#ifndef TINYXML_JSON_INCLUDED
+#define TINYXML_JSON_INCLUDED
+
+#include "tinyxml.h"
+#include "tinyxmlreader.h"
+
+/// How a TiXmlJsonRule changes the JSON for the elements it matches.
+enum
+{
+	TIXML_JSON_ARRAY	= 1 << 0,	///< Always an array, so one occurrence looks like many.
+	TIXML_JSON_SKIP		= 1 << 1,	///< Left out, with everything inside it.
+	TIXML_JSON_STRING	= 1 << 2	///< Its text and attributes stay strings under TiXmlJsonOptions::inferTypes.
+};
+
+/**	A mapping rule for TiXmlJsonTranscoder. 'path' is either a slash
+	separated path from the root element, as in TiXmlBindField, or a single
+	name that matches elements of that name anywhere. Names are matched as
+	they are written, prefix and all.
+*/
+struct TiXmlJsonRule
+{
+	const char* path;
+	int flags;		///< TIXML_JSON_ flags.
+};
+
+/// How TiXmlJsonTranscoder maps XML to JSON.
+struct TiXmlJsonOptions
+{
+	TiXmlJsonOptions() :	attributePrefix( "@" ),
+							textKey( "#text" ),
+							stripPrefixes( false ),
+							inferTypes( false ),
+							keepRoot( true ),
+							rules( 0 ),
+							ruleCount( 0 ) {}
+
+	const char* attributePrefix;	///< Put before attribute names, to tell them from child elements.
+	const char* textKey;			///< The key of the text of an element that is written as an object.
+	/** Drop namespace prefixes from keys ("ml:package" becomes "package")
+		and leave out xmlns attributes.
+	*/
+	bool stripPrefixes;
+	/// Write text and attribute values that are JSON numbers, true or false as such rather than as strings.
+	bool inferTypes;
+	/// Wrap the output in an object keyed by the root element's name; otherwise the root's value is the output.
+	bool keepRoot;
+
+	const TiXmlJsonRule* rules;		///< Not copied: must outlive the transcoder.
+	int ruleCount;
+};
+
+
+/**	Writes XML as JSON in one pass over the text, with a TiXmlReader and no
+	DOM. The output goes to a TiXmlPrintSink a chunk at a time, or is kept
+	for CStr() when there is no sink, as TiXmlPrinter does.
+
+	@verbatim
+	<manifest ml:package="com.app">
+		<component ml:name=".a"/>
+		<component ml:name=".b"/>
+		<note>hello</note>
+	</manifest>
+
+	{"manifest":{"@ml:package":"com.app","note":"hello","component":[{"@ml:name":".a"},{"@ml:name":".b"}]}}
+	@endverbatim
+
+	with the rule { "component", TIXML_JSON_ARRAY }. An element with
+	attributes or child elements becomes an object: its attributes, then its
+	children in order, then the arrays of its children with an array rule,
+	then its text under TiXmlJsonOptions::textKey. An element with only text
+	becomes a string, and an empty one null.
+
+	Because nothing is read ahead, an element only goes into an array when a
+	rule says so. All the elements of one parent with an array rule and the
+	same key go in one array, whatever comes between them. An element with
+	no rule that repeats a key fails the transcode, rather than write the
+	key twice. Comments, processing instructions and declarations are left
+	out.
+
+	Beyond the input and the output chunk, memory grows with the depth of
+	nesting and the text of the elements open at once, and is kept from one
+	document to the next. The JSON of the elements with an array rule is the
+	exception: it is held until their parent ends, and nothing goes to the
+	sink while any of it is, so an array rule on the children of the root
+	holds most of the output.
+*/
+class TiXmlJsonTranscoder
+{
+public:
+	TiXmlJsonTranscoder( const TiXmlJsonOptions& options = TiXmlJsonOptions() );
+	~TiXmlJsonTranscoder();
+
+	/** Send the output to 'sink' whenever at least 'chunk' bytes of it are
+		waiting, and the rest at the end, rather than keeping it. Null keeps
+		it. The transcoder does not own the sink.
+	*/
+	void SetSink( TiXmlPrintSink* _sink, size_t _chunk = 16384 )	{ sink = _sink; chunk = _chunk; }
+
+	/** The options the XML is read with, as TiXmlReader::SetParseOptions()
+		takes them; the encoding is the one given to Transcode().
+	*/
+	void SetParseOptions( const TiXmlParseOptions& options )	{ reader.SetParseOptions( options ); }
+	const TiXmlParseOptions& ParseOptions() const				{ return reader.ParseOptions(); }
+
+	/** Transcode a null terminated buffer of XML. Returns false if the XML
+		is malformed, with ErrorDesc() set, or if the sink fails; output
+		already written stays written.
+	*/
+	bool Transcode( const char* xml, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+	/// Transcode a file, read as TiXmlReader::LoadFile() reads it.
+	bool TranscodeFile( const char* filename, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+
+	/// The output not yet given to the sink: all of it, with no sink.
+	const char* CStr() const				{ return buffer.c_str(); }
+	size_t Size() const						{ return buffer.size(); }
+
+	/// What went wrong with the last Transcode(), with its row and column, or "".
+	const char* ErrorDesc() const			{ return error.c_str(); }
+
+private:
+	TiXmlJsonTranscoder( const TiXmlJsonTranscoder& );		// not implemented.
+	void operator=( const TiXmlJsonTranscoder& );			// not implemented.
+
+	// An element being written, or the document around the root.
+	struct Level
+	{
+		TIXML_STRING text;		// its text so far, written when it ends
+		TIXML_STRING keys;		// the keys of its child elements, as "/a/b/"
+		TIXML_STRING arrayKeys;	// those of them with an array rule
+		TIXML_STRING arrays;	// its members with an array rule, held until it ends
+		size_t start;			// where its value starts in the buffer
+		size_t step;			// the length of the path before it
+		int members;			// members written, once it is an object
+		bool open;				// an object: '{' is written
+		bool held;				// a member of an array of its parent's
+		bool typed;				// values may be written as numbers and booleans
+	};
+
+	bool Run();
+	int Match( const char* name ) const;
+	void TrimPath( size_t length );
+	Level* Push();
+	void OpenObject( Level* level );
+	bool AddKey( Level* level, const char* name, bool array );
+	void BeginMember( Level* level, const char* key, size_t length );
+	void WriteArrays( Level* level );
+	void EndElement( Level* level );
+	void WriteKey( const char* key, size_t length );
+	void WriteValue( const char* value, size_t length, bool typed );
+	void WriteString( const char* s, size_t length );
+	bool Flush( bool all );
+	const char* Key( const char* name ) const;
+
+	TiXmlJsonOptions options;
+	TiXmlReader reader;
+	TiXmlPrintSink* sink;
+	size_t chunk;
+	bool sinkFailed;
+	int holding;			// members of arrays being written, kept from the sink
+	TIXML_STRING buffer;
+	TIXML_STRING error;
+	TIXML_STRING key;
+
+	TIXML_STRING path;		// of the open element
+	Level* levels;			// levels[0] is the document
+	int depth;				// levels in use
+	int capacity;
+};
+
+#endif
@@ -0,0 +1,342 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+// Namespace resolution: the names a document interns, the bindings in scope
+// while elements are opened, and the TiXmlName lookups built on them.
+
+#include <string.h>
+
+#include "tinyxml.h"
+
+static const char* const TIXML_XML_NAMESPACE = "http://www.w3.org/XML/1998/namespace";
+static const char* const TIXML_XMLNS_NAMESPACE = "http://www.w3.org/2000/xmlns/";
+
+
+TiXmlNameTable::TiXmlNameTable()
+{
+	entries = 0;
+	count = capacity = 0;
+	slots = 0;
+	slotCount = 0;
+	Intern( "", 0 );
+}
+
+
+TiXmlNameTable::~TiXmlNameTable()
+{
+	for ( int i=0; i<count; ++i )
+		delete [] entries[i].string;
+	delete [] entries;
+	delete [] slots;
+}
+
+
+unsigned TiXmlNameTable::HashOf( const char* s, size_t length )
+{
+	// FNV-1a
+	unsigned h = 2166136261u;
+	for ( size_t i=0; i<length; ++i )
+	{
+		h ^= (unsigned char)s[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+
+void TiXmlNameTable::Grow()
+{
+	if ( count == capacity )
+	{
+		const int newCapacity = capacity ? capacity * 2 : 64;
+		Entry* newEntries = new Entry[ newCapacity ];
+		if ( count )
+			memcpy( newEntries, entries, count * sizeof( Entry ) );
+		delete [] entries;
+		entries = newEntries;
+		capacity = newCapacity;
+	}
+
+	if ( ( count + 1 ) * 2 > slotCount )
+	{
+		delete [] slots;
+		slotCount = slotCount ? slotCount * 2 : 128;
+		slots = new int[ slotCount ];
+		for ( int i=0; i<slotCount; ++i )
+			slots[i] = -1;
+		for ( int id=0; id<count; ++id )
+		{
+			int slot = (int)( entries[id].hash & ( slotCount - 1 ) );
+			while ( slots[slot] >= 0 )
+				slot = ( slot + 1 ) & ( slotCount - 1 );
+			slots[slot] = id;
+		}
+	}
+}
+
+
+int TiXmlNameTable::Intern( const char* s, size_t length )
+{
+	const unsigned hash = HashOf( s, length );
+	if ( slotCount )
+	{
+		for ( int slot = (int)( hash & ( slotCount - 1 ) ); slots[slot] >= 0; slot = ( slot + 1 ) & ( slotCount - 1 ) )
+		{
+			const Entry& entry = entries[ slots[slot] ];
+			if ( entry.hash == hash && entry.length == length && memcmp( entry.string, s, length ) == 0 )
+				return slots[slot];
+		}
+	}
+
+	Grow();
+	Entry& entry = entries[count];
+	entry.string = new char[ length + 1 ];
+	memcpy( entry.string, s, length );
+	entry.string[length] = 0;
+	entry.length = length;
+	entry.hash = hash;
+	entry.prefix = -1;
+	entry.local = -1;
+
+	int slot = (int)( hash & ( slotCount - 1 ) );
+	while ( slots[slot] >= 0 )
+		slot = ( slot + 1 ) & ( slotCount - 1 );
+	slots[slot] = count;
+	return count++;
+}
+
+
+int TiXmlNameTable::Find( const char* s ) const
+{
+	const size_t length = strlen( s );
+	const unsigned hash = HashOf( s, length );
+	for ( int slot = (int)( hash & ( slotCount - 1 ) ); slots[slot] >= 0; slot = ( slot + 1 ) & ( slotCount - 1 ) )
+	{
+		const Entry& entry = entries[ slots[slot] ];
+		if ( entry.hash == hash && entry.length == length && memcmp( entry.string, s, length ) == 0 )
+			return slots[slot];
+	}
+	return -1;
+}
+
+
+void TiXmlNameTable::Split( int id, int* prefix, int* local )
+{
+	if ( entries[id].prefix < 0 )
+	{
+		// Interning the parts may move 'entries', so copy out what's needed.
+		const char* s = entries[id].string;
+		const size_t length = entries[id].length;
+		const char* colon = (const char*)memchr( s, ':', length );
+		int p = 0;
+		int l = id;
+		if ( colon && colon > s && colon < s + length - 1 )
+		{
+			p = Intern( s, colon - s );
+			l = Intern( colon + 1, length - ( colon + 1 - s ) );
+		}
+		entries[id].prefix = p;
+		entries[id].local = l;
+	}
+	*prefix = entries[id].prefix;
+	*local = entries[id].local;
+}
+
+
+size_t TiXmlNameTable::Bytes() const
+{
+	size_t bytes = capacity * sizeof( Entry ) + slotCount * sizeof( int ) + 2 * TIXML_ALLOCATION_OVERHEAD;
+	for ( int i=0; i<count; ++i )
+		bytes += entries[i].length + 1 + TIXML_ALLOCATION_OVERHEAD;
+	return bytes;
+}
+
+
+TiXmlNamespaceScope::TiXmlNamespaceScope( TiXmlNameTable* _names )
+{
+	names = _names;
+	xmlnsPrefix = xmlnsURI = -1;
+	bindings = 0;
+	bindingCount = bindingCapacity = 0;
+	marks = 0;
+	depth = markCapacity = 0;
+
+	// The parser makes one of these whether or not it resolves names.
+	if ( !names )
+		return;
+
+	xmlnsPrefix = names->Intern( "xmlns", 5 );
+	xmlnsURI = names->Intern( TIXML_XMLNS_NAMESPACE, strlen( TIXML_XMLNS_NAMESPACE ) );
+	Bind( names->Intern( "xml", 3 ), names->Intern( TIXML_XML_NAMESPACE, strlen( TIXML_XML_NAMESPACE ) ) );
+	Bind( xmlnsPrefix, xmlnsURI );
+}
+
+
+TiXmlNamespaceScope::~TiXmlNamespaceScope()
+{
+	delete [] bindings;
+	delete [] marks;
+}
+
+
+void TiXmlNamespaceScope::Bind( int prefix, int uri )
+{
+	if ( bindingCount + 2 > bindingCapacity )
+	{
+		const int newCapacity = bindingCapacity ? bindingCapacity * 2 : 16;
+		int* newBindings = new int[ newCapacity ];
+		if ( bindingCount )
+			memcpy( newBindings, bindings, bindingCount * sizeof( int ) );
+		delete [] bindings;
+		bindings = newBindings;
+		bindingCapacity = newCapacity;
+	}
+	bindings[ bindingCount++ ] = prefix;
+	bindings[ bindingCount++ ] = uri;
+}
+
+
+int TiXmlNamespaceScope::Lookup( int prefix ) const
+{
+	for ( int i = bindingCount - 2; i >= 0; i -= 2 )
+	{
+		if ( bindings[i] == prefix )
+			return bindings[i+1];
+	}
+	return -1;
+}
+
+
+bool TiXmlNamespaceScope::Resolve( const TIXML_STRING& qualified, int unprefixed, TiXmlName* name )
+{
+	int prefix, local;
+	names->Split( names->Intern( qualified.c_str(), qualified.length() ), &prefix, &local );
+	const int uri = prefix ? Lookup( prefix ) : unprefixed;
+	if ( uri < 0 )
+	{
+		*name = TiXmlName();
+		return false;
+	}
+	*name = TiXmlName( uri, local );
+	return true;
+}
+
+
+bool TiXmlNamespaceScope::Open( TiXmlElement* element )
+{
+	assert( names );
+	if ( depth == markCapacity )
+	{
+		const int newCapacity = markCapacity ? markCapacity * 2 : 32;
+		int* newMarks = new int[ newCapacity ];
+		if ( depth )
+			memcpy( newMarks, marks, depth * sizeof( int ) );
+		delete [] marks;
+		marks = newMarks;
+		markCapacity = newCapacity;
+	}
+	marks[ depth++ ] = bindingCount;
+
+	// The declarations come first: they apply to the element they are on,
+	// and to its attributes whichever order they are written in.
+	TiXmlAttribute* attribute;
+	for ( attribute = element->attributeSet.First(); attribute; attribute = attribute->Next() )
+	{
+		const char* name = attribute->name.c_str();
+		if ( strncmp( name, "xmlns", 5 ) != 0 || ( name[5] && name[5] != ':' ) )
+			continue;
+		const int uri = names->Intern( attribute->value.c_str(), attribute->value.length() );
+		Bind( name[5] ? names->Intern( name + 6, attribute->name.length() - 6 ) : 0, uri );
+	}
+
+	// An unprefixed element is in the default namespace, if one is bound; an
+	// unprefixed attribute is in none, but for xmlns itself.
+	const int defaultURI = Lookup( 0 );
+	bool ok = Resolve( element->ValueTStr(), defaultURI < 0 ? 0 : defaultURI, &element->qname );
+	for ( attribute = element->attributeSet.First(); attribute; attribute = attribute->Next() )
+	{
+		ok = Resolve( attribute->name, 0, &attribute->qname ) && ok;
+		if ( attribute->qname.ns == 0 && attribute->qname.local == xmlnsPrefix )
+			attribute->qname.ns = xmlnsURI;
+	}
+	return ok;
+}
+
+
+void TiXmlNamespaceScope::Close()
+{
+	assert( depth > 0 );
+	bindingCount = marks[ --depth ];
+}
+
+
+TiXmlName TiXmlDocument::ResolveName( const char* namespaceURI, const char* localName ) const
+{
+	if ( !names || !localName )
+		return TiXmlName();
+	const int ns = ( namespaceURI && *namespaceURI ) ? names->Find( namespaceURI ) : 0;
+	const int local = names->Find( localName );
+	if ( ns < 0 || local <= 0 )
+		return TiXmlName();
+	return TiXmlName( ns, local );
+}
+
+
+const char* TiXmlDocument::NameString( int id ) const
+{
+	return names ? names->String( id ) : 0;
+}
+
+
+bool TiXmlDocument::ResolveNamespaces()
+{
+	if ( !names )
+		names = new TiXmlNameTable();
+	TiXmlNamespaceScope scope( names );
+	bool ok = true;
+
+	// Depth first, without recursion: an element is opened on the way down
+	// and closed once the walk leaves its last child.
+	TiXmlNode* node = firstChild;
+	while ( node )
+	{
+		if ( TiXmlElement* element = node->ToElement() )
+		{
+			ok = scope.Open( element ) && ok;
+			if ( element->firstChild )
+			{
+				node = element->firstChild;
+				continue;
+			}
+			scope.Close();
+		}
+		while ( !node->next && node->parent != this )
+		{
+			node = node->parent;
+			scope.Close();
+		}
+		node = node->next;
+	}
+	return ok;
+}
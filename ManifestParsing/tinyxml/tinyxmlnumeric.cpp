@@ -0,0 +1,454 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include "tinyxml.h"
+
+// Number formatting for SetIntValue / SetDoubleValue. snprintf( "%g" ) is
+// slow, only keeps 6 significant digits (so values don't survive a
+// save / load) and honors the C locale's decimal point. The double path
+// here is Florian Loitsch's Grisu2 ("Printing Floating-Point Numbers
+// Quickly and Accurately with Integers", PLDI 2010): it always produces
+// digits that read back to the identical double, and the shortest such
+// digits for all but a tiny fraction of inputs.
+
+typedef unsigned long long TiXmlU64;
+typedef unsigned int TiXmlU32;
+
+namespace {
+
+const char digitPairs[200 + 1] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+// Writes the decimal digits of 'v' to 'buffer', returns the count.
+int WriteUnsigned( TiXmlU32 v, char* buffer )
+{
+	char temp[ 10 ];
+	int n = 0;
+
+	while ( v >= 100 )
+	{
+		const TiXmlU32 pair = ( v % 100 ) * 2;
+		v /= 100;
+		temp[ n++ ] = digitPairs[ pair + 1 ];
+		temp[ n++ ] = digitPairs[ pair ];
+	}
+	if ( v >= 10 )
+	{
+		temp[ n++ ] = digitPairs[ v * 2 + 1 ];
+		temp[ n++ ] = digitPairs[ v * 2 ];
+	}
+	else
+	{
+		temp[ n++ ] = (char)( '0' + v );
+	}
+
+	for ( int i=0; i<n; ++i )
+		buffer[ i ] = temp[ n - 1 - i ];
+	return n;
+}
+
+
+// A "do-it-yourself" floating point number: f * 2^e, no hidden bit.
+struct DiyFp
+{
+	DiyFp() : f( 0 ), e( 0 ) {}
+	DiyFp( TiXmlU64 _f, int _e ) : f( _f ), e( _e ) {}
+
+	explicit DiyFp( double d )
+	{
+		TiXmlU64 bits;
+		memcpy( &bits, &d, sizeof( bits ) );
+
+		const int biasedExponent = (int)( ( bits & kExponentMask ) >> kSignificandSize );
+		const TiXmlU64 significand = bits & kSignificandMask;
+		if ( biasedExponent != 0 )
+		{
+			f = significand + kHiddenBit;
+			e = biasedExponent - kExponentBias;
+		}
+		else
+		{
+			f = significand;
+			e = 1 - kExponentBias;
+		}
+	}
+
+	DiyFp operator-( const DiyFp& rhs ) const
+	{
+		assert( e == rhs.e && f >= rhs.f );
+		return DiyFp( f - rhs.f, e );
+	}
+
+	// Multiply, keeping the (rounded) upper 64 bits of the 128 bit product.
+	DiyFp operator*( const DiyFp& rhs ) const
+	{
+		const TiXmlU64 M32 = 0xFFFFFFFFULL;
+		const TiXmlU64 a = f >> 32;
+		const TiXmlU64 b = f & M32;
+		const TiXmlU64 c = rhs.f >> 32;
+		const TiXmlU64 d = rhs.f & M32;
+		const TiXmlU64 ac = a * c;
+		const TiXmlU64 bc = b * c;
+		const TiXmlU64 ad = a * d;
+		const TiXmlU64 bd = b * d;
+		TiXmlU64 tmp = ( bd >> 32 ) + ( ad & M32 ) + ( bc & M32 );
+		tmp += 1ULL << 31;	// round
+		return DiyFp( ac + ( ad >> 32 ) + ( bc >> 32 ) + ( tmp >> 32 ), e + rhs.e + 64 );
+	}
+
+	DiyFp Normalize() const
+	{
+		DiyFp res = *this;
+		while ( !( res.f & ( 1ULL << 63 ) ) )
+		{
+			res.f <<= 1;
+			--res.e;
+		}
+		return res;
+	}
+
+	DiyFp NormalizeBoundary() const
+	{
+		DiyFp res = *this;
+		while ( !( res.f & ( kHiddenBit << 1 ) ) )
+		{
+			res.f <<= 1;
+			--res.e;
+		}
+		res.f <<= ( kDiySignificandSize - kSignificandSize - 2 );
+		res.e -= ( kDiySignificandSize - kSignificandSize - 2 );
+		return res;
+	}
+
+	// The neighbourhood of this value (halfway to the adjacent doubles.)
+	void NormalizedBoundaries( DiyFp* minus, DiyFp* plus ) const
+	{
+		DiyFp pl = DiyFp( ( f << 1 ) + 1, e - 1 ).NormalizeBoundary();
+		DiyFp mi = ( f == kHiddenBit ) ? DiyFp( ( f << 2 ) - 1, e - 2 ) : DiyFp( ( f << 1 ) - 1, e - 1 );
+		mi.f <<= mi.e - pl.e;
+		mi.e = pl.e;
+		*plus = pl;
+		*minus = mi;
+	}
+
+	static const int kDiySignificandSize = 64;
+	static const int kSignificandSize = 52;
+	static const int kExponentBias = 0x3FF + kSignificandSize;
+	static const TiXmlU64 kExponentMask = 0x7FF0000000000000ULL;
+	static const TiXmlU64 kSignificandMask = 0x000FFFFFFFFFFFFFULL;
+	static const TiXmlU64 kHiddenBit = 0x0010000000000000ULL;
+
+	TiXmlU64 f;
+	int e;
+};
+
+
+// 10^k for k = -348, -340, ..., 340, normalized to 64 bit significands.
+DiyFp GetCachedPower( int e, int* K )
+{
+	static const TiXmlU64 cachedF[] =
+	{
+		0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+		0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+		0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+		0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+		0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+		0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+		0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+		0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+		0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+		0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+		0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+		0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+		0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+		0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+		0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+		0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+		0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+		0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+		0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+		0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+		0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+		0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+		0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+		0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+		0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+		0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+		0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+		0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+		0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+	};
+	static const short cachedE[] =
+	{
+		-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007,  -980,
+		 -954,  -927,  -901,  -874,  -847,  -821,  -794,  -768,  -741,  -715,
+		 -688,  -661,  -635,  -608,  -582,  -555,  -529,  -502,  -475,  -449,
+		 -422,  -396,  -369,  -343,  -316,  -289,  -263,  -236,  -210,  -183,
+		 -157,  -130,  -103,   -77,   -50,   -24,     3,    30,    56,    83,
+		  109,   136,   162,   189,   216,   242,   269,   295,   322,   348,
+		  375,   402,   428,   455,   481,   508,   534,   561,   588,   614,
+		  641,   667,   694,   720,   747,   774,   800,   827,   853,   880,
+		  907,   933,   960,   986,  1013,  1039,  1066
+	};
+
+	// Pick the power that brings the product's exponent into [-60, -32].
+	const double dk = ( -61 - e ) * 0.30102999566398114 + 347;	// dk must be positive
+	int k = (int)dk;
+	if ( dk - k > 0.0 )
+		++k;
+
+	const unsigned index = (unsigned)( ( k >> 3 ) + 1 );
+	*K = -( -348 + (int)( index << 3 ) );
+	return DiyFp( cachedF[ index ], cachedE[ index ] );
+}
+
+
+void GrisuRound( char* buffer, int len, TiXmlU64 delta, TiXmlU64 rest, TiXmlU64 tenKappa, TiXmlU64 wpW )
+{
+	while (    rest < wpW
+			&& delta - rest >= tenKappa
+			&& ( rest + tenKappa < wpW || wpW - rest > rest + tenKappa - wpW ) )
+	{
+		buffer[ len - 1 ]--;
+		rest += tenKappa;
+	}
+}
+
+
+int CountDecimalDigits( TiXmlU32 n )
+{
+	int count = 1;
+	while ( n >= 10 )
+	{
+		n /= 10;
+		++count;
+	}
+	return count;
+}
+
+
+void DigitGen( const DiyFp& W, const DiyFp& Mp, TiXmlU64 delta, char* buffer, int* len, int* K )
+{
+	static const TiXmlU64 pow10[] =
+	{
+		1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+		100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+		10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+		100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+	};
+
+	const DiyFp one( 1ULL << -Mp.e, Mp.e );
+	const DiyFp wpW = Mp - W;
+	TiXmlU32 p1 = (TiXmlU32)( Mp.f >> -one.e );
+	TiXmlU64 p2 = Mp.f & ( one.f - 1 );
+	int kappa = CountDecimalDigits( p1 );
+	*len = 0;
+
+	// Integer part.
+	while ( kappa > 0 )
+	{
+		const TiXmlU32 div = (TiXmlU32)pow10[ kappa - 1 ];
+		const TiXmlU32 d = p1 / div;
+		p1 %= div;
+		if ( d || *len )
+			buffer[ (*len)++ ] = (char)( '0' + d );
+		--kappa;
+
+		const TiXmlU64 tmp = ( (TiXmlU64)p1 << -one.e ) + p2;
+		if ( tmp <= delta )
+		{
+			*K += kappa;
+			GrisuRound( buffer, *len, delta, tmp, pow10[ kappa ] << -one.e, wpW.f );
+			return;
+		}
+	}
+
+	// Fractional part.
+	for ( ;; )
+	{
+		p2 *= 10;
+		delta *= 10;
+		const char d = (char)( p2 >> -one.e );
+		if ( d || *len )
+			buffer[ (*len)++ ] = (char)( '0' + d );
+		p2 &= one.f - 1;
+		--kappa;
+		if ( p2 < delta )
+		{
+			*K += kappa;
+			const int index = -kappa;
+			GrisuRound( buffer, *len, delta, p2, one.f, wpW.f * ( index < 20 ? pow10[ index ] : 0 ) );
+			return;
+		}
+	}
+}
+
+
+// Produces the digits (no sign, no point) and the decimal exponent K
+// such that value == digits * 10^K.
+void Grisu2( double value, char* buffer, int* length, int* K )
+{
+	const DiyFp v( value );
+	DiyFp wm, wp;
+	v.NormalizedBoundaries( &wm, &wp );
+
+	const DiyFp cmk = GetCachedPower( wp.e, K );
+	const DiyFp W = v.Normalize() * cmk;
+	DiyFp Wp = wp * cmk;
+	DiyFp Wm = wm * cmk;
+	++Wm.f;
+	--Wp.f;
+	DigitGen( W, Wp, Wp.f - Wm.f, buffer, length, K );
+}
+
+
+int WriteExponent( int K, char* buffer )
+{
+	char* p = buffer;
+	*p++ = 'e';
+	if ( K < 0 )
+	{
+		*p++ = '-';
+		K = -K;
+	}
+	else
+	{
+		*p++ = '+';
+	}
+	// Match the two digit minimum of "%g".
+	if ( K < 10 )
+		*p++ = '0';
+	p += WriteUnsigned( (TiXmlU32)K, p );
+	return (int)( p - buffer );
+}
+
+
+// Lays the digits out as plain decimal when the exponent is modest,
+// otherwise as d.ddde+XX. Returns the new length.
+int Prettify( char* buffer, int length, int k )
+{
+	const int kk = length + k;	// 10^(kk-1) <= v < 10^kk
+
+	if ( k >= 0 && kk <= 21 )
+	{
+		// 1234e7 -> 12340000000
+		for ( int i=length; i<kk; ++i )
+			buffer[ i ] = '0';
+		return kk;
+	}
+	else if ( kk > 0 && kk <= 21 )
+	{
+		// 1234e-2 -> 12.34
+		memmove( buffer + kk + 1, buffer + kk, length - kk );
+		buffer[ kk ] = '.';
+		return length + 1;
+	}
+	else if ( kk > -6 && kk <= 0 )
+	{
+		// 1234e-6 -> 0.001234
+		const int offset = 2 - kk;
+		memmove( buffer + offset, buffer, length );
+		buffer[ 0 ] = '0';
+		buffer[ 1 ] = '.';
+		for ( int i=2; i<offset; ++i )
+			buffer[ i ] = '0';
+		return length + offset;
+	}
+	else if ( length == 1 )
+	{
+		// 1e30
+		return 1 + WriteExponent( kk - 1, buffer + 1 );
+	}
+	else
+	{
+		// 1234e30 -> 1.234e+33
+		memmove( buffer + 2, buffer + 1, length - 1 );
+		buffer[ 1 ] = '.';
+		return length + 1 + WriteExponent( kk - 1, buffer + length + 1 );
+	}
+}
+
+}	// namespace
+
+
+int TiXmlBase::FormatInt( int value, char* buffer )
+{
+	char* p = buffer;
+	TiXmlU32 u = (TiXmlU32)value;
+	if ( value < 0 )
+	{
+		*p++ = '-';
+		u = 0 - u;	// well defined for INT_MIN as well
+	}
+	p += WriteUnsigned( u, p );
+	*p = 0;
+	return (int)( p - buffer );
+}
+
+
+int TiXmlBase::FormatDouble( double value, char* buffer )
+{
+	char* p = buffer;
+
+	if ( value != value )
+	{
+		strcpy( p, "nan" );
+		return 3;
+	}
+
+	TiXmlU64 bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	if ( bits >> 63 )
+	{
+		*p++ = '-';
+		value = -value;
+	}
+
+	if ( value == 0.0 )
+	{
+		*p++ = '0';
+	}
+	else if ( ( bits & DiyFp::kExponentMask ) == DiyFp::kExponentMask )
+	{
+		memcpy( p, "inf", 3 );
+		p += 3;
+	}
+	else
+	{
+		int length, K;
+		Grisu2( value, p, &length, &K );
+		p += Prettify( p, length, K );
+	}
+	*p = 0;
+	return (int)( p - buffer );
+}
@@ -26,6 +26,7 @@ distribution.
 #include <stddef.h>
 
 #include "tinyxml.h"
+#include "tinyxmlprepass.h"
 
 //#define DEBUG_PARSER
 #if defined( DEBUG_PARSER )
@@ -173,26 +174,132 @@ class TiXmlParsingData
 	friend class TiXmlDocument;
   public:
 	void Stamp( const char* now, TiXmlEncoding encoding );
+	// Stamp() that may also go back, for an error found after the fact.
+	void Locate( const char* p, TiXmlEncoding encoding );
 
 	const TiXmlCursor& Cursor() const	{ return cursor; }
 
+	// The document being parsed, so nodes don't have to walk up to it.
+	TiXmlDocument* Document() const		{ return document; }
+
+	// The document's parse options, fixed for the length of the parse.
+	bool CondenseWhiteSpace() const		{ return condense; }
+	int Keep() const					{ return keep; }
+	const char* const* Paths() const	{ return paths; }
+	bool HashNodes() const				{ return hashNodes; }
+	// Where nodes come from and go back to, if the document reuses them.
+	TiXmlStorage* Storage() const		{ return storage; }
+	// The document's names, if namespaces are resolved.
+	TiXmlNameTable* Names() const		{ return names; }
+
+	// Count a node that was just parsed toward the document's memory. If that
+	// goes over the budget, sets the error at 'p' and returns false.
+	bool Account( const TiXmlNode* node, const char* p, TiXmlEncoding encoding );
+
   private:
 	// Only used by the document!
-	TiXmlParsingData( const char* start, int _tabsize, int row, int col )
+	TiXmlParsingData( TiXmlDocument* _document, const char* start, const TiXmlParseOptions& options, int row, int col )
 	{
 		assert( start );
+		document = _document;
 		stamp = start;
-		tabsize = _tabsize;
+		tabsize = options.tabSize;
+		condense = options.CondenseWhiteSpace();
+		keep = options.keep;
+		paths = options.paths;
+		hashNodes = options.hashNodes;
+		storage = document->storage;
+		if ( options.namespaces && !document->names )
+			document->names = new TiXmlNameTable();
+		names = options.namespaces ? document->names : 0;
+		budget = options.maxMemory;
 		cursor.row = row;
 		cursor.col = col;
+		begin = start;
+		beginCursor = cursor;
+
+		// LoadFile() has already found where this text's lines start.
+		prepass = document->prepass;
+		if ( !prepass || prepass->Text() != start || !prepass->Lines() || row != 0 || col != 0 )
+			prepass = 0;
+
+		bytes = document->inputBytes + TiXmlDocument::NodeBytes( document, 0 );
+		document->peakBytes = bytes;
+		nodes = 0;
+		nodeCount = 0;
+	}
+	// Hand the count of nodes built back to the document, however the parse ends.
+	~TiXmlParsingData()
+	{
+		if ( nodeCount )
+			*nodeCount = nodes;
 	}
 
+	void Advance( const char* now, TiXmlEncoding encoding );
+
+	TiXmlDocument*	document;
 	TiXmlCursor		cursor;
 	const char*		stamp;
+	const char*		begin;
+	TiXmlCursor		beginCursor;
+	const TiXmlPrepass* prepass;
 	int				tabsize;
+	bool			condense;
+	int				keep;
+	const char* const* paths;
+	bool			hashNodes;
+	TiXmlStorage*	storage;
+	TiXmlNameTable*	names;
+	size_t			bytes;
+	size_t			budget;
+	size_t			nodes;
+	size_t*			nodeCount;
 };
 
 
+// The parse options in effect for a node: those of the parse under way, or
+// else those of the document the node is in.
+static bool TiXmlCondenseWhiteSpace( const TiXmlParsingData* data, const TiXmlDocument* document )
+{
+	if ( data )
+		return data->CondenseWhiteSpace();
+	return document ? document->ParseOptions().CondenseWhiteSpace() : TiXmlBase::IsWhiteSpaceCondensed();
+}
+
+static int TiXmlKeep( const TiXmlParsingData* data, const TiXmlDocument* document )
+{
+	if ( data )
+		return data->Keep();
+	return document ? document->ParseOptions().keep : TiXmlParseOptions::KEEP_ALL;
+}
+
+
+// Give back a node or attribute a parse made and had no use for.
+template< class T >
+static void TiXmlDiscard( T* unused, TiXmlStorage* storage )
+{
+	if ( storage )
+		storage->Discard( unused );
+	else
+		delete unused;
+}
+
+
+bool TiXmlParsingData::Account( const TiXmlNode* node, const char* p, TiXmlEncoding encoding )
+{
+	bytes += TiXmlDocument::NodeBytes( node, 0 );
+	++nodes;
+	if ( bytes > document->peakBytes )
+		document->peakBytes = bytes;
+	if ( budget && bytes > budget )
+	{
+		document->SetError( TiXmlBase::TIXML_ERROR_MEMORY_BUDGET, p, this, encoding );
+		return false;
+	}
+	return true;
+}
+
+
 void TiXmlParsingData::Stamp( const char* now, TiXmlEncoding encoding )
 {
 	assert( now );
@@ -203,6 +310,58 @@ void TiXmlParsingData::Stamp( const char* now, TiXmlEncoding encoding )
 		return;
 	}
 
+	// With the line index, skip straight to the line 'now' is on. The walk
+	// below would count the same lines, unless bad UTF-8 has it step over a
+	// new line.
+	if (    prepass
+		 && now > stamp
+		 && ( prepass->InvalidUtf8() == TiXmlPrepass::NPOS || encoding != TIXML_ENCODING_UTF8 ) )
+	{
+		const size_t offset = now - prepass->Text();
+		int row = cursor.row;
+		for ( int step=0; row + 1 < prepass->Lines() && prepass->LineStart( row + 1 ) <= offset; ++step )
+		{
+			if ( step == 8 )
+			{
+				row = prepass->Row( offset );
+				break;
+			}
+			++row;
+		}
+
+		if ( prepass->SimpleColumns() )
+		{
+			// One byte, one column.
+			cursor.row = row;
+			cursor.col = (int)( offset - prepass->LineStart( row ) );
+			stamp = now;
+			return;
+		}
+		if ( row != cursor.row )
+		{
+			cursor.row = row;
+			cursor.col = 0;
+			stamp = prepass->Text() + prepass->LineStart( row );
+		}
+	}
+	Advance( now, encoding );
+}
+
+
+void TiXmlParsingData::Locate( const char* p, TiXmlEncoding encoding )
+{
+	if ( p < stamp )
+	{
+		stamp = begin;
+		cursor = beginCursor;
+	}
+	Stamp( p, encoding );
+}
+
+
+// Walk from the stamp to 'now', a character at a time.
+void TiXmlParsingData::Advance( const char* now, TiXmlEncoding encoding )
+{
 	// Get the current row, column.
 	int row = cursor.row;
 	int col = cursor.col;
@@ -362,7 +521,126 @@ const char* TiXmlBase::SkipWhiteSpace( const char* p, TiXmlEncoding encoding )
 }
 
 #ifdef TIXML_USE_STL
-/*static*/ bool TiXmlBase::StreamWhiteSpace( std::istream * in, TIXML_STRING * tag )
+/*	Reads a std::istream for operator>>, taking what the stream's buffer holds
+	a block at a time rather than a character at a time through the istream.
+	The StreamIn() methods only need get(), peek() and good(), which behave as
+	the istream's do, and AppendTo() for runs of text. Whatever was taken from
+	the buffer but not used is put back when the reader is done, so the stream
+	is left just after the node that was read, and its state bits are set as
+	reading it one character at a time would have set them.
+*/
+class TiXmlStreamReader
+{
+public:
+	TiXmlStreamReader( std::istream* _in ) : in( _in ), next( 0 ), end( 0 ), state( std::ios_base::goodbit )
+	{
+		// A stream that isn't good to begin with is left alone.
+		buffer = in->good() ? in->rdbuf() : 0;
+	}
+
+	~TiXmlStreamReader()
+	{
+		// Give back what wasn't used. It all came from the buffer's current
+		// get area, so it can all be put back.
+		while ( end > next )
+		{
+			if ( buffer->sputbackc( *--end ) == EOF )
+			{
+				state |= std::ios_base::badbit;
+				break;
+			}
+		}
+		if ( state != std::ios_base::goodbit )
+			in->setstate( state );
+	}
+
+	bool good() const	{ return buffer && state == std::ios_base::goodbit; }
+
+	int peek()
+	{
+		if ( next == end && !Fill() )
+			return EOF;
+		return (unsigned char) *next;
+	}
+
+	int get()
+	{
+		if ( next == end && !Fill() )
+		{
+			state |= std::ios_base::failbit;
+			return EOF;
+		}
+		return (unsigned char) *next++;
+	}
+
+	/*	Append everything up to the next 'character' or 'other', null or the
+		end of the input to 'tag'. Returns what it stopped at, without taking
+		it: 'character', 'other', 0 or EOF.
+	*/
+	int AppendTo( int character, TIXML_STRING* tag, int other = 0 )
+	{
+		const char stop = (char) character;
+		const char otherStop = (char) other;
+		for( ;; )
+		{
+			if ( next == end && !Fill() )
+				return EOF;
+			const char* p = next;
+			while ( p < end && *p != stop && *p != otherStop && *p )
+				++p;
+			tag->append( next, p - next );
+			next = p;
+			if ( p < end )
+				return (unsigned char) *p;
+		}
+	}
+
+private:
+	// Take the next block of input. Only what is already in the buffer's get
+	// area is taken, so none of it is lost if it has to be put back.
+	bool Fill()
+	{
+		if ( !good() )
+			return false;
+		if ( buffer->sgetc() == EOF )
+		{
+			state |= std::ios_base::eofbit;
+			return false;
+		}
+		std::streamsize available = buffer->in_avail();
+		if ( available < 1 )
+			available = 1;		// unbuffered
+		if ( available > (std::streamsize) sizeof( block ) )
+			available = sizeof( block );
+		next = block;
+		end = block + buffer->sgetn( block, available );
+		return next < end;
+	}
+
+	std::istream* in;
+	std::streambuf* buffer;
+	char block[ 4096 ];
+	const char* next;
+	const char* end;
+	std::ios_base::iostate state;
+};
+
+
+std::istream& operator>> (std::istream & in, TiXmlNode & base)
+{
+	TIXML_STRING tag;
+	tag.reserve( 8 * 1000 );
+	{
+		TiXmlStreamReader reader( &in );
+		base.StreamIn( &reader, &tag );
+	}
+
+	base.Parse( tag.c_str(), 0, TIXML_DEFAULT_ENCODING );
+	return in;
+}
+
+
+/*static*/ bool TiXmlBase::StreamWhiteSpace( TiXmlStreamReader * in, TIXML_STRING * tag )
 {
 	for( ;; )
 	{
@@ -377,21 +655,11 @@ const char* TiXmlBase::SkipWhiteSpace( const char* p, TiXmlEncoding encoding )
 	}
 }
 
-/*static*/ bool TiXmlBase::StreamTo( std::istream * in, int character, TIXML_STRING * tag )
+/*static*/ bool TiXmlBase::StreamTo( TiXmlStreamReader * in, int character, TIXML_STRING * tag )
 {
 	//assert( character > 0 && character < 128 );	// else it won't work in utf-8
-	while ( in->good() )
-	{
-		int c = in->peek();
-		if ( c == character )
-			return true;
-		if ( c <= 0 )		// Silent failure: can't get document at this scope
-			return false;
-
-		in->get();
-		*tag += (char) c;
-	}
-	return false;
+	// Silent failure on a null or the end: can't get document at this scope
+	return in->good() && in->AppendTo( character, tag ) == character;
 }
 #endif
 
@@ -579,8 +847,7 @@ const char* TiXmlBase::ReadText(	const char* p,
 									TiXmlEncoding encoding )
 {
     *text = "";
-	if (    !trimWhiteSpace			// certain tags always keep whitespace
-		 || !condenseWhiteSpace )	// if true, whitespace is always kept
+	if ( !trimWhiteSpace )			// certain tags, and the WHITESPACE_PRESERVE option, always keep whitespace
 	{
 		// Keep all the white space.
 		while (	   p && *p
@@ -638,7 +905,7 @@ const char* TiXmlBase::ReadText(	const char* p,
 
 #ifdef TIXML_USE_STL
 
-void TiXmlDocument::StreamIn( std::istream * in, TIXML_STRING * tag )
+void TiXmlDocument::StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag )
 {
 	// The basic issue with a document is that we don't know what we're
 	// streaming. Read something presumed to be a tag (and hope), then
@@ -656,15 +923,10 @@ void TiXmlDocument::StreamIn( std::istream * in, TIXML_STRING * tag )
 	while ( in->good() )
 	{
 		int tagIndex = (int) tag->length();
-		while ( in->good() && in->peek() != '>' )
+		if ( in->AppendTo( '>', tag ) != '>' )
 		{
-			int c = in->get();
-			if ( c <= 0 )
-			{
-				SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
-				break;
-			}
-			(*tag) += (char) c;
+			in->get();
+			SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
 		}
 
 		if ( in->good() )
@@ -701,7 +963,37 @@ void TiXmlDocument::StreamIn( std::istream * in, TIXML_STRING * tag )
 
 #endif
 
+const char* TiXmlDocument::Parse( const char* p, const TiXmlParseOptions& options )
+{
+	parseOptions = options;
+	return Parse( p, 0, options.encoding );
+}
+
 const char* TiXmlDocument::Parse( const char* p, TiXmlParsingData* prevData, TiXmlEncoding encoding )
+{
+	if ( !observer )
+		return ParseContent( p, prevData, encoding, 0 );
+
+	const unsigned long long start = TiXmlParseObserver::Now();
+	errorTime = 0;
+	size_t nodes = 0;
+	const char* end = ParseContent( p, prevData, encoding, &nodes );
+	const unsigned long long now = TiXmlParseObserver::Now();
+
+	if ( Error() && errorTime )
+	{
+		ReportPhase( TiXmlParsePhase::PHASE_PARSE, start, errorTime, 0, nodes );
+		ReportPhase( TiXmlParsePhase::PHASE_ERROR, errorTime, now, 0, 0 );
+	}
+	else
+	{
+		// A parse that reaches the end of the input returns null.
+		ReportPhase( TiXmlParsePhase::PHASE_PARSE, start, now, end ? end - p : strlen( p ), nodes );
+	}
+	return end;
+}
+
+const char* TiXmlDocument::ParseContent( const char* p, TiXmlParsingData* prevData, TiXmlEncoding encoding, size_t* nodes )
 {
 	ClearError();
 
@@ -714,6 +1006,19 @@ const char* TiXmlDocument::Parse( const char* p, TiXmlParsingData* prevData, TiX
 		return 0;
 	}
 
+	if ( parseOptions.maxBytes )
+	{
+		// Look no further than one byte past the limit.
+		size_t length = 0;
+		while ( length <= parseOptions.maxBytes && p[length] )
+			++length;
+		if ( length > parseOptions.maxBytes )
+		{
+			SetError( TIXML_ERROR_DOCUMENT_TOO_LARGE, 0, 0, TIXML_ENCODING_UNKNOWN );
+			return 0;
+		}
+	}
+
 	// Note that, for a document, this needs to come
 	// before the while space skip, so that parsing
 	// starts from the pointer we are given.
@@ -728,16 +1033,27 @@ const char* TiXmlDocument::Parse( const char* p, TiXmlParsingData* prevData, TiX
 		location.row = 0;
 		location.col = 0;
 	}
-	TiXmlParsingData data( p, TabSize(), location.row, location.col );
+	TiXmlParsingData data( this, p, parseOptions, location.row, location.col );
+	data.nodeCount = nodes;
 	location = data.Cursor();
 
+	if ( parseOptions.maxMemory && data.bytes > parseOptions.maxMemory )
+	{
+		SetError( TIXML_ERROR_MEMORY_BUDGET, 0, 0, TIXML_ENCODING_UNKNOWN );
+		return 0;
+	}
+
 	if ( encoding == TIXML_ENCODING_UNKNOWN )
 	{
-		// Check for the Microsoft UTF-8 lead bytes.
+		// Check for the Microsoft UTF-8 lead bytes, unless the prepass
+		// has already looked at this buffer.
 		const unsigned char* pU = (const unsigned char*)p;
-		if (	*(pU+0) && *(pU+0) == TIXML_UTF_LEAD_0
-			 && *(pU+1) && *(pU+1) == TIXML_UTF_LEAD_1
-			 && *(pU+2) && *(pU+2) == TIXML_UTF_LEAD_2 )
+		const bool bom = ( prepass && prepass->Text() == p )
+						 ? prepass->Bom()
+						 : (	*(pU+0) && *(pU+0) == TIXML_UTF_LEAD_0
+							 && *(pU+1) && *(pU+1) == TIXML_UTF_LEAD_1
+							 && *(pU+2) && *(pU+2) == TIXML_UTF_LEAD_2 );
+		if ( bom )
 		{
 			encoding = TIXML_ENCODING_UTF8;
 			useMicrosoftBOM = true;
@@ -751,13 +1067,45 @@ const char* TiXmlDocument::Parse( const char* p, TiXmlParsingData* prevData, TiX
 		return 0;
 	}
 
+	// A declaration that isn't kept is parsed here instead, for its encoding.
+	TiXmlDeclaration unkeptDeclaration;
+	unkeptDeclaration.parent = this;
+	bool leftOut = false;
+
 	while ( p && *p )
 	{
-		TiXmlNode* node = Identify( p, encoding );
+		const char* skipped = SkipUnkept( p, data.Keep(), encoding );
+		if (    !skipped
+			 && data.Paths()
+			 && *p == '<'
+			 && ( IsAlpha( *(p+1), encoding ) || *(p+1) == '_' )
+			 && SelectElement( p, data.Paths(), TIXML_STRING(), encoding ) == SELECT_NONE )
+		{
+			// A root element off every selected path.
+			skipped = SkipElement( p, encoding );
+		}
+		if ( skipped )
+		{
+			leftOut = true;
+			p = SkipWhiteSpace( skipped, encoding );
+			continue;
+		}
+
+		TiXmlNode* node = 0;
+		if (    !( data.Keep() & TiXmlParseOptions::KEEP_DECLARATIONS )
+			 && *(p+1) == '?'
+			 && StringEqual( p, "<?xml", true, encoding ) )
+		{
+			node = &unkeptDeclaration;
+		}
+		else
+		{
+			node = Identify( p, encoding, data.Storage() );
+		}
+
 		if ( node )
 		{
 			p = node->Parse( p, &data, encoding );
-			LinkEndChild( node );
 		}
 		else
 		{
@@ -782,24 +1130,100 @@ const char* TiXmlDocument::Parse( const char* p, TiXmlParsingData* prevData, TiX
 				encoding = TIXML_ENCODING_LEGACY;
 		}
 
+		if ( node != &unkeptDeclaration )
+		{
+			LinkEndChild( node );
+			// Elements count themselves as they are read.
+			if ( !node->ToElement() && !data.Account( node, p, encoding ) )
+				return 0;
+		}
+		else
+		{
+			leftOut = true;
+		}
+
 		p = SkipWhiteSpace( p, encoding );
 	}
 
-	// Was this empty?
-	if ( !firstChild ) {
+	// Was this empty? (Markup that was left out still counts.)
+	if ( !firstChild && !leftOut ) {
 		SetError( TIXML_ERROR_DOCUMENT_EMPTY, 0, 0, encoding );
 		return 0;
 	}
 
+	if ( parseOptions.validateUtf8 && encoding != TIXML_ENCODING_LEGACY )
+	{
+		// LoadFile()'s pass has already looked; otherwise look now.
+		size_t invalid = TiXmlPrepass::NPOS;
+		if ( prepass && prepass->Text() == data.begin )
+		{
+			invalid = prepass->InvalidUtf8();
+		}
+		else
+		{
+			TiXmlPrepass check( false );
+			check.Run( const_cast< char* >( data.begin ), strlen( data.begin ), false );
+			invalid = check.InvalidUtf8();
+		}
+		if ( invalid != TiXmlPrepass::NPOS )
+		{
+			// The parse has gone past the bad byte, so the cursor goes back.
+			data.Locate( data.begin + invalid, encoding );
+			SetError( TIXML_ERROR_INVALID_UTF8, data.begin + invalid, &data, encoding );
+			return 0;
+		}
+	}
+
+	// The elements have their hashes; the top level nodes get theirs now.
+	if ( parseOptions.hashNodes )
+		Hash();
+
 	// All is well.
 	return p;
 }
 
+const char* TiXmlDocument::ParseElement( const char* p, TiXmlEncoding encoding )
+{
+	ClearError();
+	location.Clear();
+	location.row = 0;
+	location.col = 0;
+	if ( !p || !*p )
+	{
+		SetError( TIXML_ERROR_DOCUMENT_EMPTY, 0, 0, TIXML_ENCODING_UNKNOWN );
+		return 0;
+	}
+
+	TiXmlParsingData data( this, p, parseOptions, 0, 0 );
+	location = data.Cursor();
+
+	p = SkipWhiteSpace( p, encoding );
+	TiXmlNode* node = ( p && *p == '<' ) ? Identify( p, encoding, data.Storage() ) : 0;
+	if ( !node || !node->ToElement() )
+	{
+		if ( node )
+			Destroy( node );
+		SetError( TIXML_ERROR_PARSING_ELEMENT, p, &data, encoding );
+		return 0;
+	}
+
+	p = node->Parse( p, &data, encoding );
+	LinkEndChild( node );
+	if ( Error() )
+		return 0;
+
+	if ( parseOptions.hashNodes )
+		Hash();
+	return p;
+}
+
 void TiXmlDocument::SetError( int err, const char* pError, TiXmlParsingData* data, TiXmlEncoding encoding )
 {	
 	// The first error in a chain is more accurate - don't set again!
 	if ( error )
 		return;
+	if ( observer )
+		errorTime = TiXmlParseObserver::Now();
 
 	assert( err > 0 && err < TIXML_ERROR_STRING_COUNT );
 	error   = true;
@@ -815,7 +1239,178 @@ void TiXmlDocument::SetError( int err, const char* pError, TiXmlParsingData* dat
 }
 
 
-TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
+const char* TiXmlNode::SkipUnkept( const char* p, int keep, TiXmlEncoding encoding )
+{
+	// The same tests as Identify(). Elements, the common case, are ruled out
+	// first: none of the other kinds start with a letter. Declarations and
+	// CDATA are never skipped here.
+	if (    *p != '<'
+		 || IsAlpha( *(p+1), encoding )
+		 || *(p+1) == '_'
+		 || StringEqual( p, "<?xml", true, encoding )
+		 || StringEqual( p, "<![CDATA[", false, encoding ) )
+	{
+		return 0;
+	}
+
+	if ( StringEqual( p, "<!--", false, encoding ) )
+	{
+		if ( keep & TiXmlParseOptions::KEEP_COMMENTS )
+			return 0;
+
+		// Where TiXmlComment::Parse() would stop: past the first "-->", or at the end.
+		const char* end = strstr( p+4, "-->" );
+		return end ? end+3 : p+4 + strlen( p+4 );
+	}
+
+	if ( keep & TiXmlParseOptions::KEEP_UNKNOWNS )
+		return 0;
+
+	// Where TiXmlUnknown::Parse() would stop: past the first '>', or at the end.
+	const char* end = strchr( p+1, '>' );
+	return end ? end+1 : p+1 + strlen( p+1 );
+}
+
+
+// Reads past the comment, CDATA section, end tag or other non-element markup
+// at 'p', to where the DOM parser would stop. Returns the end of the input if
+// it isn't closed.
+static const char* TiXmlSkipMarkup( const char* p )
+{
+	const char* end = 0;
+	if ( strncmp( p, "<!--", 4 ) == 0 )
+	{
+		end = strstr( p+4, "-->" );
+		return end ? end+3 : p + strlen( p );
+	}
+	if ( strncmp( p, "<![CDATA[", 9 ) == 0 )
+	{
+		end = strstr( p+9, "]]>" );
+		return end ? end+3 : p + strlen( p );
+	}
+	end = strchr( p+1, '>' );
+	return end ? end+1 : p + strlen( p );
+}
+
+
+int TiXmlNode::SelectElement( const char* p, const char* const* paths, const TIXML_STRING& path, TiXmlEncoding encoding )
+{
+	// The name, as ReadName() would read it, but without copying it.
+	const char* name = p+1;
+	const char* nameEnd = name;
+	while (		*nameEnd
+			&&	(		IsAlphaNum( (unsigned char ) *nameEnd, encoding )
+					 || *nameEnd == '_'
+					 || *nameEnd == '-'
+					 || *nameEnd == '.'
+					 || *nameEnd == ':' ) )
+	{
+		++nameEnd;
+	}
+	const size_t nameLength = nameEnd - name;
+
+	int selection = SELECT_NONE;
+	for ( ; *paths; ++paths )
+	{
+		const char* step = *paths;
+		if ( *step == '/' )
+			++step;
+
+		if ( path.length() )
+		{
+			if (    strncmp( step, path.c_str(), path.length() ) != 0
+				 || step[ path.length() ] != '/' )
+			{
+				continue;
+			}
+			step += path.length() + 1;
+		}
+
+		if ( strncmp( step, name, nameLength ) == 0 )
+		{
+			if ( step[ nameLength ] == 0 )
+				return SELECT_BRANCH;
+			if ( step[ nameLength ] == '/' )
+				selection = SELECT_ANCESTOR;
+		}
+	}
+	return selection;
+}
+
+
+const char* TiXmlNode::SkipElement( const char* p, TiXmlEncoding encoding )
+{
+	int depth = 0;
+	while ( *p )
+	{
+		if ( *p != '<' )
+		{
+			// Text: entities and white space don't matter here.
+			const char* next = strchr( p, '<' );
+			if ( !next )
+				break;
+			p = next;
+		}
+		else if ( IsAlpha( *(p+1), encoding ) || *(p+1) == '_' )
+		{
+			// A start tag. Look for its end, outside of quoted values.
+			char quote = 0;
+			++p;
+			while ( *p && ( quote || *p != '>' ) )
+			{
+				if ( quote )
+				{
+					if ( *p == quote )
+						quote = 0;
+				}
+				else if ( *p == '\"' || *p == '\'' )
+				{
+					quote = *p;
+				}
+				++p;
+			}
+			if ( !*p )
+				break;
+			if ( *(p-1) != '/' )
+				++depth;
+			else if ( depth == 0 )
+				return p+1;		// the element was empty
+			++p;
+		}
+		else if ( *(p+1) == '/' )
+		{
+			p = TiXmlSkipMarkup( p );
+			if ( --depth == 0 )
+				return p;
+		}
+		else
+		{
+			p = TiXmlSkipMarkup( p );
+		}
+	}
+	return p + strlen( p );
+}
+
+
+const char* TiXmlNode::SkipUnselected( const char* p, const char* const* paths, const TIXML_STRING& path, int* selection, TiXmlEncoding encoding )
+{
+	if ( *p != '<' )
+	{
+		// The text of an element that only leads to the selection.
+		const char* next = strchr( p, '<' );
+		return next ? next : p + strlen( p );
+	}
+	if ( !IsAlpha( *(p+1), encoding ) && *(p+1) != '_' )
+		return TiXmlSkipMarkup( p );
+
+	*selection = SelectElement( p, paths, path, encoding );
+	if ( *selection == SELECT_NONE )
+		return SkipElement( p, encoding );
+	return 0;
+}
+
+
+TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding, TiXmlStorage* storage )
 {
 	TiXmlNode* returnNode = 0;
 
@@ -849,21 +1444,21 @@ TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Declaration\n" );
 		#endif
-		returnNode = new TiXmlDeclaration();
+		returnNode = storage ? storage->NewNode( TINYXML_DECLARATION ) : new TiXmlDeclaration();
 	}
 	else if ( StringEqual( p, commentHeader, false, encoding ) )
 	{
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Comment\n" );
 		#endif
-		returnNode = new TiXmlComment();
+		returnNode = storage ? storage->NewNode( TINYXML_COMMENT ) : new TiXmlComment();
 	}
 	else if ( StringEqual( p, cdataHeader, false, encoding ) )
 	{
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing CDATA\n" );
 		#endif
-		TiXmlText* text = new TiXmlText( "" );
+		TiXmlText* text = storage ? storage->NewNode( TINYXML_TEXT )->ToText() : new TiXmlText( "" );
 		text->SetCDATA( true );
 		returnNode = text;
 	}
@@ -872,7 +1467,7 @@ TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Unknown(1)\n" );
 		#endif
-		returnNode = new TiXmlUnknown();
+		returnNode = storage ? storage->NewNode( TINYXML_UNKNOWN ) : new TiXmlUnknown();
 	}
 	else if (    IsAlpha( *(p+1), encoding )
 			  || *(p+1) == '_' )
@@ -880,14 +1475,14 @@ TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Element\n" );
 		#endif
-		returnNode = new TiXmlElement( "" );
+		returnNode = storage ? storage->NewNode( TINYXML_ELEMENT ) : new TiXmlElement( "" );
 	}
 	else
 	{
 		#ifdef DEBUG_PARSER
 			TIXML_LOG( "XML parsing Unknown(2)\n" );
 		#endif
-		returnNode = new TiXmlUnknown();
+		returnNode = storage ? storage->NewNode( TINYXML_UNKNOWN ) : new TiXmlUnknown();
 	}
 
 	if ( returnNode )
@@ -900,24 +1495,21 @@ TiXmlNode* TiXmlNode::Identify( const char* p, TiXmlEncoding encoding )
 
 #ifdef TIXML_USE_STL
 
-void TiXmlElement::StreamIn (std::istream * in, TIXML_STRING * tag)
+void TiXmlElement::StreamIn (TiXmlStreamReader * in, TIXML_STRING * tag)
 {
 	// We're called with some amount of pre-parsing. That is, some of "this"
 	// element is in "tag". Go ahead and stream to the closing ">"
-	while( in->good() )
+	if ( in->good() )
 	{
-		int c = in->get();
-		if ( c <= 0 )
+		if ( in->AppendTo( '>', tag ) != '>' )
 		{
+			in->get();
 			TiXmlDocument* document = GetDocument();
 			if ( document )
 				document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
 			return;
 		}
-		(*tag) += (char) c ;
-		
-		if ( c == '>' )
-			break;
+		(*tag) += (char) in->get();
 	}
 
 	if ( tag->length() < 3 ) return;
@@ -949,6 +1541,16 @@ void TiXmlElement::StreamIn (std::istream * in, TIXML_STRING * tag)
 				TiXmlText text( "" );
 				text.StreamIn( in, tag );
 
+				// It stops short of a null, which would otherwise stop us
+				// here forever.
+				if ( in->peek() == 0 )
+				{
+					TiXmlDocument* document = GetDocument();
+					if ( document )
+						document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
+					return;
+				}
+
 				// What follows text is a closing tag or another node.
 				// Go around again and figure it out.
 				continue;
@@ -962,6 +1564,7 @@ void TiXmlElement::StreamIn (std::istream * in, TIXML_STRING * tag)
 
 			bool closingTag = false;
 			bool firstCharFound = false;
+			size_t lastOpen = tagIndex;		// the last '<' in the tag
 
 			for( ;; )
 			{
@@ -982,6 +1585,8 @@ void TiXmlElement::StreamIn (std::istream * in, TIXML_STRING * tag)
 
 				*tag += (char) c;
 				in->get();
+				if ( c == '<' )
+					lastOpen = tag->size() - 1;
 
 				// Early out if we find the CDATA id.
 				if ( c == '[' && tag->size() >= 9 )
@@ -1000,6 +1605,25 @@ void TiXmlElement::StreamIn (std::istream * in, TIXML_STRING * tag)
 					if ( c == '/' )
 						closingTag = true;
 				}
+
+				// Once what follows the last '<' can't be the start of a CDATA
+				// id, the tag can be read in one go up to its end or the next
+				// '<', which goes through the loop above as the early out
+				// needs.
+				if (    firstCharFound
+					 && strncmp( tag->c_str() + lastOpen, "<![CDATA[", tag->size() - lastOpen ) != 0 )
+				{
+					const int stop = in->AppendTo( '>', tag, '<' );
+					if ( stop <= 0 )
+					{
+						TiXmlDocument* document = GetDocument();
+						if ( document )
+							document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
+						return;
+					}
+					if ( stop == '>' )
+						break;
+				}
 			}
 			// If it was a closing tag, then read in the closing '>' to clean up the input stream.
 			// If it was not, the streaming will be done by the tag.
@@ -1040,10 +1664,10 @@ void TiXmlElement::StreamIn (std::istream * in, TIXML_STRING * tag)
 }
 #endif
 
-const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
+const char* TiXmlElement::ReadStartTag( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding, TiXmlDocument* document, bool* closed )
 {
+	*closed = false;
 	p = SkipWhiteSpace( p, encoding );
-	TiXmlDocument* document = GetDocument();
 
 	if ( !p || !*p )
 	{
@@ -1075,11 +1699,8 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 		return 0;
 	}
 
-    TIXML_STRING endTag ("</");
-	endTag += value;
-
 	// Check for and read attributes. Also look for an empty
-	// tag or an end tag.
+	// tag or the end of the start tag.
 	while ( p && *p )
 	{
 		pErr = p;
@@ -1098,48 +1719,21 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 				if ( document ) document->SetError( TIXML_ERROR_PARSING_EMPTY, p, data, encoding );		
 				return 0;
 			}
+			*closed = true;
 			return (p+1);
 		}
 		else if ( *p == '>' )
 		{
 			// Done with attributes (if there were any.)
-			// Read the value -- which can include other
-			// elements -- read the end tag, and return.
-			++p;
-			p = ReadValue( p, data, encoding );		// Note this is an Element method, and will set the error if one happens.
-			if ( !p || !*p ) {
-				// We were looking for the end tag, but found nothing.
-				// Fix for [ 1663758 ] Failure to report error on bad XML
-				if ( document ) document->SetError( TIXML_ERROR_READING_END_TAG, p, data, encoding );
-				return 0;
-			}
-
-			// We should find the end tag now
-			// note that:
-			// </foo > and
-			// </foo> 
-			// are both valid end tags.
-			if ( StringEqual( p, endTag.c_str(), false, encoding ) )
-			{
-				p += endTag.length();
-				p = SkipWhiteSpace( p, encoding );
-				if ( p && *p && *p == '>' ) {
-					++p;
-					return p;
-				}
-				if ( document ) document->SetError( TIXML_ERROR_READING_END_TAG, p, data, encoding );
-				return 0;
-			}
-			else
-			{
-				if ( document ) document->SetError( TIXML_ERROR_READING_END_TAG, p, data, encoding );
-				return 0;
-			}
+			// The value -- which can include other elements --
+			// and the end tag follow.
+			return (p+1);
 		}
 		else
 		{
 			// Try to read an attribute:
-			TiXmlAttribute* attrib = new TiXmlAttribute();
+			TiXmlStorage* storage = data ? data->Storage() : 0;
+			TiXmlAttribute* attrib = storage ? storage->NewAttribute() : new TiXmlAttribute();
 			if ( !attrib )
 			{
 				return 0;
@@ -1152,7 +1746,7 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 			if ( !p || !*p )
 			{
 				if ( document ) document->SetError( TIXML_ERROR_PARSING_ELEMENT, pErr, data, encoding );
-				delete attrib;
+				TiXmlDiscard( attrib, storage );
 				return 0;
 			}
 
@@ -1165,7 +1759,7 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 			if ( node )
 			{
 				if ( document ) document->SetError( TIXML_ERROR_PARSING_ELEMENT, pErr, data, encoding );
-				delete attrib;
+				TiXmlDiscard( attrib, storage );
 				return 0;
 			}
 
@@ -1176,105 +1770,295 @@ const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 }
 
 
-const char* TiXmlElement::ReadValue( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
+void TiXmlElement::LinkParsedChild( TiXmlNode* node )
 {
-	TiXmlDocument* document = GetDocument();
+	node->parent = this;
+	node->prev = lastChild;
+	node->next = 0;
+
+	if ( lastChild )
+		lastChild->next = node;
+	else
+		firstChild = node;
+	lastChild = node;
+}
+
+
+const char* TiXmlElement::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
+{
+	// Parsing into a node that is already in a tree (with operator>>, say)
+	// changes the tree.
+	InvalidateHash();
+	TiXmlDocument* document = data ? data->Document() : GetDocument();
+	const int maxDepth = document ? document->MaxDepth() : 0;
+	const bool condense = TiXmlCondenseWhiteSpace( data, document );
+	const int keep = TiXmlKeep( data, document );
+	const bool hashNodes = data && data->HashNodes();
+	TiXmlStorage* storage = data ? data->Storage() : 0;
+	TiXmlNameTable* names = data ? data->Names() : 0;
+	TiXmlNamespaceScope scope( names );
+
+	// When only some paths are built, the root element may just lead to them.
+	const char* const* paths = ( data && parent && parent == data->Document() ) ? data->Paths() : 0;
+	int selection = SELECT_BRANCH;
+	if ( paths )
+	{
+		const char* start = SkipWhiteSpace( p, encoding );
+		selection = ( start && *start == '<' ) ? SelectElement( start, paths, TIXML_STRING(), encoding ) : SELECT_NONE;
+	}
+
+	bool closed = false;
+	const char* start = p;
+	p = ReadStartTag( p, data, encoding, document, &closed );
+	if ( p && data && !data->Account( this, p, encoding ) )
+		return 0;
+	if ( p && names && !scope.Open( this ) )
+	{
+		if ( document ) document->SetError( TIXML_ERROR_UNDECLARED_PREFIX, start, data, encoding );
+		return 0;
+	}
+	if ( !p || closed )
+		return p;
+
+	// The content of this element, and of every element inside it, is read
+	// by this loop rather than by recursion, so deep documents can't run
+	// out of stack. 'element' is the innermost open element; the chain of
+	// parents back up to 'this' is the stack.
+	TiXmlElement* element = this;
+	int depth = 1;
+
+	// Everything is built from 'selectedDepth' down. While it is 0 the open
+	// elements only lead to the selected paths, and 'path' is where they are.
+	int selectedDepth = 1;
+	TIXML_STRING path;
+	if ( selection != SELECT_BRANCH )
+	{
+		selectedDepth = 0;
+		path = value;
+	}
+
+	// Markup the KEEP_ flags leave out is read past, or parsed into this
+	// declaration, rather than allocated.
+	const char* skipped = 0;
+	TiXmlDeclaration unkeptDeclaration;
+	unkeptDeclaration.parent = this;
 
 	// Read in text and elements in any order.
 	const char* pWithWhiteSpace = p;
 	p = SkipWhiteSpace( p, encoding );
 
-	while ( p && *p )
+	for( ;; )
 	{
-		if ( *p != '<' )
+		while ( p && *p && !( *p == '<' && *(p+1) == '/' ) )
 		{
-			// Take what we have, make a text element.
-			TiXmlText* textNode = new TiXmlText( "" );
-
-			if ( !textNode )
+			if ( !selectedDepth && ( skipped = SkipUnselected( p, paths, path, &selection, encoding ) ) != 0 )
 			{
-			    return 0;
+				p = skipped;
 			}
-
-			if ( TiXmlBase::IsWhiteSpaceCondensed() )
+			else if ( *p != '<' )
 			{
-				p = textNode->Parse( p, data, encoding );
+				// Take what we have, make a text element.
+				TiXmlText* textNode = storage ? storage->NewNode( TINYXML_TEXT )->ToText() : new TiXmlText( "" );
+
+				if ( !textNode )
+				{
+					return 0;
+				}
+
+				if ( condense )
+				{
+					p = textNode->Parse( p, data, encoding );
+				}
+				else
+				{
+					// Special case: we want to keep the white space
+					// so that leading spaces aren't removed.
+					p = textNode->Parse( pWithWhiteSpace, data, encoding );
+				}
+
+				if ( !textNode->Blank() )
+				{
+					element->LinkParsedChild( textNode );
+					if ( p && data && !data->Account( textNode, p, encoding ) )
+						return 0;
+				}
+				else
+				{
+					TiXmlDiscard( textNode, storage );
+				}
 			}
-			else
+			else if ( ( skipped = SkipUnkept( p, keep, encoding ) ) != 0 )
 			{
-				// Special case: we want to keep the white space
-				// so that leading spaces aren't removed.
-				p = textNode->Parse( pWithWhiteSpace, data, encoding );
+				p = skipped;
 			}
-
-			if ( !textNode->Blank() )
-				LinkEndChild( textNode );
-			else
-				delete textNode;
-		} 
-		else 
-		{
-			// We hit a '<'
-			// Have we hit a new element or an end tag? This could also be
-			// a TiXmlText in the "CDATA" style.
-			if ( StringEqual( p, "</", false, encoding ) )
+			else if (    !( keep & TiXmlParseOptions::KEEP_DECLARATIONS )
+					  && *(p+1) == '?'
+					  && StringEqual( p, "<?xml", true, encoding ) )
 			{
-				return p;
+				p = unkeptDeclaration.Parse( p, data, encoding );
 			}
 			else
 			{
-				TiXmlNode* node = Identify( p, encoding );
-				if ( node )
+				// We hit a '<'. This is a new element, or some other node
+				// (including a TiXmlText in the "CDATA" style.)
+				TiXmlNode* node = element->Identify( p, encoding, storage );
+				if ( !node )
 				{
-					p = node->Parse( p, data, encoding );
-					LinkEndChild( node );
-				}				
+					if ( document ) document->SetError( TIXML_ERROR_READING_END_TAG, 0, data, encoding );
+					return 0;
+				}
+
+				TiXmlElement* child = node->ToElement();
+				if ( child )
+				{
+					if ( maxDepth > 0 && depth >= maxDepth )
+					{
+						if ( document ) document->SetError( TIXML_ERROR_DEPTH_EXCEEDED, p, data, encoding );
+						TiXmlDiscard( child, storage );
+						return 0;
+					}
+
+					start = p;
+					p = child->ReadStartTag( p, data, encoding, document, &closed );
+					element->LinkParsedChild( child );
+					if ( p && data && !data->Account( child, p, encoding ) )
+						return 0;
+					if ( p && names )
+					{
+						if ( !scope.Open( child ) )
+						{
+							if ( document ) document->SetError( TIXML_ERROR_UNDECLARED_PREFIX, start, data, encoding );
+							return 0;
+						}
+						if ( closed )
+							scope.Close();
+					}
+					if ( p && !closed )
+					{
+						// Descend: the child's content comes next.
+						element = child;
+						++depth;
+
+						if ( !selectedDepth )
+						{
+							if ( selection == SELECT_BRANCH )
+							{
+								selectedDepth = depth;
+							}
+							else
+							{
+								path += "/";
+								path += child->Value();
+							}
+						}
+					}
+				}
 				else
 				{
-					return 0;
+					p = node->Parse( p, data, encoding );
+					element->LinkParsedChild( node );
+					if ( p && data && !data->Account( node, p, encoding ) )
+						return 0;
 				}
 			}
+			pWithWhiteSpace = p;
+			p = SkipWhiteSpace( p, encoding );
+		}
+
+		if ( !p )
+		{
+			if ( document ) document->SetError( TIXML_ERROR_READING_ELEMENT_VALUE, 0, 0, encoding );
+			return 0;
+		}
+		if ( !*p )
+		{
+			// We were looking for the end tag, but found nothing.
+			// Fix for [ 1663758 ] Failure to report error on bad XML
+			if ( document ) document->SetError( TIXML_ERROR_READING_END_TAG, p, data, encoding );
+			return 0;
 		}
+
+		// We should find the end tag of 'element' now. Note that:
+		// </foo > and
+		// </foo> 
+		// are both valid end tags.
+		const char* q = p+2;
+		const char* name = element->value.c_str();
+		while ( *name && *q == *name )
+		{
+			++q;
+			++name;
+		}
+		if ( *name )
+		{
+			if ( document ) document->SetError( TIXML_ERROR_READING_END_TAG, p, data, encoding );
+			return 0;
+		}
+		p = SkipWhiteSpace( q, encoding );
+		if ( !p || !*p || *p != '>' )
+		{
+			if ( document ) document->SetError( TIXML_ERROR_READING_END_TAG, p, data, encoding );
+			return 0;
+		}
+		++p;
+
+		// Hash each element while its content is still in the cache. Its
+		// child elements already have theirs; Hash() adds the rest.
+		if ( hashNodes )
+			element->Hash();
+
+		if ( element == this )
+			return p;
+
+		if ( depth == selectedDepth )
+		{
+			// The end of a selected branch: back among its ancestors.
+			selectedDepth = 0;
+		}
+		else if ( !selectedDepth )
+		{
+			const char* start = path.c_str();
+			const char* slash = start + path.length();
+			while ( slash > start && *slash != '/' )
+				--slash;
+			path = TIXML_STRING( start, slash - start );
+		}
+
+		// Pop back to the parent and carry on with its content.
+		if ( names )
+			scope.Close();
+		element = static_cast< TiXmlElement* >( element->parent );
+		--depth;
 		pWithWhiteSpace = p;
 		p = SkipWhiteSpace( p, encoding );
 	}
-
-	if ( !p )
-	{
-		if ( document ) document->SetError( TIXML_ERROR_READING_ELEMENT_VALUE, 0, 0, encoding );
-	}	
-	return p;
 }
 
 
 #ifdef TIXML_USE_STL
-void TiXmlUnknown::StreamIn( std::istream * in, TIXML_STRING * tag )
+void TiXmlUnknown::StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag )
 {
-	while ( in->good() )
-	{
-		int c = in->get();	
-		if ( c <= 0 )
-		{
-			TiXmlDocument* document = GetDocument();
-			if ( document )
-				document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
-			return;
-		}
-		(*tag) += (char) c;
+	if ( !in->good() )
+		return;
 
-		if ( c == '>' )
-		{
-			// All is well.
-			return;		
-		}
+	if ( in->AppendTo( '>', tag ) != '>' )
+	{
+		in->get();
+		TiXmlDocument* document = GetDocument();
+		if ( document )
+			document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
+		return;
 	}
+	// All is well.
+	(*tag) += (char) in->get();
 }
 #endif
 
 
 const char* TiXmlUnknown::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
 {
-	TiXmlDocument* document = GetDocument();
+	InvalidateHash();
+	TiXmlDocument* document = data ? data->Document() : GetDocument();
 	p = SkipWhiteSpace( p, encoding );
 
 	if ( data )
@@ -1307,23 +2091,22 @@ const char* TiXmlUnknown::Parse( const char* p, TiXmlParsingData* data, TiXmlEnc
 }
 
 #ifdef TIXML_USE_STL
-void TiXmlComment::StreamIn( std::istream * in, TIXML_STRING * tag )
+void TiXmlComment::StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag )
 {
 	while ( in->good() )
 	{
-		int c = in->get();	
-		if ( c <= 0 )
+		if ( in->AppendTo( '>', tag ) != '>' )
 		{
+			in->get();
 			TiXmlDocument* document = GetDocument();
 			if ( document )
 				document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
 			return;
 		}
 
-		(*tag) += (char) c;
+		(*tag) += (char) in->get();
 
-		if ( c == '>' 
-			 && tag->at( tag->length() - 2 ) == '-'
+		if (    tag->at( tag->length() - 2 ) == '-'
 			 && tag->at( tag->length() - 3 ) == '-' )
 		{
 			// All is well.
@@ -1336,7 +2119,8 @@ void TiXmlComment::StreamIn( std::istream * in, TIXML_STRING * tag )
 
 const char* TiXmlComment::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
 {
-	TiXmlDocument* document = GetDocument();
+	InvalidateHash();
+	TiXmlDocument* document = data ? data->Document() : GetDocument();
 	value = "";
 
 	p = SkipWhiteSpace( p, encoding );
@@ -1463,11 +2247,12 @@ const char* TiXmlAttribute::Parse( const char* p, TiXmlParsingData* data, TiXmlE
 }
 
 #ifdef TIXML_USE_STL
-void TiXmlText::StreamIn( std::istream * in, TIXML_STRING * tag )
+void TiXmlText::StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag )
 {
 	while ( in->good() )
 	{
-		int c = in->peek();	
+		// Text runs to the next '<'; cdata to a '>' that ends "]]>".
+		int c = in->AppendTo( cdata ? '>' : '<', tag );
 		if ( !cdata && (c == '<' ) ) 
 		{
 			return;
@@ -1496,8 +2281,9 @@ void TiXmlText::StreamIn( std::istream * in, TIXML_STRING * tag )
 
 const char* TiXmlText::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding encoding )
 {
+	InvalidateHash();
 	value = "";
-	TiXmlDocument* document = GetDocument();
+	TiXmlDocument* document = data ? data->Document() : GetDocument();
 
 	if ( data )
 	{
@@ -1535,7 +2321,7 @@ const char* TiXmlText::Parse( const char* p, TiXmlParsingData* data, TiXmlEncodi
 	}
 	else
 	{
-		bool ignoreWhite = true;
+		bool ignoreWhite = TiXmlCondenseWhiteSpace( data, document );
 
 		const char* end = "<";
 		p = ReadText( p, &value, ignoreWhite, end, false, encoding );
@@ -1546,35 +2332,31 @@ const char* TiXmlText::Parse( const char* p, TiXmlParsingData* data, TiXmlEncodi
 }
 
 #ifdef TIXML_USE_STL
-void TiXmlDeclaration::StreamIn( std::istream * in, TIXML_STRING * tag )
+void TiXmlDeclaration::StreamIn( TiXmlStreamReader * in, TIXML_STRING * tag )
 {
-	while ( in->good() )
-	{
-		int c = in->get();
-		if ( c <= 0 )
-		{
-			TiXmlDocument* document = GetDocument();
-			if ( document )
-				document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
-			return;
-		}
-		(*tag) += (char) c;
+	if ( !in->good() )
+		return;
 
-		if ( c == '>' )
-		{
-			// All is well.
-			return;
-		}
+	if ( in->AppendTo( '>', tag ) != '>' )
+	{
+		in->get();
+		TiXmlDocument* document = GetDocument();
+		if ( document )
+			document->SetError( TIXML_ERROR_EMBEDDED_NULL, 0, 0, TIXML_ENCODING_UNKNOWN );
+		return;
 	}
+	// All is well.
+	(*tag) += (char) in->get();
 }
 #endif
 
 const char* TiXmlDeclaration::Parse( const char* p, TiXmlParsingData* data, TiXmlEncoding _encoding )
 {
+	InvalidateHash();
 	p = SkipWhiteSpace( p, _encoding );
 	// Find the beginning, find the end, and look for
 	// the stuff in-between.
-	TiXmlDocument* document = GetDocument();
+	TiXmlDocument* document = data ? data->Document() : GetDocument();
 	if ( !p || !*p || !StringEqual( p, "<?xml", true, _encoding ) )
 	{
 		if ( document ) document->SetError( TIXML_ERROR_PARSING_DECLARATION, 0, 0, _encoding );
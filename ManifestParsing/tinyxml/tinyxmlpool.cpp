@@ -0,0 +1,95 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include "tinyxmlpool.h"
+
+#ifdef TIXML_USE_STL
+
+TiXmlDocumentPool::TiXmlDocumentPool( size_t _maxIdle )
+	: maxIdle( _maxIdle ), created( 0 )
+{
+}
+
+
+TiXmlDocumentPool::~TiXmlDocumentPool()
+{
+	for ( size_t i = 0; i < idle.size(); ++i )
+		delete idle[i];
+}
+
+
+TiXmlDocument* TiXmlDocumentPool::Acquire()
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		if ( !idle.empty() )
+		{
+			TiXmlDocument* doc = idle.back();
+			idle.pop_back();
+			return doc;
+		}
+		++created;
+	}
+
+	TiXmlDocument* doc = new TiXmlDocument();
+	doc->SetReuseStorage( true );
+	return doc;
+}
+
+
+void TiXmlDocumentPool::Release( TiXmlDocument* doc )
+{
+	if ( !doc )
+		return;
+
+	// Back to a new document's settings; assigning keeps the storage, and
+	// the Clear() it starts with takes the nodes back into it.
+	*doc = TiXmlDocument();
+
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		if ( !maxIdle || idle.size() < maxIdle )
+		{
+			idle.push_back( doc );
+			return;
+		}
+	}
+	delete doc;
+}
+
+
+size_t TiXmlDocumentPool::Idle() const
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	return idle.size();
+}
+
+
+size_t TiXmlDocumentPool::Created() const
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	return created;
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+
+#ifndef TINYXML_POOL_INCLUDED
+#define TINYXML_POOL_INCLUDED
+
+#ifdef TIXML_USE_STL
+
+#include <mutex>
+#include <vector>
+
+#include "tinyxml.h"
+
+/**	Documents that reuse their storage (see TiXmlDocument::SetReuseStorage()),
+	kept warm between uses and handed to whichever thread asks. A thread
+	takes a document, parses into it, reads it, and gives it back; the next
+	taker parses into storage that is already allocated.
+
+	@verbatim
+	TiXmlDocumentPool pool;
+
+	// On any thread:
+	TiXmlPooledDocument doc( pool );
+	doc->Parse( request );
+	...
+	@endverbatim
+
+	The pool is safe to use from several threads at once; each document is
+	only ever used by the thread that has it. A document is cleared when it
+	is given back, on the thread giving it back, so the pool is never held
+	for longer than it takes to push or pop a pointer.
+*/
+class TiXmlDocumentPool
+{
+public:
+	/** Keep at most 'maxIdle' documents between uses, 0 for no limit.
+		Documents given back beyond that are deleted.
+	*/
+	TiXmlDocumentPool( size_t maxIdle = 0 );
+	/// Deletes the idle documents. Every document taken must have been given back.
+	~TiXmlDocumentPool();
+
+	/** An empty document, with default parse options and no name, for the
+		caller alone until it is given back with Release().
+	*/
+	TiXmlDocument* Acquire();
+	/// Give back a document from Acquire().
+	void Release( TiXmlDocument* doc );
+
+	/// The documents waiting to be taken.
+	size_t Idle() const;
+	/// The documents the pool has made, since it has had none to hand.
+	size_t Created() const;
+
+private:
+	TiXmlDocumentPool( const TiXmlDocumentPool& );		// not implemented.
+	void operator=( const TiXmlDocumentPool& );			// not implemented.
+
+	mutable std::mutex mutex;
+	std::vector< TiXmlDocument* > idle;
+	size_t maxIdle;
+	size_t created;
+};
+
+
+/** Holds a document from a TiXmlDocumentPool for as long as it is in scope,
+	and gives it back when it goes.
+*/
+class TiXmlPooledDocument
+{
+public:
+	explicit TiXmlPooledDocument( TiXmlDocumentPool& _pool ) : pool( _pool ), doc( _pool.Acquire() ) {}
+	~TiXmlPooledDocument()				{ pool.Release( doc ); }
+
+	TiXmlDocument* Get() const			{ return doc; }
+	TiXmlDocument* operator->() const	{ return doc; }
+	TiXmlDocument& operator*() const	{ return *doc; }
+
+private:
+	TiXmlPooledDocument( const TiXmlPooledDocument& );	// not implemented.
+	void operator=( const TiXmlPooledDocument& );		// not implemented.
+
+	TiXmlDocumentPool& pool;
+	TiXmlDocument* doc;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,422 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include <string.h>
+
+#include "tinyxmlprepass.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+	#include <emmintrin.h>
+	#define TIXML_PREPASS_SSE2
+#elif defined( TIXML_PREPASS_NEON ) && ( defined( __aarch64__ ) || defined( _M_ARM64 ) )
+	// Not yet run on an ARM target, so only built when the build asks for it.
+	#include <arm_neon.h>
+#else
+	#undef TIXML_PREPASS_NEON
+#endif
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+	#include <intrin.h>
+#endif
+
+
+// The index of the lowest bit set in 'mask', which isn't 0.
+static inline unsigned TiXmlLowestBit( unsigned mask )
+{
+	#if defined( __GNUC__ ) || defined( __clang__ )
+		return (unsigned) __builtin_ctz( mask );
+	#elif defined( _MSC_VER )
+		unsigned long index;
+		_BitScanForward( &index, mask );
+		return (unsigned) index;
+	#else
+		unsigned index = 0;
+		while ( !( mask & 1 ) )
+		{
+			mask >>= 1;
+			++index;
+		}
+		return index;
+	#endif
+}
+
+
+#if defined( TIXML_PREPASS_SSE2 ) || defined( TIXML_PREPASS_NEON )
+#define TIXML_PREPASS_SIMD
+
+// A block of 16 bytes, and the few operations the pass needs on one. The
+// masks have bit i set for byte i.
+#if defined( TIXML_PREPASS_SSE2 )
+
+typedef __m128i TiXmlBlock;
+
+static inline TiXmlBlock TiXmlLoadBlock( const unsigned char* p )		{ return _mm_loadu_si128( (const __m128i*) p ); }
+static inline void TiXmlStoreBlock( unsigned char* q, TiXmlBlock v )	{ _mm_storeu_si128( (__m128i*) q, v ); }
+static inline unsigned TiXmlHighBytes( TiXmlBlock v )					{ return (unsigned) _mm_movemask_epi8( v ); }
+static inline unsigned TiXmlMatchBytes( TiXmlBlock v, char c )			{ return (unsigned) _mm_movemask_epi8( _mm_cmpeq_epi8( v, _mm_set1_epi8( c ) ) ); }
+
+static inline unsigned TiXmlRangeBytes( TiXmlBlock v, unsigned char low, unsigned char high )
+{
+	// In range when byte - low, wrapping, is at most high - low.
+	const __m128i offset = _mm_sub_epi8( v, _mm_set1_epi8( (char) low ) );
+	const __m128i over = _mm_subs_epu8( offset, _mm_set1_epi8( (char)( high - low ) ) );
+	return (unsigned) _mm_movemask_epi8( _mm_cmpeq_epi8( over, _mm_setzero_si128() ) );
+}
+
+#else
+
+typedef uint8x16_t TiXmlBlock;
+
+static inline unsigned TiXmlBlockMask( uint8x16_t set )
+{
+	// NEON has no movemask: weight each byte by its bit, then add up each half.
+	static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint8x16_t bits = vandq_u8( set, vld1q_u8( weights ) );
+	return (unsigned) vaddv_u8( vget_low_u8( bits ) ) | ( (unsigned) vaddv_u8( vget_high_u8( bits ) ) << 8 );
+}
+
+static inline TiXmlBlock TiXmlLoadBlock( const unsigned char* p )		{ return vld1q_u8( p ); }
+static inline void TiXmlStoreBlock( unsigned char* q, TiXmlBlock v )	{ vst1q_u8( q, v ); }
+static inline unsigned TiXmlHighBytes( TiXmlBlock v )					{ return TiXmlBlockMask( vcgeq_u8( v, vdupq_n_u8( 0x80 ) ) ); }
+static inline unsigned TiXmlMatchBytes( TiXmlBlock v, char c )			{ return TiXmlBlockMask( vceqq_u8( v, vdupq_n_u8( (uint8_t) c ) ) ); }
+
+static inline unsigned TiXmlRangeBytes( TiXmlBlock v, unsigned char low, unsigned char high )
+{
+	return TiXmlBlockMask( vandq_u8( vcgeq_u8( v, vdupq_n_u8( low ) ), vcleq_u8( v, vdupq_n_u8( high ) ) ) );
+}
+
+#endif
+#endif
+
+
+// The length of the UTF-8 sequence at 'p', or 0 if it isn't a valid one:
+// overlong forms, surrogates and values past U+10FFFF are all refused.
+static size_t TiXmlUtf8Length( const unsigned char* p, const unsigned char* end )
+{
+	const unsigned char lead = p[0];
+	unsigned char low = 0x80;
+	unsigned char high = 0xbf;
+	size_t length = 0;
+
+	if ( lead >= 0xc2 && lead <= 0xdf )
+	{
+		length = 2;
+	}
+	else if ( lead >= 0xe0 && lead <= 0xef )
+	{
+		length = 3;
+		if ( lead == 0xe0 )
+			low = 0xa0;
+		else if ( lead == 0xed )
+			high = 0x9f;
+	}
+	else if ( lead >= 0xf0 && lead <= 0xf4 )
+	{
+		length = 4;
+		if ( lead == 0xf0 )
+			low = 0x90;
+		else if ( lead == 0xf4 )
+			high = 0x8f;
+	}
+	else
+	{
+		return 0;
+	}
+
+	if ( (size_t)( end - p ) < length || p[1] < low || p[1] > high )
+		return 0;
+	for ( size_t i=2; i<length; ++i )
+	{
+		if ( ( p[i] & 0xc0 ) != 0x80 )
+			return 0;
+	}
+	return length;
+}
+
+
+#ifdef TIXML_PREPASS_SIMD
+// Checks the UTF-8 in a block that has no null or CR, a block at a time.
+// Returns how far the block's sequences reach: 16, or a little more when the
+// last runs past the block. Returns 0 if anything is wrong, or might be; the
+// caller then goes one sequence at a time to find out where.
+static inline unsigned TiXmlCheckBlock( TiXmlBlock v, const unsigned char* p, const unsigned char* end )
+{
+	const unsigned follow = TiXmlRangeBytes( v, 0x80, 0xbf );
+	const unsigned lead2 = TiXmlRangeBytes( v, 0xc2, 0xdf );
+	const unsigned lead3 = TiXmlRangeBytes( v, 0xe0, 0xef );
+	const unsigned lead4 = TiXmlRangeBytes( v, 0xf0, 0xf4 );
+	if ( ( follow | lead2 | lead3 | lead4 ) != TiXmlHighBytes( v ) )
+		return 0;		// C0, C1 or F5 and up, which are never valid
+
+	// Every continuation byte has to be where a lead byte says, and nowhere
+	// else. Then no lead is inside another's sequence either.
+	const unsigned needed = ( ( lead2 | lead3 | lead4 ) << 1 ) | ( ( lead3 | lead4 ) << 2 ) | ( lead4 << 3 );
+	if ( ( needed & 0xffff ) != follow )
+		return 0;
+
+	// Four leads narrow the range of the byte after them.
+	const unsigned narrowed =	  ( ( TiXmlMatchBytes( v, (char) 0xe0 ) << 1 ) & TiXmlRangeBytes( v, 0x80, 0x9f ) )
+								| ( ( TiXmlMatchBytes( v, (char) 0xed ) << 1 ) & TiXmlRangeBytes( v, 0xa0, 0xbf ) )
+								| ( ( TiXmlMatchBytes( v, (char) 0xf0 ) << 1 ) & TiXmlRangeBytes( v, 0x80, 0x8f ) )
+								| ( ( TiXmlMatchBytes( v, (char) 0xf4 ) << 1 ) & TiXmlRangeBytes( v, 0x90, 0xbf ) );
+	if ( narrowed )
+		return 0;
+
+	if ( needed < 0x10000 )
+		return 16;
+
+	// The last sequence runs past the block; check all of it.
+	const unsigned leads = lead2 | lead3 | lead4;
+	unsigned last = 15;
+	while ( !( leads & ( 1u << last ) ) )
+		--last;
+	const size_t n = TiXmlUtf8Length( p + last, end );
+	return n ? last + (unsigned) n : 0;
+}
+#endif
+
+
+// The number of CRs and LFs in the text, which is at least the number of
+// line breaks in it once normalized.
+static size_t TiXmlCountBreaks( const unsigned char* p, const unsigned char* end )
+{
+	size_t count = 0;
+	#ifdef TIXML_PREPASS_SIMD
+	for ( ; end - p >= 16; p += 16 )
+	{
+		const TiXmlBlock v = TiXmlLoadBlock( p );
+		unsigned breaks = TiXmlMatchBytes( v, '\n' ) | TiXmlMatchBytes( v, '\r' );
+		while ( breaks )
+		{
+			++count;
+			breaks &= breaks - 1;
+		}
+	}
+	#endif
+	for ( ; p < end; ++p )
+	{
+		if ( *p == '\n' || *p == '\r' )
+			++count;
+	}
+	return count;
+}
+
+
+const size_t TiXmlPrepass::NPOS = (size_t)-1;
+
+
+TiXmlPrepass::TiXmlPrepass( bool _indexLines )
+	: indexLines( _indexLines ), text( 0 ), length( 0 ), invalidUtf8( NPOS ), bom( false ), simpleColumns( true ),
+	  lineStarts( 0 ), lines( 0 ), capacity( 0 )
+{
+}
+
+
+TiXmlPrepass::~TiXmlPrepass()
+{
+	delete [] lineStarts;
+}
+
+
+// Makes room for 'count' lines, dropping any that were recorded.
+void TiXmlPrepass::Reserve( size_t count )
+{
+	if ( count > capacity )
+	{
+		delete [] lineStarts;
+		lineStarts = new size_t[ count ];
+		capacity = count;
+	}
+}
+
+
+int TiXmlPrepass::Row( size_t offset ) const
+{
+	// The last line that starts at or before 'offset'.
+	int low = 0;
+	int high = lines;
+	while ( high - low > 1 )
+	{
+		const int middle = low + ( high - low ) / 2;
+		if ( lineStarts[ middle ] <= offset )
+			low = middle;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+
+size_t TiXmlPrepass::Run( char* buffer, size_t _length, bool normalize )
+{
+	const unsigned char* const base = (const unsigned char*) buffer;
+	const unsigned char* const end = base + _length;
+	const unsigned char* p = base;		// the read head
+	unsigned char* q = (unsigned char*) buffer;	// the write head; only ever behind p when normalizing
+	const bool index = indexLines && normalize;
+
+	text = buffer;
+	lines = 0;
+	invalidUtf8 = NPOS;
+	bom = _length >= 3 && base[0] == 0xefU && base[1] == 0xbbU && base[2] == 0xbfU;
+	bool tabs = false;
+	bool high = false;
+
+	if ( index )
+	{
+		// Size the index once: growing it while the document is parsed
+		// leaves the heap in pieces.
+		Reserve( TiXmlCountBreaks( base, end ) + 1 );
+		AddLine( 0 );
+	}
+
+	for( ;; )
+	{
+		const unsigned char* limit = end;
+
+		#ifdef TIXML_PREPASS_SIMD
+		while ( end - p >= 16 )
+		{
+			const TiXmlBlock v = TiXmlLoadBlock( p );
+			unsigned stop = TiXmlMatchBytes( v, 0 );
+			if ( normalize )
+				stop |= TiXmlMatchBytes( v, '\r' );
+
+			// Everything before the first null or CR is handled here.
+			const unsigned run = stop ? TiXmlLowestBit( stop ) : 16;
+			const unsigned passed = ( 1u << run ) - 1;
+			tabs = tabs || ( TiXmlMatchBytes( v, '\t' ) & passed ) != 0;
+
+			// Check each UTF-8 sequence, skipping the ASCII between them. A
+			// valid sequence may run past the block, but never past a null
+			// or a CR.
+			unsigned sequences = TiXmlHighBytes( v ) & passed;
+			unsigned checked = 0;
+			if ( sequences )
+			{
+				high = true;
+				if ( run == 16 && ( checked = TiXmlCheckBlock( v, p, end ) ) != 0 )
+					sequences = 0;
+			}
+			while ( sequences )
+			{
+				const unsigned at = TiXmlLowestBit( sequences );
+				size_t n = TiXmlUtf8Length( p + at, end );
+				if ( !n )
+				{
+					if ( invalidUtf8 == NPOS )
+						invalidUtf8 = ( q - base ) + at;
+					n = 1;
+				}
+				checked = at + (unsigned)n;
+				sequences &= ~( ( 1u << checked ) - 1 );
+			}
+			const unsigned step = ( run == 16 && checked > 16 ) ? checked : run;
+
+			if ( q != p )
+			{
+				if ( run == 16 )
+				{
+					TiXmlStoreBlock( q, v );
+					for ( unsigned i=16; i<step; ++i )
+						q[i] = p[i];
+				}
+				else
+				{
+					memmove( q, p, run );
+				}
+			}
+			if ( index )
+			{
+				unsigned lf = TiXmlMatchBytes( v, '\n' ) & passed;
+				while ( lf )
+				{
+					AddLine( ( q - base ) + TiXmlLowestBit( lf ) + 1 );
+					lf &= lf - 1;
+				}
+			}
+			if ( run < 16 )
+			{
+				// The null or CR goes the slow way.
+				p += run;
+				q += run;
+				limit = p + 1;
+				break;
+			}
+			p += step;
+			q += step;
+		}
+		#endif
+
+		// One byte, or one UTF-8 sequence, at a time.
+		while ( p < limit && *p )
+		{
+			const unsigned char c = *p;
+			if ( c < 0x80 )
+			{
+				if ( c == '\r' && normalize )
+				{
+					*q++ = '\n';
+					++p;
+					if ( p < end && *p == '\n' )
+						++p;
+					if ( index )
+						AddLine( q - base );
+					continue;
+				}
+				if ( c == '\n' && index )
+					AddLine( q + 1 - base );
+				if ( c == '\t' )
+					tabs = true;
+				if ( q != p )
+					*q = c;
+				++p;
+				++q;
+				continue;
+			}
+
+			high = true;
+			size_t n = TiXmlUtf8Length( p, end );
+			if ( !n )
+			{
+				if ( invalidUtf8 == NPOS )
+					invalidUtf8 = q - base;
+				n = 1;
+			}
+			if ( q != p )
+				memmove( q, p, n );
+			p += n;
+			q += n;
+		}
+
+		if ( p >= end || *p == 0 )
+			break;
+	}
+
+	length = q - base;
+	if ( normalize )
+		*q = 0;
+	simpleColumns = !tabs && !high;
+	return length;
+}
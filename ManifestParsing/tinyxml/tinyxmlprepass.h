@@ -0,0 +1,112 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+#ifndef TINYXML_PREPASS_INCLUDED
+#define TINYXML_PREPASS_INCLUDED
+
+#include <stddef.h>
+
+/*	[internal use] The one pass LoadFile() makes over a file's buffer before
+	parsing it. In the same sweep it
+
+	- normalizes line endings: CR LF and lone CRs become LF, in place;
+	- stops the buffer at the first null, as the parser would;
+	- checks that the text is valid UTF-8, noting where it first isn't;
+	- notes whether it starts with the UTF-8 byte order mark;
+	- records where each line starts, so the parser can find the row and
+	  column of a node without walking every byte before it.
+
+	The buffer is read 16 bytes at a time with SSE2 where the compiler offers
+	it. There is a NEON version for 64 bit ARM, but it has not been run on
+	one yet, so it is only built with TIXML_PREPASS_NEON defined; other ARM
+	builds take the byte at a time path. Blocks without a CR or a null, the
+	bulk of most documents, go through in a few vector operations, UTF-8
+	included; only CRs, nulls and blocks with bad or unusual UTF-8 are
+	handled a byte at a time. The bench's "prepass" measurement (4 MB
+	corpora, median of 9) on one virtual core of an Intel Xeon with SSE2
+	gives 1.4 to 3 GB/s on the mostly ASCII corpora, but only 0.6 to 1 GB/s
+	on the CRLF and multi-byte ones, where each CR and each multi-byte
+	sequence is handled on its own; the runs vary by a third from one to the
+	next. Without SIMD it runs at 0.2 to 0.3 GB/s. The line index is sized
+	by counting the line breaks first, so it never grows while the document
+	is parsed.
+*/
+class TiXmlPrepass
+{
+public:
+	/// 'indexLines' records the line starts; without it only the rest is done.
+	TiXmlPrepass( bool indexLines );
+	~TiXmlPrepass();
+
+	/*	Go over the 'length' bytes at 'buffer', which must have a byte to spare
+		at the end for the null written there. With 'normalize' the line
+		endings are rewritten in place; without it the buffer is only read
+		(and the line starts aren't recorded). Returns the length of the text
+		that was kept.
+	*/
+	size_t Run( char* buffer, size_t length, bool normalize = true );
+
+	static const size_t NPOS;
+
+	/// The text of the last Run(), and its length.
+	const char* Text() const			{ return text; }
+	size_t Length() const				{ return length; }
+	/// Where the text stops being valid UTF-8, or NPOS if it never does.
+	size_t InvalidUtf8() const			{ return invalidUtf8; }
+	/// True if the text starts with the UTF-8 byte order mark, EF BB BF.
+	bool Bom() const					{ return bom; }
+	/** True if the text is all ASCII with no tabs, so a column is just the
+		distance from the start of its line.
+	*/
+	bool SimpleColumns() const			{ return simpleColumns; }
+
+	/// The lines recorded, if any: LineStart( i ) is where row i begins.
+	int Lines() const					{ return lines; }
+	size_t LineStart( int row ) const	{ return lineStarts[ row ]; }
+	/// The row 'offset' is on. There must be lines.
+	int Row( size_t offset ) const;
+
+	/// The memory the line starts take.
+	size_t IndexBytes() const			{ return capacity * sizeof( size_t ); }
+
+private:
+	TiXmlPrepass( const TiXmlPrepass& );		// not implemented.
+	void operator=( const TiXmlPrepass& );	// not implemented.
+
+	void Reserve( size_t count );
+	void AddLine( size_t start )		{ lineStarts[ lines++ ] = start; }
+
+	bool indexLines;
+	const char* text;
+	size_t length;
+	size_t invalidUtf8;
+	bool bom;
+	bool simpleColumns;
+	size_t* lineStarts;
+	int lines;
+	size_t capacity;
+};
+
+#endif
@@ -0,0 +1,155 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include "tinyxmlpublish.h"
+
+#ifdef TIXML_USE_STL
+
+// Every access to 'current', 'epoch' and the slots' epochs is sequentially
+// consistent (bar the store that ends a read), which is what makes this
+// work: a reader stores its epoch, then loads 'current'; Publish() swaps
+// 'current', moves on the epoch, then loads the slots' epochs. If the
+// reader found the old document, its load came before the swap, so its
+// store came before Publish() looks at the slots, and Publish() sees an
+// epoch from before the one the old document was retired in. A reader
+// that read the new epoch reads the new document too.
+
+TiXmlPublishedDocument::TiXmlPublishedDocument()
+	: current( 0 ), epoch( 1 ), slots( 0 )
+{
+}
+
+
+TiXmlPublishedDocument::~TiXmlPublishedDocument()
+{
+	delete current.load();
+	for ( size_t i = 0; i < retired.size(); ++i )
+		delete retired[i].doc;
+	Slot* slot = slots.load();
+	while ( slot )
+	{
+		Slot* next = slot->next;
+		delete slot;
+		slot = next;
+	}
+}
+
+
+void TiXmlPublishedDocument::Publish( TiXmlDocument* doc )
+{
+	// Work the hashes out while the document is ours alone, so nothing a
+	// reader does to it writes to it.
+	if ( doc )
+		doc->Hash();
+
+	std::lock_guard< std::mutex > lock( mutex );
+	const TiXmlDocument* old = current.exchange( doc );
+	const unsigned long long retiredIn = ++epoch;
+	if ( old )
+	{
+		Retiree retiree = { old, retiredIn };
+		retired.push_back( retiree );
+	}
+	ReclaimLocked();
+}
+
+
+size_t TiXmlPublishedDocument::Reclaim()
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	return ReclaimLocked();
+}
+
+
+size_t TiXmlPublishedDocument::ReclaimLocked()
+{
+	if ( retired.empty() )
+		return 0;
+
+	// The oldest epoch a read still going on started in.
+	unsigned long long oldest = 0;
+	for ( Slot* slot = slots.load(); slot; slot = slot->next )
+	{
+		const unsigned long long e = slot->epoch.load();
+		if ( e && ( !oldest || e < oldest ) )
+			oldest = e;
+	}
+
+	// A document retired in an epoch no later than that can't be being read.
+	size_t kept = 0;
+	for ( size_t i = 0; i < retired.size(); ++i )
+	{
+		if ( !oldest || retired[i].epoch <= oldest )
+			delete retired[i].doc;
+		else
+			retired[kept++] = retired[i];
+	}
+	retired.resize( kept );
+	return kept;
+}
+
+
+size_t TiXmlPublishedDocument::Retired() const
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	return retired.size();
+}
+
+
+TiXmlPublishedDocument::Slot* TiXmlPublishedDocument::Claim()
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	for ( Slot* slot = slots.load(); slot; slot = slot->next )
+	{
+		if ( !slot->used.load() )
+		{
+			slot->used.store( true );
+			return slot;
+		}
+	}
+
+	// Slots are only added at the head, and never taken away until the
+	// publisher goes.
+	Slot* slot = new Slot;
+	slot->epoch.store( 0 );
+	slot->used.store( true );
+	slot->next = slots.load();
+	slots.store( slot );
+	return slot;
+}
+
+
+TiXmlDocumentSubscription::TiXmlDocumentSubscription( TiXmlPublishedDocument& _publisher )
+	: publisher( _publisher ), slot( _publisher.Claim() )
+{
+}
+
+
+TiXmlDocumentSubscription::~TiXmlDocumentSubscription()
+{
+	slot->epoch.store( 0 );
+	slot->used.store( false );
+}
+
+#endif
@@ -0,0 +1,190 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#ifndef TINYXML_PUBLISH_INCLUDED
+#define TINYXML_PUBLISH_INCLUDED
+
+#ifdef TIXML_USE_STL
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "tinyxml.h"
+
+class TiXmlDocumentSubscription;
+
+/**	The current version of a document that many threads read and one
+	occasionally replaces - settings, a manifest, a routing table.
+
+	@verbatim
+	TiXmlPublishedDocument settings;
+	settings.Publish( firstDoc );
+
+	// On each reading thread, once:
+	TiXmlDocumentSubscription subscription( settings );
+	// ...and for each read:
+	{
+		TiXmlDocumentRead read( subscription );
+		const TiXmlElement* root = read->RootElement();
+		...
+	}
+
+	// On the writing thread, whenever there is a new version:
+	settings.Publish( newDoc );
+	@endverbatim
+
+	Readers never lock, and never write to anything another thread uses: a
+	read is two loads and two stores to the reader's own subscription, so
+	any number of them can go on alongside each other and alongside a
+	Publish(). Publish() swaps the new document in atomically; a read that
+	started before it goes on with the old one, and every read after it has
+	the new one.
+
+	A replaced document is deleted once no read that could have it is still
+	going on: read-copy-update, with each subscription noting the publish
+	count when its current read started. Publish() deletes the replaced
+	documents that are no longer being read; the rest wait for the next
+	Publish() or Reclaim(). A thread that holds a read for a long time holds
+	back every version published during it, not just the one it has.
+
+	Published documents are only read from then on, which is safe on any
+	number of threads at once as long as their hashes have been worked out
+	(see TiXmlDocument), so Publish() does that before swapping one in.
+*/
+class TiXmlPublishedDocument
+{
+public:
+	TiXmlPublishedDocument();
+	/// Deletes the current document and any replaced ones. No subscription may be left.
+	~TiXmlPublishedDocument();
+
+	/** Make 'doc' the current document, which may be null. The publisher
+		owns it from here on; it must not be changed or deleted by anyone
+		else. Publish() may be called from any thread, but is meant for a
+		writer that does so now and then: publishers lock each other out.
+	*/
+	void Publish( TiXmlDocument* doc );
+
+	/** Delete the replaced documents that are no longer being read.
+		Returns the number still waiting.
+	*/
+	size_t Reclaim();
+
+	/// The replaced documents not yet deleted.
+	size_t Retired() const;
+	/// The number of times Publish() has been called.
+	unsigned long long Version() const	{ return epoch.load() - 1; }
+
+private:
+	TiXmlPublishedDocument( const TiXmlPublishedDocument& );	// not implemented.
+	void operator=( const TiXmlPublishedDocument& );			// not implemented.
+
+	friend class TiXmlDocumentSubscription;
+
+	// One per subscription, reused once that subscription has gone.
+	struct Slot
+	{
+		std::atomic< unsigned long long > epoch;	// when the current read began, 0 if none
+		std::atomic< bool > used;
+		Slot* next;
+		char padding[64];		// keep each slot to itself in the cache
+	};
+
+	struct Retiree
+	{
+		const TiXmlDocument* doc;
+		unsigned long long epoch;	// the first epoch it can't be read in
+	};
+
+	Slot* Claim();
+	size_t ReclaimLocked();
+
+	std::atomic< const TiXmlDocument* > current;
+	std::atomic< unsigned long long > epoch;	// one more than the publishes so far
+	std::atomic< Slot* > slots;
+	mutable std::mutex mutex;					// guards 'retired' and adding slots
+	std::vector< Retiree > retired;
+};
+
+
+/** One thread's reads of a TiXmlPublishedDocument. Making one takes a lock
+	once, so make one per thread and keep it, rather than one per read. It
+	may only be used by one thread at a time, for one read at a time, and
+	must go before its publisher does.
+*/
+class TiXmlDocumentSubscription
+{
+public:
+	explicit TiXmlDocumentSubscription( TiXmlPublishedDocument& publisher );
+	~TiXmlDocumentSubscription();
+
+	/** Start a read: the current document, which stays valid until
+		Release(). Null if nothing has been published.
+	*/
+	const TiXmlDocument* Acquire()
+	{
+		// Say which epoch we're in before looking, so a Publish() that
+		// replaces what we find will see that we may have it.
+		slot->epoch.store( publisher.epoch.load() );
+		return publisher.current.load();
+	}
+
+	/// End the read; the document from Acquire() mustn't be used after this.
+	void Release()		{ slot->epoch.store( 0, std::memory_order_release ); }
+
+private:
+	TiXmlDocumentSubscription( const TiXmlDocumentSubscription& );	// not implemented.
+	void operator=( const TiXmlDocumentSubscription& );				// not implemented.
+
+	TiXmlPublishedDocument& publisher;
+	TiXmlPublishedDocument::Slot* slot;
+};
+
+
+/** A read of a TiXmlPublishedDocument through a subscription, for as long
+	as it is in scope.
+*/
+class TiXmlDocumentRead
+{
+public:
+	explicit TiXmlDocumentRead( TiXmlDocumentSubscription& _subscription )
+		: subscription( _subscription ), doc( _subscription.Acquire() ) {}
+	~TiXmlDocumentRead()						{ subscription.Release(); }
+
+	const TiXmlDocument* Get() const			{ return doc; }
+	const TiXmlDocument* operator->() const		{ return doc; }
+	const TiXmlDocument& operator*() const		{ return *doc; }
+
+private:
+	TiXmlDocumentRead( const TiXmlDocumentRead& );		// not implemented.
+	void operator=( const TiXmlDocumentRead& );			// not implemented.
+
+	TiXmlDocumentSubscription& subscription;
+	const TiXmlDocument* doc;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,622 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include "tinyxmlreader.h"
+
+FILE* TiXmlFOpen( const char* filename, const char* mode );
+class TiXmlPrepass;
+char* TiXmlReadFile( FILE* file, size_t maxBytes, long* length, int* errorId, long* fileLength = 0, unsigned long long* readEnd = 0, TiXmlPrepass* prepass = 0 );
+
+
+TiXmlReader::TiXmlReader( const char* xml, TiXmlEncoding _encoding )
+	: ownedBuffer( 0 ), observer( 0 ),
+	  attributeOffsets( 0 ), attributeCapacity( 0 ),
+	  openOffsets( 0 ), openCapacity( 0 )
+{
+	Reset( xml, _encoding );
+}
+
+
+TiXmlReader::TiXmlReader( const char* xml, const TiXmlParseOptions& options )
+	: ownedBuffer( 0 ), parseOptions( options ), observer( 0 ),
+	  attributeOffsets( 0 ), attributeCapacity( 0 ),
+	  openOffsets( 0 ), openCapacity( 0 )
+{
+	Reset( xml, options.encoding );
+}
+
+
+TiXmlReader::TiXmlReader()
+	: ownedBuffer( 0 ), observer( 0 ),
+	  attributeOffsets( 0 ), attributeCapacity( 0 ),
+	  openOffsets( 0 ), openCapacity( 0 )
+{
+	Reset( 0 );
+}
+
+
+TiXmlReader::~TiXmlReader()
+{
+	Release();
+	delete [] attributeOffsets;
+	delete [] openOffsets;
+}
+
+
+void TiXmlReader::Reset( const char* xml, TiXmlEncoding _encoding )
+{
+	if ( ownedBuffer && xml != ownedBuffer )
+		Release();
+
+	readStart = ( observer && xml ) ? TiXmlParseObserver::Now() : 0;
+	start = p = tokenStart = xml;
+	encoding = _encoding;
+	condense = parseOptions.CondenseWhiteSpace();
+	token = TOKEN_NONE;
+	pendingEnd = cdata = emptyElement = sawNode = false;
+	depth = 0;
+	attributeCount = 0;
+	name = "";
+	text = "";
+	attributes = "";
+	openNames = "";
+	errorId = TiXmlBase::TIXML_NO_ERROR;
+	errorLocation.Clear();
+	located = 0;
+
+	// Check for the Microsoft UTF-8 lead bytes, as TiXmlDocument::Parse() does.
+	const unsigned char* pU = (const unsigned char*)xml;
+	if (    pU && encoding == TIXML_ENCODING_UNKNOWN
+		 && pU[0] == 0xefU && pU[1] == 0xbbU && pU[2] == 0xbfU )
+	{
+		encoding = TIXML_ENCODING_UTF8;
+	}
+
+	if ( xml && parseOptions.maxBytes )
+	{
+		// Look no further than one byte past the limit, as the DOM parser does.
+		size_t length = 0;
+		while ( length <= parseOptions.maxBytes && xml[length] )
+			++length;
+		if ( length > parseOptions.maxBytes )
+			SetError( TiXmlBase::TIXML_ERROR_DOCUMENT_TOO_LARGE, 0 );
+	}
+}
+
+
+bool TiXmlReader::LoadFile( const char* filename, TiXmlEncoding _encoding )
+{
+	Reset( 0 );
+
+	unsigned long long phaseStart = observer ? TiXmlParseObserver::Now() : 0;
+	FILE* file = TiXmlFOpen( filename, "rb" );
+	if ( observer )
+	{
+		const unsigned long long now = TiXmlParseObserver::Now();
+		ReportPhase( TiXmlParsePhase::PHASE_OPEN, phaseStart, now, 0 );
+		phaseStart = now;
+	}
+	if ( !file )
+	{
+		SetError( TiXmlBase::TIXML_ERROR_OPENING_FILE, 0 );
+		return false;
+	}
+
+	int err = TiXmlBase::TIXML_NO_ERROR;
+	long length = 0;
+	long fileLength = 0;
+	unsigned long long readEnd = 0;
+	char* buf = TiXmlReadFile( file, parseOptions.maxBytes, &length, &err, &fileLength, observer ? &readEnd : 0 );
+	fclose( file );
+	if ( observer )
+	{
+		const unsigned long long now = TiXmlParseObserver::Now();
+		if ( buf )
+		{
+			ReportPhase( TiXmlParsePhase::PHASE_READ, phaseStart, readEnd, (size_t)fileLength );
+			ReportPhase( TiXmlParsePhase::PHASE_NORMALIZE, readEnd, now, (size_t)length );
+		}
+		else
+		{
+			ReportPhase( TiXmlParsePhase::PHASE_READ, phaseStart, now, 0 );
+		}
+	}
+	if ( !buf )
+	{
+		SetError( err, 0 );
+		return false;
+	}
+
+	ownedBuffer = buf;
+	Reset( buf, _encoding );
+	return true;
+}
+
+
+const char* TiXmlReader::ErrorDesc() const
+{
+	return TiXmlBase::errorString[ errorId ];
+}
+
+
+TiXmlCursor TiXmlReader::Locate( const char* where ) const
+{
+	const int tabsize = parseOptions.tabSize;
+	TiXmlCursor cursor;
+	cursor.row = cursor.col = 0;
+	if ( tabsize <= 0 )
+	{
+		cursor.row = cursor.col = -1;
+		return cursor;
+	}
+
+	const char* q = start;
+	if ( located && located <= where && locatedEncoding == encoding )
+	{
+		q = located;
+		cursor = locatedAt;
+	}
+	for ( ; q && q < where && *q; )
+	{
+		const unsigned char c = (unsigned char)*q;
+		if ( c == '\n' )
+		{
+			++cursor.row;
+			cursor.col = 0;
+			++q;
+		}
+		else if ( c == '\t' )
+		{
+			cursor.col = ( cursor.col / tabsize + 1 ) * tabsize;
+			++q;
+		}
+		else
+		{
+			int step = ( encoding == TIXML_ENCODING_UTF8 ) ? TiXmlBase::utf8ByteTable[ c ] : 1;
+			for ( int i=0; i<step && *q; ++i )
+				++q;
+			++cursor.col;
+		}
+	}
+	located = q;
+	locatedAt = cursor;
+	locatedEncoding = encoding;
+	return cursor;
+}
+
+
+TiXmlReader::Token TiXmlReader::SetError( int err, const char* where )
+{
+	assert( err > 0 && err < TiXmlBase::TIXML_ERROR_STRING_COUNT );
+	errorId = err;
+	errorLocation.Clear();
+	if ( where )
+		errorLocation = Locate( where );
+	token = TOKEN_ERROR;
+
+	if ( observer )
+	{
+		const unsigned long long now = TiXmlParseObserver::Now();
+		if ( readStart )
+			ReportPhase( TiXmlParsePhase::PHASE_PARSE, readStart, now, 0 );
+		ReportPhase( TiXmlParsePhase::PHASE_ERROR, now, now, 0 );
+		readStart = 0;
+	}
+	return token;
+}
+
+
+void TiXmlReader::ReportPhase( TiXmlParsePhase::Phase phase, unsigned long long _start, unsigned long long end, size_t bytes ) const
+{
+	TiXmlParsePhase report;
+	report.phase = phase;
+	report.start = _start;
+	report.end = end;
+	report.bytes = bytes;
+	report.nodes = 0;
+	observer->OnReaderPhase( *this, report );
+}
+
+
+void TiXmlReader::Release()
+{
+	if ( !ownedBuffer )
+		return;
+
+	const size_t bytes = observer ? strlen( ownedBuffer ) + 1 : 0;
+	const unsigned long long releaseStart = observer ? TiXmlParseObserver::Now() : 0;
+	delete [] ownedBuffer;
+	ownedBuffer = 0;
+	if ( observer )
+		ReportPhase( TiXmlParsePhase::PHASE_RELEASE, releaseStart, TiXmlParseObserver::Now(), bytes );
+}
+
+
+const char* TiXmlReader::AttributeName( int i ) const
+{
+	assert( i >= 0 && i < attributeCount );
+	return attributes.c_str() + attributeOffsets[ i ];
+}
+
+
+const char* TiXmlReader::AttributeValue( int i ) const
+{
+	const char* attrName = AttributeName( i );
+	return attrName + strlen( attrName ) + 1;
+}
+
+
+const char* TiXmlReader::Attribute( const char* attrName ) const
+{
+	for ( int i=0; i<attributeCount; ++i )
+	{
+		if ( strcmp( AttributeName( i ), attrName ) == 0 )
+			return AttributeValue( i );
+	}
+	return 0;
+}
+
+
+void TiXmlReader::Grow( int** array, int* capacity, int needed )
+{
+	if ( needed <= *capacity )
+		return;
+
+	int newCapacity = *capacity ? *capacity * 2 : 8;
+	while ( newCapacity < needed )
+		newCapacity *= 2;
+
+	int* grown = new int[ newCapacity ];
+	if ( *array )
+		memcpy( grown, *array, *capacity * sizeof( int ) );
+	delete [] *array;
+	*array = grown;
+	*capacity = newCapacity;
+}
+
+
+void TiXmlReader::AddAttribute()
+{
+	Grow( &attributeOffsets, &attributeCapacity, attributeCount + 1 );
+	attributeOffsets[ attributeCount++ ] = (int)attributes.length();
+	attributes.append( scratchName.c_str(), scratchName.length() + 1 );
+	attributes.append( scratchValue.c_str(), scratchValue.length() + 1 );
+}
+
+
+void TiXmlReader::PushName()
+{
+	Grow( &openOffsets, &openCapacity, depth + 1 );
+	openOffsets[ depth++ ] = (int)openNames.length();
+	openNames.append( name.c_str(), name.length() + 1 );
+}
+
+
+void TiXmlReader::PopName()
+{
+	assert( depth > 0 );
+	--depth;
+	name = openNames.c_str() + openOffsets[ depth ];
+	openNames.assign( openNames.c_str(), openOffsets[ depth ] );
+}
+
+
+TiXmlReader::Token TiXmlReader::Next()
+{
+	if ( token == TOKEN_ERROR || token == TOKEN_END_DOCUMENT )
+		return token;
+
+	cdata = false;
+	emptyElement = false;
+
+	if ( pendingEnd )
+	{
+		// Second half of an empty element.
+		pendingEnd = false;
+		PopName();
+		tokenStart = p;
+		return token = TOKEN_END_ELEMENT;
+	}
+
+	if ( !start )
+		return SetError( TiXmlBase::TIXML_ERROR_DOCUMENT_EMPTY, 0 );
+
+	for( ;; )
+	{
+		const char* pWithWhiteSpace = p;
+		const char* q = TiXmlBase::SkipWhiteSpace( p, encoding );
+
+		if ( !q || !*q )
+		{
+			if ( depth > 0 )
+				return SetError( TiXmlBase::TIXML_ERROR_READING_END_TAG, q );
+			if ( !sawNode )
+				return SetError( TiXmlBase::TIXML_ERROR_DOCUMENT_EMPTY, 0 );
+			tokenStart = p = ( q ? q : p + strlen( p ) );
+			if ( observer && readStart )
+				ReportPhase( TiXmlParsePhase::PHASE_PARSE, readStart, TiXmlParseObserver::Now(), (size_t)( p - start ) );
+			return token = TOKEN_END_DOCUMENT;
+		}
+
+		tokenStart = q;
+		if ( *q != '<' )
+		{
+			if ( depth == 0 )
+			{
+				// The document parser stops at anything that isn't markup.
+				if ( !sawNode )
+					return SetError( TiXmlBase::TIXML_ERROR_DOCUMENT_EMPTY, 0 );
+				p = q;
+				return token = TOKEN_END_DOCUMENT;
+			}
+
+			// Text. When white space is kept the leading spaces belong to it.
+			const char* from = condense ? q : pWithWhiteSpace;
+			const char* end = TiXmlBase::ReadText( from, &text, condense, "<", false, encoding );
+			if ( !end )
+				return SetError( TiXmlBase::TIXML_ERROR_READING_ELEMENT_VALUE, 0 );
+			p = end - 1;	// don't eat the '<'
+
+			bool blank = true;
+			for ( size_t i=0; blank && i<text.length(); ++i )
+				blank = TiXmlBase::IsWhiteSpace( text[i] );
+			if ( blank )
+				continue;
+
+			sawNode = true;
+			return token = TOKEN_TEXT;
+		}
+
+		sawNode = true;
+		if ( depth > 0 && TiXmlBase::StringEqual( q, "</", false, encoding ) )
+			return ReadEndElement();
+		if ( TiXmlBase::StringEqual( q, "<?xml", true, encoding ) )
+			return ReadDeclaration();
+		if ( TiXmlBase::StringEqual( q, "<!--", false, encoding ) )
+			return ReadDelimited( TOKEN_COMMENT, "<!--", "-->" );
+		if ( TiXmlBase::StringEqual( q, "<![CDATA[", false, encoding ) )
+		{
+			cdata = true;
+			return ReadDelimited( TOKEN_TEXT, "<![CDATA[", "]]>" );
+		}
+		if (    !TiXmlBase::StringEqual( q, "<!", false, encoding )
+			 && ( TiXmlBase::IsAlpha( *(q+1), encoding ) || *(q+1) == '_' ) )
+		{
+			return ReadStartElement();
+		}
+
+		// Anything else (DTDs, processing instructions) is carried as an unknown.
+		q = tokenStart + 1;
+		const char* end = q;
+		while ( *end && *end != '>' )
+			++end;
+		name.assign( q, end - q );
+		p = *end ? end + 1 : end;
+		return token = TOKEN_UNKNOWN;
+	}
+}
+
+
+TiXmlReader::Token TiXmlReader::ReadDelimited( Token tok, const char* startTag, const char* endTag )
+{
+	const char* q = tokenStart + strlen( startTag );
+	const char* end = strstr( q, endTag );
+
+	if ( !end )
+	{
+		if ( cdata )
+			return SetError( TiXmlBase::TIXML_ERROR_PARSING_CDATA, tokenStart );
+
+		// An unterminated comment runs to the end, as in TiXmlComment::Parse().
+		end = q + strlen( q );
+		text.assign( q, end - q );
+		p = end;
+		return token = tok;
+	}
+
+	// Neither comments nor CDATA interpret entities or white space.
+	text.assign( q, end - q );
+	p = end + strlen( endTag );
+	return token = tok;
+}
+
+
+TiXmlReader::Token TiXmlReader::ReadDeclaration()
+{
+	const char* q = tokenStart + 5;
+	name = "xml";
+	attributes = "";
+	attributeCount = 0;
+
+	while ( q && *q )
+	{
+		if ( *q == '>' )
+		{
+			p = q + 1;
+
+			if ( encoding == TIXML_ENCODING_UNKNOWN )
+			{
+				const char* enc = Attribute( "encoding" );
+				if (    !enc || !*enc
+					 || TiXmlBase::StringEqual( enc, "UTF-8", true, TIXML_ENCODING_UNKNOWN )
+					 || TiXmlBase::StringEqual( enc, "UTF8", true, TIXML_ENCODING_UNKNOWN ) )
+					encoding = TIXML_ENCODING_UTF8;
+				else
+					encoding = TIXML_ENCODING_LEGACY;
+			}
+			return token = TOKEN_DECLARATION;
+		}
+
+		q = TiXmlBase::SkipWhiteSpace( q, encoding );
+		if ( q && *q && ( TiXmlBase::IsAlpha( *q, encoding ) || *q == '_' ) )
+		{
+			q = ReadAttribute( q );
+			if ( token == TOKEN_ERROR )
+				return token;
+		}
+		else
+		{
+			// Read over whatever it is.
+			while ( q && *q && *q != '>' && !TiXmlBase::IsWhiteSpace( *q ) )
+				++q;
+		}
+	}
+	return SetError( TiXmlBase::TIXML_ERROR_PARSING_DECLARATION, tokenStart );
+}
+
+
+const char* TiXmlReader::ReadAttribute( const char* q )
+{
+	const char* pErr = q;
+	q = TiXmlBase::ReadName( q, &scratchName, encoding );
+	if ( !q || !*q )
+	{
+		SetError( TiXmlBase::TIXML_ERROR_READING_ATTRIBUTES, pErr );
+		return 0;
+	}
+	q = TiXmlBase::SkipWhiteSpace( q, encoding );
+	if ( !q || !*q || *q != '=' )
+	{
+		SetError( TiXmlBase::TIXML_ERROR_READING_ATTRIBUTES, q );
+		return 0;
+	}
+
+	++q;	// skip '='
+	q = TiXmlBase::SkipWhiteSpace( q, encoding );
+	if ( !q || !*q )
+	{
+		SetError( TiXmlBase::TIXML_ERROR_READING_ATTRIBUTES, q );
+		return 0;
+	}
+
+	if ( *q == '\'' )
+	{
+		q = TiXmlBase::ReadText( q+1, &scratchValue, false, "\'", false, encoding );
+	}
+	else if ( *q == '\"' )
+	{
+		q = TiXmlBase::ReadText( q+1, &scratchValue, false, "\"", false, encoding );
+	}
+	else
+	{
+		// Unquoted values are tolerated, as in TiXmlAttribute::Parse().
+		scratchValue = "";
+		while ( q && *q && !TiXmlBase::IsWhiteSpace( *q ) && *q != '/' && *q != '>' )
+		{
+			if ( *q == '\'' || *q == '\"' )
+			{
+				SetError( TiXmlBase::TIXML_ERROR_READING_ATTRIBUTES, q );
+				return 0;
+			}
+			scratchValue += *q;
+			++q;
+		}
+	}
+
+	if ( !q || !*q )
+	{
+		SetError( TiXmlBase::TIXML_ERROR_PARSING_ELEMENT, pErr );
+		return 0;
+	}
+	if ( Attribute( scratchName.c_str() ) )
+	{
+		// Double attributes are an error, as in the DOM.
+		SetError( TiXmlBase::TIXML_ERROR_PARSING_ELEMENT, pErr );
+		return 0;
+	}
+
+	AddAttribute();
+	return q;
+}
+
+
+TiXmlReader::Token TiXmlReader::ReadStartElement()
+{
+	if ( parseOptions.maxDepth > 0 && depth >= parseOptions.maxDepth )
+		return SetError( TiXmlBase::TIXML_ERROR_DEPTH_EXCEEDED, tokenStart );
+
+	const char* q = TiXmlBase::SkipWhiteSpace( tokenStart + 1, encoding );
+	const char* pErr = q;
+
+	q = TiXmlBase::ReadName( q, &name, encoding );
+	if ( !q || !*q )
+		return SetError( TiXmlBase::TIXML_ERROR_FAILED_TO_READ_ELEMENT_NAME, pErr );
+
+	attributes = "";
+	attributeCount = 0;
+
+	while ( q && *q )
+	{
+		pErr = q;
+		q = TiXmlBase::SkipWhiteSpace( q, encoding );
+		if ( !q || !*q )
+			return SetError( TiXmlBase::TIXML_ERROR_READING_ATTRIBUTES, pErr );
+
+		if ( *q == '/' )
+		{
+			++q;
+			if ( *q != '>' )
+				return SetError( TiXmlBase::TIXML_ERROR_PARSING_EMPTY, q );
+			p = q + 1;
+			PushName();
+			emptyElement = true;
+			pendingEnd = true;
+			return token = TOKEN_START_ELEMENT;
+		}
+		else if ( *q == '>' )
+		{
+			p = q + 1;
+			PushName();
+			return token = TOKEN_START_ELEMENT;
+		}
+		else
+		{
+			q = ReadAttribute( q );
+			if ( !q )
+				return token;
+		}
+	}
+	return SetError( TiXmlBase::TIXML_ERROR_PARSING_ELEMENT, pErr );
+}
+
+
+TiXmlReader::Token TiXmlReader::ReadEndElement()
+{
+	assert( depth > 0 );
+	const char* open = openNames.c_str() + openOffsets[ depth - 1 ];
+	const size_t length = strlen( open );
+
+	// Note that </foo > and </foo> are both valid end tags.
+	const char* q = tokenStart + 2;
+	if ( strncmp( q, open, length ) != 0 )
+		return SetError( TiXmlBase::TIXML_ERROR_READING_END_TAG, tokenStart );
+
+	q = TiXmlBase::SkipWhiteSpace( q + length, encoding );
+	if ( !q || *q != '>' )
+		return SetError( TiXmlBase::TIXML_ERROR_READING_END_TAG, q );
+
+	p = q + 1;
+	PopName();
+	return token = TOKEN_END_ELEMENT;
+}
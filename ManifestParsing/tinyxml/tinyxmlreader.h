@@ -0,0 +1,218 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+
+#ifndef TINYXML_READER_INCLUDED
+#define TINYXML_READER_INCLUDED
+
+#include "tinyxml.h"
+
+/**	A forward only, pull style reader over a null terminated block of XML.
+
+	TiXmlReader tokenizes the same syntax as TiXmlDocument::Parse(), with the
+	same entity and white space handling, but never builds a DOM. Each call to
+	Next() advances to the next token and the accessors describe it. Names,
+	attributes and text stay valid until the following call to Next().
+
+	@verbatim
+	TiXmlReader reader( xml );
+	TiXmlReader::Token token;
+	while (    ( token = reader.Next() ) != TiXmlReader::TOKEN_END_DOCUMENT
+			&& token != TiXmlReader::TOKEN_ERROR )
+	{
+		if ( token == TiXmlReader::TOKEN_START_ELEMENT )
+			printf( "%s has %d attributes\n", reader.Name(), reader.AttributeCount() );
+	}
+	@endverbatim
+
+	An empty element (<foo/>) is reported as a TOKEN_START_ELEMENT followed by
+	a TOKEN_END_ELEMENT. Text that is entirely white space is skipped, as it is
+	by the DOM parser. The reader does not copy the input: the buffer must
+	outlive it.
+
+	Like a document, a reader holds its own TiXmlParseOptions, so readers on
+	different threads can read with different settings. Of those, the white
+	space setting, tabSize, encoding, maxDepth and maxBytes apply to a reader;
+	the rest are about building a DOM and are ignored.
+*/
+class TiXmlReader
+{
+public:
+	enum Token
+	{
+		TOKEN_NONE,
+		TOKEN_START_ELEMENT,
+		TOKEN_END_ELEMENT,
+		TOKEN_TEXT,
+		TOKEN_COMMENT,
+		TOKEN_DECLARATION,
+		TOKEN_UNKNOWN,
+		TOKEN_END_DOCUMENT,
+		TOKEN_ERROR
+	};
+
+	/// Read the given null terminated buffer. The buffer is not copied.
+	TiXmlReader( const char* xml, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+	/// Read the given null terminated buffer with 'options'. The buffer is not copied.
+	TiXmlReader( const char* xml, const TiXmlParseOptions& options );
+	/// Create a reader without input; use LoadFile() or Reset().
+	TiXmlReader();
+	~TiXmlReader();
+
+	/// Start over on a new buffer. The buffer is not copied.
+	void Reset( const char* xml, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+
+	/** Read a whole file (normalizing line endings as TiXmlDocument::LoadFile()
+		does) and start reading it. The reader owns the buffer. Returns false,
+		with the error set, if the file can't be read.
+	*/
+	bool LoadFile( const char* filename, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+
+	/** The options the next Reset() or LoadFile() reads with, all but the
+		encoding, which is the one given to them.
+	*/
+	void SetParseOptions( const TiXmlParseOptions& options )	{ parseOptions = options; located = 0; }
+	const TiXmlParseOptions& ParseOptions() const				{ return parseOptions; }
+
+	/** Report the timing of each phase of LoadFile() and of the read to
+		'observer' (see TiXmlParseObserver::OnReaderPhase()), or stop if it
+		is null. The reader does not own it. With no observer the phases
+		aren't timed at all.
+	*/
+	void SetParseObserver( TiXmlParseObserver* _observer )	{ observer = _observer; }
+	TiXmlParseObserver* ParseObserver() const				{ return observer; }
+
+	/// Advance to the next token and return it.
+	Token Next();
+
+	/// The current token.
+	Token CurrentToken() const				{ return token; }
+
+	/** The element name for TOKEN_START_ELEMENT and TOKEN_END_ELEMENT, the tag
+		contents for TOKEN_UNKNOWN, and "xml" for TOKEN_DECLARATION.
+	*/
+	const char* Name() const				{ return name.c_str(); }
+	/// Decoded text for TOKEN_TEXT, comment body for TOKEN_COMMENT.
+	const char* Text() const				{ return text.c_str(); }
+	/// Length of Text().
+	size_t TextLength() const				{ return text.length(); }
+	/// True if the current TOKEN_TEXT came from a CDATA section.
+	bool CDATA() const						{ return cdata; }
+	/// True if the current TOKEN_START_ELEMENT was written as <foo/>.
+	bool EmptyElement() const				{ return emptyElement; }
+
+	/// Number of attributes on the current start element or declaration.
+	int AttributeCount() const				{ return attributeCount; }
+	const char* AttributeName( int i ) const;	///< Name of attribute 'i'.
+	const char* AttributeValue( int i ) const;	///< Decoded value of attribute 'i'.
+	/// The value of the named attribute, or null if the current element doesn't have it.
+	const char* Attribute( const char* name ) const;
+
+	/** The number of elements currently open. A start element is counted from
+		its own token; its end element is reported at the depth of its parent.
+	*/
+	int Depth() const						{ return depth; }
+
+	/// The position in the input where the current token starts.
+	const char* TokenStart() const			{ return tokenStart; }
+	/// The position in the input just past the current token.
+	const char* Position() const			{ return p; }
+	/// The encoding in effect, once known.
+	TiXmlEncoding Encoding() const			{ return encoding; }
+
+	bool Error() const						{ return token == TOKEN_ERROR; }	///< True after a parse error.
+	int ErrorId() const						{ return errorId; }					///< See TiXmlDocument::ErrorId().
+	const char* ErrorDesc() const;												///< See TiXmlDocument::ErrorDesc().
+	int ErrorRow() const					{ return errorLocation.row+1; }		///< 1 based row of the error.
+	int ErrorCol() const					{ return errorLocation.col+1; }		///< 1 based column of the error.
+
+	/** Row and column (0 based, as in TiXmlCursor) of an arbitrary position in
+		the input; both -1 if TiXmlParseOptions::tabSize is 0. Each call goes
+		on from where the last one stopped if that is no further on, so
+		positions asked for in document order cost one pass over the text
+		between them; an earlier one starts again from the beginning.
+	*/
+	TiXmlCursor Locate( const char* where ) const;
+
+private:
+	TiXmlReader( const TiXmlReader& );		// not implemented.
+	void operator=( const TiXmlReader& );	// not allowed.
+
+	Token SetError( int err, const char* where );
+	void ReportPhase( TiXmlParsePhase::Phase phase, unsigned long long start, unsigned long long end, size_t bytes ) const;
+	void Release();
+	Token ReadStartElement();
+	Token ReadEndElement();
+	Token ReadDeclaration();
+	Token ReadDelimited( Token tok, const char* startTag, const char* endTag );
+	const char* ReadAttribute( const char* q );
+	void AddAttribute();
+	void PushName();
+	void PopName();
+	void Grow( int** array, int* capacity, int needed );
+
+	const char* start;
+	const char* p;
+	const char* tokenStart;
+	char* ownedBuffer;
+	TiXmlParseOptions parseOptions;
+	TiXmlEncoding encoding;
+	bool condense;			// parseOptions' white space setting, as of Reset()
+	TiXmlParseObserver* observer;
+	unsigned long long readStart;	// when the input was set, if there is an observer
+
+	Token token;
+	bool pendingEnd;
+	bool cdata;
+	bool emptyElement;
+	bool sawNode;
+	int depth;
+
+	TIXML_STRING name;
+	TIXML_STRING text;
+	TIXML_STRING scratchName;
+	TIXML_STRING scratchValue;
+
+	// Attributes are packed into one string as name\0value\0 pairs.
+	TIXML_STRING attributes;
+	int* attributeOffsets;
+	int attributeCount;
+	int attributeCapacity;
+
+	// Open element names, packed the same way, for end tag matching.
+	TIXML_STRING openNames;
+	int* openOffsets;
+	int openCapacity;
+
+	int errorId;
+	TiXmlCursor errorLocation;
+
+	// Where Locate() last stopped, its row and column, and the encoding they
+	// were counted in.
+	mutable const char* located;
+	mutable TiXmlCursor locatedAt;
+	mutable TiXmlEncoding locatedEncoding;
+};
+
+#endif
@@ -0,0 +1,475 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#ifdef TIXML_USE_STL
+
+#include <algorithm>
+#include <functional>
+
+#include "tinyxmlvalidate.h"
+#include "tinyxmlreader.h"
+
+
+TiXmlValidator::TiXmlValidator( const TiXmlValidateRule* _rules, int count )
+	: rules( _rules, _rules + count ), steps( 1 )
+{
+	steps[0].parent = -1;
+	steps[0].counters = 0;
+
+	for ( int i=0; i<count; ++i )
+	{
+		const TiXmlValidateRule& rule = rules[i];
+		int step = 0;
+		const char* p = rule.path;
+		while ( *p )
+		{
+			const char* end = strchr( p, '/' );
+			if ( !end )
+				end = p + strlen( p );
+			const std::string name( p, end );
+
+			int child = -1;
+			for ( size_t j=0; j<steps[step].children.size(); ++j )
+			{
+				if ( steps[ steps[step].children[j] ].name == name )
+					child = steps[step].children[j];
+			}
+			if ( child < 0 )
+			{
+				child = (int)steps.size();
+				steps.push_back( Step() );
+				steps.back().name = name;
+				steps.back().parent = step;
+				steps.back().counters = 0;
+				steps[step].children.push_back( child );
+			}
+			step = child;
+			p = *end ? end + 1 : end;
+		}
+		assert( step > 0 );		// an empty path names no element
+
+		Step& s = steps[step];
+		switch ( rule.check )
+		{
+			case TiXmlValidateRule::OCCURS:
+				s.occurs.push_back( i );
+				s.slots.push_back( steps[ s.parent ].counters++ );
+				break;
+
+			case TiXmlValidateRule::REQUIRED:
+				if ( rule.attribute )
+					s.required.push_back( i );
+				else
+					s.requiredText.push_back( i );
+				break;
+
+			case TiXmlValidateRule::FORMAT:
+			case TiXmlValidateRule::ONE_OF:
+			{
+				std::vector< Check >& checks = rule.attribute ? s.checks : s.textChecks;
+				checks.push_back( Check() );
+				Compile( rule, &checks.back() );
+				checks.back().rule = i;
+				break;
+			}
+		}
+	}
+}
+
+
+void TiXmlValidator::Compile( const TiXmlValidateRule& rule, Check* check ) const
+{
+	if ( rule.check == TiXmlValidateRule::ONE_OF )
+	{
+		for ( const char* const* value = rule.values; value && *value; ++value )
+			check->values.push_back( *value );
+		std::sort( check->values.begin(), check->values.end() );
+		return;
+	}
+
+	assert( rule.format );
+	for ( const char* p = rule.format; *p; ++p )
+	{
+		if ( *p == '#' || *p == '*' )
+		{
+			Op op;
+			op.kind = ( *p == '#' ) ? Op::DIGITS : Op::ANY;
+			check->format.push_back( op );
+			continue;
+		}
+		if ( *p == '\\' && p[1] )
+			++p;
+		if ( check->format.empty() || check->format.back().kind != Op::LITERAL )
+		{
+			Op op;
+			op.kind = Op::LITERAL;
+			check->format.push_back( op );
+		}
+		check->format.back().literal += *p;
+	}
+}
+
+
+bool TiXmlValidator::MatchFormat( const std::vector< Op >& format, size_t op, const char* value )
+{
+	for ( ; op < format.size(); ++op )
+	{
+		const Op& o = format[op];
+		if ( o.kind == Op::LITERAL )
+		{
+			if ( strncmp( value, o.literal.c_str(), o.literal.length() ) != 0 )
+				return false;
+			value += o.literal.length();
+			continue;
+		}
+
+		// Digits and runs take as much as they can, and give back what the
+		// rest of the format needs.
+		const char* end = value;
+		if ( o.kind == Op::DIGITS )
+		{
+			while ( isdigit( (unsigned char)*end ) )
+				++end;
+			if ( end == value )
+				return false;
+		}
+		else
+		{
+			end += strlen( end );
+		}
+		const char* least = ( o.kind == Op::DIGITS ) ? value + 1 : value;
+		for ( ; end >= least; --end )
+		{
+			if ( MatchFormat( format, op + 1, end ) )
+				return true;
+		}
+		return false;
+	}
+	return *value == 0;
+}
+
+
+bool TiXmlValidator::Matches( const Check& check, const char* value ) const
+{
+	if ( rules[ check.rule ].check == TiXmlValidateRule::FORMAT )
+		return MatchFormat( check.format, 0, value );
+	return std::binary_search( check.values.begin(), check.values.end(), std::string( value ) );
+}
+
+
+int TiXmlValidator::FindChild( int step, const char* name ) const
+{
+	if ( step < 0 )
+		return -1;
+	const std::vector< int >& children = steps[step].children;
+	for ( size_t i=0; i<children.size(); ++i )
+	{
+		if ( steps[ children[i] ].name == name )
+			return children[i];
+	}
+	return -1;
+}
+
+
+bool TiXmlValidator::Report( TiXmlValidationPass* pass, int rule, const char* where, const std::string& message ) const
+{
+	pass->failed = true;
+	if ( !pass->errors )
+		return false;
+
+	TiXmlValidationError error;
+	error.rule = rule;
+	error.row = error.col = 0;
+	error.message = message;
+	pass->errors->push_back( error );
+	pass->where.push_back( where );
+	return true;
+}
+
+
+// "Attribute ml:type="Foo" of <component>" or "Text "foo" of <note>", to start a message.
+static std::string TiXmlValidateValue( const char* attribute, const std::string& element, const char* value )
+{
+	std::string s = attribute ? std::string( "Attribute " ) + attribute + "=\"" : std::string( "Text \"" );
+	s += value;
+	s += "\" of <";
+	s += element;
+	s += ">";
+	return s;
+}
+
+
+bool TiXmlValidator::StartElement( const TiXmlReader* reader, TiXmlValidationPass* pass ) const
+{
+	const Open& parent = pass->open.back();
+	Open open;
+	open.step = FindChild( parent.step, reader->Name() );
+	open.start = reader->TokenStart();
+	open.counters = pass->counts.size();
+	open.text = false;
+	if ( open.step < 0 )
+	{
+		pass->open.push_back( open );
+		return true;
+	}
+
+	const Step& s = steps[ open.step ];
+	for ( size_t i=0; i<s.occurs.size(); ++i )
+	{
+		const TiXmlValidateRule& rule = rules[ s.occurs[i] ];
+		const int n = ++pass->counts[ parent.counters + s.slots[i] ];
+		if ( rule.max >= 0 && n > rule.max )
+		{
+			char buf[ 32 ];
+			TIXML_SNPRINTF( buf, sizeof( buf ), "%d", rule.max );
+			const std::string in = s.parent ? "<" + steps[ s.parent ].name + ">" : std::string( "the document" );
+			if ( !Report( pass, s.occurs[i], open.start, "Too many <" + s.name + "> in " + in + " (at most " + buf + ")." ) )
+				return false;
+		}
+	}
+	pass->counts.resize( open.counters + s.counters, 0 );
+
+	for ( size_t i=0; i<s.required.size(); ++i )
+	{
+		const char* attribute = rules[ s.required[i] ].attribute;
+		if ( !reader->Attribute( attribute ) )
+		{
+			if ( !Report( pass, s.required[i], open.start, std::string( "Missing attribute " ) + attribute + " on <" + s.name + ">." ) )
+				return false;
+		}
+	}
+	for ( size_t i=0; i<s.checks.size(); ++i )
+	{
+		const TiXmlValidateRule& rule = rules[ s.checks[i].rule ];
+		const char* value = reader->Attribute( rule.attribute );
+		if ( value && !Matches( s.checks[i], value ) )
+		{
+			const std::string what = TiXmlValidateValue( rule.attribute, s.name, value );
+			const std::string why = ( rule.check == TiXmlValidateRule::FORMAT ) ? std::string( " doesn't match \"" ) + rule.format + "\"." : std::string( " isn't one of the allowed values." );
+			if ( !Report( pass, s.checks[i].rule, open.start, what + why ) )
+				return false;
+		}
+	}
+
+	if ( !s.requiredText.empty() || !s.textChecks.empty() )
+	{
+		open.text = true;
+		if ( pass->texts.size() <= pass->open.size() )
+			pass->texts.resize( pass->open.size() + 1 );
+		pass->texts[ pass->open.size() ].clear();
+	}
+	pass->open.push_back( open );
+	return true;
+}
+
+
+bool TiXmlValidator::EndElement( TiXmlValidationPass* pass ) const
+{
+	const Open open = pass->open.back();
+	pass->open.pop_back();
+	if ( open.step < 0 )
+		return true;
+
+	const Step& s = steps[ open.step ];
+	if ( open.text )
+	{
+		const std::string& text = pass->texts[ pass->open.size() ];
+		for ( size_t i=0; i<s.requiredText.size(); ++i )
+		{
+			if ( text.empty() && !Report( pass, s.requiredText[i], open.start, "Missing text in <" + s.name + ">." ) )
+				return false;
+		}
+		for ( size_t i=0; i<s.textChecks.size(); ++i )
+		{
+			const TiXmlValidateRule& rule = rules[ s.textChecks[i].rule ];
+			if ( !text.empty() && !Matches( s.textChecks[i], text.c_str() ) )
+			{
+				const std::string what = TiXmlValidateValue( 0, s.name, text.c_str() );
+				const std::string why = ( rule.check == TiXmlValidateRule::FORMAT ) ? std::string( " doesn't match \"" ) + rule.format + "\"." : std::string( " isn't one of the allowed values." );
+				if ( !Report( pass, s.textChecks[i].rule, open.start, what + why ) )
+					return false;
+			}
+		}
+	}
+
+	// Children that turned up too few times.
+	for ( size_t c=0; c<s.children.size(); ++c )
+	{
+		const Step& child = steps[ s.children[c] ];
+		for ( size_t i=0; i<child.occurs.size(); ++i )
+		{
+			const TiXmlValidateRule& rule = rules[ child.occurs[i] ];
+			const int n = pass->counts[ open.counters + child.slots[i] ];
+			if ( n >= rule.min )
+				continue;
+
+			std::string message;
+			if ( open.step == 0 )
+			{
+				message = "Missing root element <" + child.name + ">.";
+			}
+			else
+			{
+				char buf[ 64 ];
+				TIXML_SNPRINTF( buf, sizeof( buf ), " (at least %d, found %d).", rule.min, n );
+				message = "Too few <" + child.name + "> in <" + s.name + ">" + buf;
+			}
+			if ( !Report( pass, child.occurs[i], open.start, message ) )
+				return false;
+		}
+	}
+	pass->counts.resize( open.counters );
+	return true;
+}
+
+
+// Orders errors by where they are in the input; the top of the document is null.
+struct TiXmlValidateBefore
+{
+	TiXmlValidateBefore( const std::vector< const char* >& _where ) : where( _where ) {}
+	bool operator()( size_t a, size_t b ) const		{ return std::less< const char* >()( where[a], where[b] ); }
+
+	const std::vector< const char* >& where;
+};
+
+
+bool TiXmlValidator::Validate( TiXmlReader* reader, std::vector< TiXmlValidationError >* errors ) const
+{
+	TiXmlValidationPass pass( *this, errors );
+	while ( pass.Next( reader, reader->Next() ) )
+		;
+	return pass.Finish( *reader );
+}
+
+
+bool TiXmlValidator::Validate( const char* xml, std::vector< TiXmlValidationError >* errors, TiXmlEncoding encoding ) const
+{
+	TiXmlReader reader;
+	reader.SetParseOptions( parseOptions );
+	reader.Reset( xml, encoding );
+	return Validate( &reader, errors );
+}
+
+
+bool TiXmlValidator::ValidateFile( const char* filename, std::vector< TiXmlValidationError >* errors, TiXmlEncoding encoding ) const
+{
+	TiXmlReader reader;
+	reader.SetParseOptions( parseOptions );
+	if ( !reader.LoadFile( filename, encoding ) )
+	{
+		if ( errors )
+		{
+			TiXmlValidationError error;
+			error.rule = -1;
+			error.row = error.col = 0;
+			error.message = std::string( reader.ErrorDesc() ) + ": " + filename;
+			errors->assign( 1, error );
+		}
+		return false;
+	}
+	return Validate( &reader, errors );
+}
+
+
+TiXmlValidationPass::TiXmlValidationPass( const TiXmlValidator& _validator, std::vector< TiXmlValidationError >* _errors )
+	: validator( _validator ), errors( _errors )
+{
+	if ( errors )
+		errors->clear();
+	failed = over = false;
+	parseError.rule = -1;
+	parseError.row = parseError.col = 0;
+
+	TiXmlValidator::Open document;
+	document.step = 0;
+	document.start = 0;		// located at row 1, column 1
+	document.counters = 0;
+	document.text = false;
+	open.push_back( document );
+	counts.resize( validator.steps[0].counters, 0 );
+}
+
+
+bool TiXmlValidationPass::Next( const TiXmlReader* reader, TiXmlReader::Token token )
+{
+	if ( over )
+		return false;
+
+	if ( token == TiXmlReader::TOKEN_END_DOCUMENT )
+	{
+		validator.EndElement( this );
+		over = true;
+	}
+	else if ( token == TiXmlReader::TOKEN_ERROR )
+	{
+		failed = over = true;
+		parseError.row = reader->ErrorRow();
+		parseError.col = reader->ErrorCol();
+		parseError.message = reader->ErrorDesc();
+	}
+	else if ( token == TiXmlReader::TOKEN_START_ELEMENT )
+	{
+		over = !validator.StartElement( reader, this );
+	}
+	else if ( token == TiXmlReader::TOKEN_TEXT )
+	{
+		if ( open.back().text )
+			texts[ open.size() - 1 ].append( reader->Text(), reader->TextLength() );
+	}
+	else if ( token == TiXmlReader::TOKEN_END_ELEMENT )
+	{
+		over = !validator.EndElement( this );
+	}
+	return !over;
+}
+
+
+bool TiXmlValidationPass::Finish( const TiXmlReader& reader )
+{
+	if ( errors )
+	{
+		// Missing children are found when their parent ends, after what is
+		// inside it: put the errors back in document order, then locate them,
+		// which in that order is one pass over the text.
+		std::vector< size_t > order( errors->size() );
+		for ( size_t i=0; i<order.size(); ++i )
+			order[i] = i;
+		std::stable_sort( order.begin(), order.end(), TiXmlValidateBefore( where ) );
+
+		std::vector< TiXmlValidationError > sorted( order.size() );
+		for ( size_t i=0; i<order.size(); ++i )
+		{
+			sorted[i] = (*errors)[ order[i] ];
+			const TiXmlCursor cursor = reader.Locate( where[ order[i] ] );
+			sorted[i].row = cursor.row + 1;
+			sorted[i].col = cursor.col + 1;
+		}
+		if ( !parseError.message.empty() )
+			sorted.push_back( parseError );
+		errors->swap( sorted );
+	}
+	return !failed;
+}
+
+#endif
@@ -0,0 +1,265 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#ifndef TINYXML_VALIDATE_INCLUDED
+#define TINYXML_VALIDATE_INCLUDED
+
+#include "tinyxml.h"
+#include "tinyxmlreader.h"
+
+#ifndef TIXML_USE_STL
+#error "tinyxmlvalidate.h requires TIXML_USE_STL"
+#endif
+
+#include <string>
+#include <vector>
+
+class TiXmlValidationPass;
+
+/**	One check for TiXmlValidator, made with the TIXML_VALIDATE_ macros
+	below. 'path' is an element path from the root element, slash separated
+	as in TiXmlBindField; 'attribute' names an attribute of that element, or
+	is null to check the element's text.
+*/
+struct TiXmlValidateRule
+{
+	enum Check
+	{
+		OCCURS,		///< The element appears 'min' to 'max' times in each of its parents (max -1: no limit).
+		REQUIRED,	///< Every such element has the attribute, or some text.
+		FORMAT,		///< The value, where there is one, matches 'format'.
+		ONE_OF		///< The value, where there is one, is one of 'values'.
+	};
+
+	constexpr TiXmlValidateRule(	Check _check,
+									const char* _path,
+									const char* _attribute,
+									int _min,
+									int _max,
+									const char* _format,
+									const char* const* _values )
+		: check( _check ), path( _path ), attribute( _attribute ), min( _min ), max( _max ), format( _format ), values( _values ) {}
+
+	Check check;
+	const char* path;
+	const char* attribute;
+	int min;
+	int max;
+	/** A FORMAT pattern: '#' matches one or more digits, '*' any run of
+		characters (none included), and '\' makes the character after it
+		literal. Anything else matches itself, so "#.#.#" is a three part
+		version number.
+	*/
+	const char* format;
+	const char* const* values;	///< The ONE_OF values, ending with a null.
+};
+
+/// The element at 'path' appears 'min' to 'max' times in each of its parents; the root element in the document.
+#define TIXML_VALIDATE_OCCURS( path, min, max )					TiXmlValidateRule( TiXmlValidateRule::OCCURS, path, 0, min, max, 0, 0 )
+/// Every element at 'path' has 'attribute' (or, if it is null, text).
+#define TIXML_VALIDATE_REQUIRED( path, attribute )				TiXmlValidateRule( TiXmlValidateRule::REQUIRED, path, attribute, 0, 0, 0, 0 )
+/// Every value of 'attribute' (or, if it is null, text) of the elements at 'path' matches 'format'.
+#define TIXML_VALIDATE_FORMAT( path, attribute, format )		TiXmlValidateRule( TiXmlValidateRule::FORMAT, path, attribute, 0, 0, format, 0 )
+/// Every value of 'attribute' (or, if it is null, text) of the elements at 'path' is in the null terminated array 'values'.
+#define TIXML_VALIDATE_ONE_OF( path, attribute, values )		TiXmlValidateRule( TiXmlValidateRule::ONE_OF, path, attribute, 0, 0, 0, values )
+
+
+/// A rule a document broke, or a reason it couldn't be read.
+struct TiXmlValidationError
+{
+	int rule;				///< The index of the rule, or -1 if the document couldn't be read or parsed.
+	int row;				///< 1 based row of the element, or of the parse error; 0 for a file error.
+	int col;				///< 1 based column.
+	std::string message;
+};
+
+
+/**	Checks documents against a set of rules in one streaming pass, without
+	building a DOM.
+
+	@verbatim
+	static const char* const types[] = { "Fullscreen", "Console", 0 };
+	static const TiXmlValidateRule rules[] =
+	{
+		TIXML_VALIDATE_OCCURS(   "manifest/application", 1, 1 ),
+		TIXML_VALIDATE_REQUIRED( "manifest", "ml:package" ),
+		TIXML_VALIDATE_FORMAT(   "manifest/application", "ml:sdk_version", "#.#.#" ),
+		TIXML_VALIDATE_ONE_OF(   "manifest/application/component", "ml:type", types ),
+	};
+
+	TiXmlValidator validator( rules, 4 );
+	std::vector< TiXmlValidationError > errors;
+	if ( !validator.ValidateFile( "manifest.xml", &errors ) )
+		for ( size_t i=0; i<errors.size(); ++i )
+			printf( "%d:%d: %s\n", errors[i].row, errors[i].col, errors[i].message.c_str() );
+	@endverbatim
+
+	The rules are compiled up front into a tree of element states, one per
+	step of a path, with each state holding the checks of its element: an
+	element costs one lookup among the names that can follow its parent, and
+	nothing below an element that no path goes through. Formats are compiled
+	into patterns and value lists sorted, so a value is matched without
+	going back to the rule.
+
+	Every violation is reported, at the element that broke the rule. A
+	missing element is reported at the parent that should have held it, or
+	at the top of the document for a missing root. The pass stops at the
+	first parse error, which is reported as well.
+
+	The validator is not changed by validating and can be used by several
+	threads at once.
+*/
+class TiXmlValidator
+{
+public:
+	/// Compile 'count' rules. The rules are copied; their strings must outlive the validator.
+	TiXmlValidator( const TiXmlValidateRule* rules, int count );
+
+	/** The options Validate() and ValidateFile() read with, as
+		TiXmlReader::SetParseOptions() takes them; the encoding is the one
+		given to them. Set them before validating, not while another thread is.
+	*/
+	void SetParseOptions( const TiXmlParseOptions& options )	{ parseOptions = options; }
+	const TiXmlParseOptions& ParseOptions() const				{ return parseOptions; }
+
+	/** Check a null terminated document. Returns true if it parsed and broke
+		no rule. 'errors' (if not null) is replaced with every violation, in
+		document order; with a null 'errors' the pass stops at the first one.
+	*/
+	bool Validate( const char* xml, std::vector< TiXmlValidationError >* errors, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING ) const;
+	/// As Validate(), reading a file as TiXmlReader::LoadFile() does.
+	bool ValidateFile( const char* filename, std::vector< TiXmlValidationError >* errors, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING ) const;
+	/// As Validate(), on a reader that has input and hasn't been advanced, with the reader's own options.
+	bool Validate( TiXmlReader* reader, std::vector< TiXmlValidationError >* errors ) const;
+
+private:
+	friend class TiXmlValidationPass;
+
+	// One step of a compiled format.
+	struct Op
+	{
+		enum Kind { LITERAL, DIGITS, ANY } kind;
+		std::string literal;
+	};
+
+	// A FORMAT or ONE_OF rule, compiled.
+	struct Check
+	{
+		int rule;
+		std::vector< Op > format;
+		std::vector< std::string > values;	// sorted
+	};
+
+	struct Step
+	{
+		std::string name;
+		int parent;
+		std::vector< int > children;	// steps that can follow this one
+		std::vector< int > occurs;		// OCCURS rules on this element
+		int counters;					// OCCURS rules on its children, counted per element
+		std::vector< int > slots;		// the counter of each of 'occurs' in the parent
+		std::vector< int > required;	// REQUIRED attribute rules
+		std::vector< Check > checks;	// FORMAT and ONE_OF attribute rules
+		std::vector< int > requiredText;
+		std::vector< Check > textChecks;
+	};
+
+	// What a pass keeps per open element.
+	struct Open
+	{
+		int step;				// -1 below an element no path goes through
+		const char* start;		// its start tag
+		size_t counters;		// where its counters start in the pass's counts
+		bool text;				// its text is being kept
+	};
+
+	int FindChild( int step, const char* name ) const;
+	bool Matches( const Check& check, const char* value ) const;
+	static bool MatchFormat( const std::vector< Op >& format, size_t op, const char* value );
+	void Compile( const TiXmlValidateRule& rule, Check* check ) const;
+	bool StartElement( const TiXmlReader* reader, TiXmlValidationPass* pass ) const;
+	bool EndElement( TiXmlValidationPass* pass ) const;
+	bool Report( TiXmlValidationPass* pass, int rule, const char* where, const std::string& message ) const;
+
+	std::vector< TiXmlValidateRule > rules;
+	std::vector< Step > steps;			// steps[0] is above the root element
+	TiXmlParseOptions parseOptions;
+};
+
+
+/**	A TiXmlValidator's pass over a document, given the tokens one at a time
+	by whatever is reading it, so the validation can ride along with another
+	pass over the same reader rather than reading the document again.
+	TiXmlBindParse() and TiXmlBindLoadFile() take a validator this way.
+
+	@verbatim
+	TiXmlValidationPass pass( validator, &errors );
+	TiXmlReader::Token token;
+	do
+	{
+		token = reader.Next();
+		pass.Next( &reader, token );
+		// ...and whatever else is done with the token.
+	}
+	while ( token != TiXmlReader::TOKEN_END_DOCUMENT && token != TiXmlReader::TOKEN_ERROR );
+	bool valid = pass.Finish( reader );
+	@endverbatim
+*/
+class TiXmlValidationPass
+{
+public:
+	/// Start a pass. 'errors' (if not null) is cleared, and filled as Validate() fills it.
+	TiXmlValidationPass( const TiXmlValidator& validator, std::vector< TiXmlValidationError >* errors );
+
+	/** Check the token 'reader' has just returned. Returns false once the
+		pass is over: at the end of the document, at a parse error, or at the
+		first violation if there is nowhere to put the errors. Tokens after
+		that are ignored.
+	*/
+	bool Next( const TiXmlReader* reader, TiXmlReader::Token token );
+
+	/** Once the tokens are over, put the errors in document order and locate
+		them in 'reader'. Call it once. Returns true if the document is valid.
+	*/
+	bool Finish( const TiXmlReader& reader );
+
+private:
+	TiXmlValidationPass( const TiXmlValidationPass& );		// not implemented.
+	void operator=( const TiXmlValidationPass& );			// not implemented.
+
+	friend class TiXmlValidator;
+
+	const TiXmlValidator& validator;
+	std::vector< TiXmlValidationError >* errors;
+	bool failed;
+	bool over;
+	TiXmlValidationError parseError;
+
+	std::vector< TiXmlValidator::Open > open;	// open[0] is the document
+	std::vector< int > counts;					// the OCCURS counters of the open elements
+	std::vector< std::string > texts;			// the text kept for each open element
+	std::vector< const char* > where;			// where each error is, until they are located
+};
+
+#endif
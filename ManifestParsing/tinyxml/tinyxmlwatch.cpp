@@ -0,0 +1,390 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#include "tinyxmlwatch.h"
+
+#ifdef TIXML_USE_STL
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#if defined( __linux__ )
+#define TIXML_WATCH_INOTIFY
+#include <sys/inotify.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// The events that mean a file may have new content: written and closed, or
+// renamed into place, or written without (yet) being closed. A deleted file
+// is reloaded too, so the handlers hear that it has gone.
+#define TIXML_WATCH_EVENTS	( IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY | IN_CREATE | IN_DELETE )
+#endif
+
+typedef std::chrono::steady_clock TiXmlWatchClock;
+
+struct TiXmlFileWatcher::File
+{
+	std::string name;			// as given to Watch()
+	std::string directory;		// what inotify watches
+	std::string base;			// the name within 'directory'
+	TiXmlParseOptions options;
+	int watch;					// the inotify watch on 'directory', or -1
+	std::shared_ptr< const TiXmlDocument > document;
+
+	// Only used by the watcher's thread.
+	bool pending;
+	TiXmlWatchClock::time_point due;
+};
+
+
+namespace {
+
+class DiffCollector : public TiXmlDiffHandler
+{
+public:
+	explicit DiffCollector( std::vector< TiXmlDiffOp >* _ops ) : ops( _ops ) {}
+
+	virtual bool OnDiff( const TiXmlDiffOp& op )
+	{
+		ops->push_back( op );
+		return true;
+	}
+
+private:
+	std::vector< TiXmlDiffOp >* ops;
+};
+
+}
+
+
+TiXmlFileWatcher::TiXmlFileWatcher( int debounceMilliseconds )
+	: debounce( debounceMilliseconds ), notifyFd( -1 ), reloads( 0 ), skipped( 0 )
+{
+	wakeFd[0] = wakeFd[1] = -1;
+	#ifdef TIXML_WATCH_INOTIFY
+	notifyFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	#endif
+}
+
+
+TiXmlFileWatcher::~TiXmlFileWatcher()
+{
+	Stop();
+	#ifdef TIXML_WATCH_INOTIFY
+	if ( notifyFd >= 0 )
+		close( notifyFd );
+	#endif
+	for ( size_t i = 0; i < files.size(); ++i )
+		delete files[i];
+}
+
+
+TiXmlFileWatcher::File* TiXmlFileWatcher::Find( const char* filename ) const
+{
+	// The caller holds 'mutex'.
+	for ( size_t i = 0; i < files.size(); ++i )
+	{
+		if ( files[i]->name == filename )
+			return files[i];
+	}
+	return 0;
+}
+
+
+bool TiXmlFileWatcher::Watch( const char* filename, const TiXmlParseOptions& options, std::string* error )
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		if ( Find( filename ) )
+			return true;
+	}
+
+	File* file = new File;
+	file->name = filename;
+	const char* slash = strrchr( filename, '/' );
+	if ( slash )
+	{
+		file->directory.assign( filename, slash == filename ? 1 : slash - filename );
+		file->base = slash + 1;
+	}
+	else
+	{
+		file->directory = ".";
+		file->base = filename;
+	}
+	file->options = options;
+	file->options.hashNodes = true;
+	file->watch = -1;
+	file->pending = false;
+
+	if ( !Load( file, &file->document, error ) )
+	{
+		delete file;
+		return false;
+	}
+
+	#ifdef TIXML_WATCH_INOTIFY
+	if ( notifyFd >= 0 )
+	{
+		// A directory watched for another file gives back the same watch.
+		file->watch = inotify_add_watch( notifyFd, file->directory.c_str(), TIXML_WATCH_EVENTS );
+		if ( file->watch < 0 )
+		{
+			if ( error )
+				*error = file->directory + ": " + strerror( errno );
+			delete file;
+			return false;
+		}
+	}
+	#endif
+
+	std::lock_guard< std::mutex > lock( mutex );
+	if ( Find( filename ) )
+	{
+		// Another thread watched it first.
+		delete file;
+		return true;
+	}
+	files.push_back( file );
+	return true;
+}
+
+
+std::shared_ptr< const TiXmlDocument > TiXmlFileWatcher::Document( const char* filename ) const
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	File* file = Find( filename );
+	return file ? file->document : std::shared_ptr< const TiXmlDocument >();
+}
+
+
+void TiXmlFileWatcher::Subscribe( TiXmlWatchHandler* handler )
+{
+	std::lock_guard< std::mutex > lock( reloadMutex );
+	if ( std::find( handlers.begin(), handlers.end(), handler ) == handlers.end() )
+		handlers.push_back( handler );
+}
+
+
+void TiXmlFileWatcher::Unsubscribe( TiXmlWatchHandler* handler )
+{
+	std::lock_guard< std::mutex > lock( reloadMutex );
+	handlers.erase( std::remove( handlers.begin(), handlers.end(), handler ), handlers.end() );
+}
+
+
+bool TiXmlFileWatcher::Load( File* file, std::shared_ptr< const TiXmlDocument >* document, std::string* error ) const
+{
+	TiXmlDocument* doc = new TiXmlDocument();
+	if ( !doc->LoadFile( file->name.c_str(), file->options ) )
+	{
+		if ( error )
+		{
+			char where[64] = "";
+			if ( doc->ErrorRow() > 0 )
+				snprintf( where, sizeof( where ), " (row %d, column %d)", doc->ErrorRow(), doc->ErrorCol() );
+			*error = file->name + ": " + doc->ErrorDesc() + where;
+		}
+		delete doc;
+		return false;
+	}
+	// Every hash is worked out now, while the document is ours alone:
+	// comparing it later only reads them.
+	doc->Hash();
+	document->reset( doc );
+	return true;
+}
+
+
+bool TiXmlFileWatcher::Reload( const char* filename )
+{
+	File* file;
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		file = Find( filename );
+	}
+	return file && Reload( file );
+}
+
+
+bool TiXmlFileWatcher::Reload( File* file )
+{
+	std::lock_guard< std::mutex > reloading( reloadMutex );
+
+	TiXmlWatchEvent event;
+	event.filename = file->name;
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		event.previous = file->document;
+	}
+
+	std::shared_ptr< const TiXmlDocument > loaded;
+	if ( Load( file, &loaded, &event.error ) )
+	{
+		DiffCollector collector( &event.changes );
+		diff.Compare( *event.previous, *loaded, &collector );
+		if ( event.changes.empty() )
+		{
+			// Saved without changes, or touched: keep the document readers have.
+			++skipped;
+			return true;
+		}
+		{
+			std::lock_guard< std::mutex > lock( mutex );
+			file->document = loaded;
+		}
+		event.current = loaded;
+		++reloads;
+	}
+	else
+	{
+		event.current = event.previous;
+		++skipped;
+	}
+
+	for ( size_t i = 0; i < handlers.size(); ++i )
+		handlers[i]->OnReload( event );
+	return event.error.empty();
+}
+
+
+bool TiXmlFileWatcher::Start()
+{
+	#ifdef TIXML_WATCH_INOTIFY
+	if ( thread.joinable() )
+		return true;
+	if ( notifyFd < 0 || pipe2( wakeFd, O_CLOEXEC ) != 0 )
+		return false;
+	thread = std::thread( &TiXmlFileWatcher::Run, this );
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+
+void TiXmlFileWatcher::Stop()
+{
+	#ifdef TIXML_WATCH_INOTIFY
+	if ( !thread.joinable() )
+		return;
+	char wake = 0;
+	while ( write( wakeFd[1], &wake, 1 ) < 0 && errno == EINTR )
+		;
+	thread.join();
+	close( wakeFd[0] );
+	close( wakeFd[1] );
+	wakeFd[0] = wakeFd[1] = -1;
+	#endif
+}
+
+
+void TiXmlFileWatcher::Run()
+{
+	#ifdef TIXML_WATCH_INOTIFY
+	std::vector< File* > due;
+	for ( ;; )
+	{
+		// Sleep until inotify has something, or Stop() is called, or the
+		// soonest pending file has been quiet for long enough.
+		int timeout = -1;
+		TiXmlWatchClock::time_point now = TiXmlWatchClock::now();
+		{
+			std::lock_guard< std::mutex > lock( mutex );
+			for ( size_t i = 0; i < files.size(); ++i )
+			{
+				if ( !files[i]->pending )
+					continue;
+				long long wait = std::chrono::duration_cast< std::chrono::milliseconds >( files[i]->due - now ).count() + 1;
+				if ( wait < 0 )
+					wait = 0;
+				if ( timeout < 0 || wait < timeout )
+					timeout = (int)wait;
+			}
+		}
+
+		pollfd fds[2];
+		fds[0].fd = notifyFd;
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+		fds[1].fd = wakeFd[0];
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+		if ( poll( fds, 2, timeout ) < 0 && errno != EINTR )
+			break;
+		if ( fds[1].revents )
+			break;
+
+		now = TiXmlWatchClock::now();
+		if ( fds[0].revents & POLLIN )
+		{
+			// Read everything there is; each event for a watched file pushes
+			// its reload back to a debounce interval from now.
+			alignas( inotify_event ) char buffer[4096];
+			ssize_t length;
+			while ( ( length = read( notifyFd, buffer, sizeof( buffer ) ) ) > 0 )
+			{
+				std::lock_guard< std::mutex > lock( mutex );
+				for ( char* p = buffer; p < buffer + length; )
+				{
+					const inotify_event* event = reinterpret_cast< const inotify_event* >( p );
+					for ( size_t i = 0; i < files.size(); ++i )
+					{
+						File* file = files[i];
+						// After an overflow there is no telling what changed.
+						if ( ( event->mask & IN_Q_OVERFLOW )
+							 || ( event->len && file->watch == event->wd && file->base == event->name ) )
+						{
+							file->pending = true;
+							file->due = now + std::chrono::milliseconds( debounce );
+						}
+					}
+					p += sizeof( inotify_event ) + event->len;
+				}
+			}
+		}
+
+		due.clear();
+		{
+			std::lock_guard< std::mutex > lock( mutex );
+			for ( size_t i = 0; i < files.size(); ++i )
+			{
+				if ( files[i]->pending && files[i]->due <= now )
+				{
+					files[i]->pending = false;
+					due.push_back( files[i] );
+				}
+			}
+		}
+		for ( size_t i = 0; i < due.size(); ++i )
+			Reload( due[i] );
+	}
+	#endif
+}
+
+#endif
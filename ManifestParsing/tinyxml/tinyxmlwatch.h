@@ -0,0 +1,173 @@
+/*
+www.sourceforge.net/projects/tinyxml
+Original code by Lee Thomason (www.grinninglizard.com)
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any
+damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any
+purpose, including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must
+not claim that you wrote the original software. If you use this
+software in a product, an acknowledgment in the product documentation
+would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and
+must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any source
+distribution.
+*/
+
+#ifndef TINYXML_WATCH_INCLUDED
+#define TINYXML_WATCH_INCLUDED
+
+#ifdef TIXML_USE_STL
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tinyxml.h"
+#include "tinyxmldiff.h"
+
+/// What a TiXmlFileWatcher tells its handlers after a watched file has been reloaded.
+struct TiXmlWatchEvent
+{
+	std::string filename;		///< As it was given to TiXmlFileWatcher::Watch().
+	std::shared_ptr< const TiXmlDocument > previous;	///< The document before the change.
+	/** The document now published: the new one, or 'previous' again if the
+		file couldn't be loaded.
+	*/
+	std::shared_ptr< const TiXmlDocument > current;
+	/** The differences from 'previous' to 'current', as TiXmlDiff finds them.
+		The pointers are into the two documents, which this event keeps alive.
+	*/
+	std::vector< TiXmlDiffOp > changes;
+	std::string error;			///< Why the file couldn't be loaded, or empty.
+};
+
+/// Receives the reloads of a TiXmlFileWatcher, on its thread.
+class TiXmlWatchHandler
+{
+public:
+	virtual ~TiXmlWatchHandler() {}
+
+	virtual void OnReload( const TiXmlWatchEvent& event ) = 0;
+};
+
+/**	Keeps the latest parse of a set of XML files, reloading each one in the
+	background when it changes on disk.
+
+	@verbatim
+	TiXmlFileWatcher watcher;
+	watcher.Watch( "settings.xml" );
+	watcher.Subscribe( &handler );
+	watcher.Start();
+
+	// On any thread:
+	std::shared_ptr< const TiXmlDocument > settings = watcher.Document( "settings.xml" );
+	@endverbatim
+
+	The watcher's thread sleeps in the kernel until inotify reports a write
+	to, or a rename onto, one of the files; nothing is polled, so a process
+	whose files don't change spends no time on them. The directory holding
+	each file is what is watched, so editors and deploy tools that write a
+	new file and rename it over the old one are followed as well as ones
+	that write in place.
+
+	A change is only acted on once the file has been quiet for the debounce
+	interval, so a file written in several pieces is parsed once, when it is
+	complete. The new document is then compared with the one it replaces
+	(see TiXmlDiff) and, if anything is different, published - Document()
+	returns it from then on - and handed to every handler with the changed
+	nodes. A file that fails to load leaves its last good document in place;
+	the handlers are told why.
+
+	Published documents are never changed again. A reader holding one may go
+	on using it however long it likes, on any thread, alongside the watcher
+	publishing its replacement; it is deleted when the last holder lets go.
+
+	inotify is Linux only. Elsewhere files can be watched and their documents
+	read, but Start() fails, and they are only reloaded by Reload().
+*/
+class TiXmlFileWatcher
+{
+public:
+	/** Reload a changed file once it has been left alone for
+		'debounceMilliseconds'.
+	*/
+	TiXmlFileWatcher( int debounceMilliseconds = 100 );
+	/// Stops the watcher's thread, if it was started.
+	~TiXmlFileWatcher();
+
+	/** Load 'filename' now, publish it, and reload it whenever it changes
+		from here on. 'options' are used for every load; TiXmlParseOptions::hashNodes
+		is always set, as the comparisons need the hashes. Returns false,
+		and says why in 'error' if that isn't null, if the file can't be
+		loaded or watched. Watching a file that is already watched does
+		nothing.
+	*/
+	bool Watch( const char* filename, const TiXmlParseOptions& options = TiXmlParseOptions(), std::string* error = 0 );
+
+	/** The latest document loaded from 'filename', or null if the file isn't
+		watched. 'filename' must be given just as it was to Watch().
+	*/
+	std::shared_ptr< const TiXmlDocument > Document( const char* filename ) const;
+
+	/** Tell 'handler' of every reload from now on. Handlers are called on
+		the watcher's thread (or the one calling Reload()), one reload at a
+		time, and must not subscribe or unsubscribe from there.
+	*/
+	void Subscribe( TiXmlWatchHandler* handler );
+	/// Once this returns, 'handler' is not being, and won't be, called.
+	void Unsubscribe( TiXmlWatchHandler* handler );
+
+	/// Start the watcher's thread. Returns false if inotify isn't available.
+	bool Start();
+	/// Stop the watcher's thread and wait for it. Changes not yet reloaded are dropped.
+	void Stop();
+
+	/** Reload 'filename' now, on the calling thread, as though it had
+		changed. Returns false if it isn't watched or couldn't be loaded.
+	*/
+	bool Reload( const char* filename );
+
+	/// The reloads that published a new document.
+	unsigned long Reloads() const	{ return reloads; }
+	/// The reloads that found the file unchanged, or couldn't load it.
+	unsigned long Skipped() const	{ return skipped; }
+
+private:
+	TiXmlFileWatcher( const TiXmlFileWatcher& );		// not implemented.
+	void operator=( const TiXmlFileWatcher& );			// not implemented.
+
+	struct File;
+
+	File* Find( const char* filename ) const;
+	bool Load( File* file, std::shared_ptr< const TiXmlDocument >* document, std::string* error ) const;
+	bool Reload( File* file );
+	void Run();
+
+	int debounce;
+	std::vector< File* > files;
+	mutable std::mutex mutex;			// guards 'files' and each file's document
+	std::mutex reloadMutex;			// held for a whole reload, handlers and all
+	std::vector< TiXmlWatchHandler* > handlers;
+	TiXmlDiff diff;
+	std::thread thread;
+	int notifyFd;
+	int wakeFd[2];
+	std::atomic< unsigned long > reloads;
+	std::atomic< unsigned long > skipped;
+};
+
+#endif
+
+#endif